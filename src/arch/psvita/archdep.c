@@ -607,6 +607,33 @@ int archdep_rename(const char *oldpath, const char *newpath)
     return rename(oldpath, newpath);
 } 
 
+/** \brief  Write the buffered data of \a fd through to the memory card
+ *
+ * \return  0 on success, -1 on failure
+ */
+int archdep_file_sync(FILE *fd)
+{
+    if (fflush(fd) != 0 || fsync(fileno(fd)) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/** \brief  Make a CBM file name usable as a host file name
+ *
+ * Replaces the directory separator, so the file stays in the directory it
+ * is written to.
+ */
+void archdep_sanitize_filename(char *name)
+{
+    while (*name != '\0') {
+        if (*name == ARCHDEP_DIR_SEPARATOR) {
+            *name = '_';
+        }
+        name++;
+    }
+}
+
 /** \brief  Remove directory \a pathname
  *
  * \return  0 on success, -1 on failure
@@ -86,7 +86,7 @@
 #define ARCHDEP_LINE_DELIMITER "\n"
 
 /* Ethernet default device */
-#define ARCHDEP_ETHERNET_DEFAULT_DEVICE "eth0"
+#define ARCHDEP_ETHERNET_DEFAULT_DEVICE "virtual"
 
 /* Default sound fragment size */
 #define ARCHDEP_SOUND_FRAGMENT_SIZE 1
@@ -139,6 +139,10 @@ extern int			archdep_mkdir(const char *pathname, int mode);
 extern int			archdep_rmdir(const char *pathname);
 extern int			archdep_stat(const char *file_name, unsigned int *len, unsigned int *isdir);
 extern int			archdep_rename(const char *oldpath, const char *newpath);
+extern int			archdep_file_is_blockdev(const char *name);
+extern int			archdep_file_is_chardev(const char *name);
+extern void			archdep_sanitize_filename(char *name);
+extern int			archdep_file_sync(FILE *fd);
 extern char*		archdep_default_sysfile_pathlist(const char *emu_id);
 extern void			archdep_default_sysfile_pathlist_free(void);
 extern char*		archdep_extra_title_text(void);
@@ -66,6 +66,11 @@ extern "C" {
 #include "kbdbuf.h"
 #include "maincpu.h"
 #include "t64.h"
+#include "interrupt.h"
+#include "printer.h"
+#include "serial.h"
+#include "joyport.h"
+#include "vsyncapi.h"
 }
 
 #include <cstring>
@@ -75,6 +80,11 @@ extern "C" {
 
 
 static View* gs_view;
+static resource_handle_t gs_driveTypeHandles[4];
+
+static resource_handle_t getDriveTypeHandle(int drive_id);
+static void	 driveTypeChanged(const char* name, void* param);
+static void	 syncDrives();
 
 extern "C" int PSV_CreateView(int width, int height, int depth)
 {
@@ -110,7 +120,7 @@ extern "C" void	PSV_GetViewInfo(int* width, int* height, unsigned char** ppixels
 
 extern "C" void PSV_ScanControls()
 {
-	static ControlPadMap* maps[16];
+	static ControlPadMap* maps[MAX_CONTROL_MAPS];
 	int size = 0;
 
 	// Goto main menu at boot time. There must be a better place to implement this.
@@ -120,12 +130,16 @@ extern "C" void PSV_ScanControls()
 		return;
 	}
 
-	gs_view->scanControls(maps, &size, gs_scanMouse);
+	gs_view->scanControls(maps, &size, MAX_CONTROL_MAPS, gs_scanMouse);
 
 	for (int i=0; i<size; ++i){
 		ControlPadMap* map = maps[i];
 		
 		if (!map) continue;
+		if (map->istouch){
+			moveMouse(map);
+			continue;
+		}
 		if (map->isjoystick){
 			if (map->ispress)
 				joystick_value[g_joystickPort] |= map->joypin;
@@ -189,7 +203,7 @@ extern "C" void PSV_ScanControls()
 			break;
 		case 137: // Reset computer
 			if (!ui_emulation_is_paused()){ // Reseting in pause state causes freeze.
-				machine_trigger_reset(gs_machineResetMode);
+				resetMachine(gs_machineResetMode);
 				keyboard_clear_keymatrix(); // Empty the key buffer.
 			}
 			break;
@@ -249,10 +263,25 @@ extern "C" void PSV_ApplySettings()
 	// Set drive sound volume (0-4000).
 	resources_set_int("DriveSoundEmulationVolume", 2000);
 
+	// Keep the drive leds in the statusbar in sync with the drive types
+	// instead of polling them whenever the settings are synced.
+	for (int i=8; i<12; ++i){
+		resources_subscribe(getDriveTypeHandle(i), driveTypeChanged, (void*)(intptr_t)i);
+		driveTypeChanged(NULL, (void*)(intptr_t)i);
+	}
+
 	// Apply all user defined settings.
 	gs_view->applyAllSettings();
 }
 
+extern "C" void PSV_Shutdown()
+{
+	// Resources are shut down after the ui, drop the subscribers while they still exist.
+	for (int i=8; i<12; ++i){
+		resources_unsubscribe(getDriveTypeHandle(i), driveTypeChanged, (void*)(intptr_t)i);
+	}
+}
+
 extern "C" void PSV_ActivateMenu()
 {
 	gs_view->activateMenu();
@@ -329,6 +358,10 @@ extern "C" void	PSV_NotifyReset()
 	gs_scanScreenLoadingTimer = 0;
 	gs_scanScreenReadyTimer = 0;
 	gs_autoStartInProgress = false;
+
+	// Only our own hard resets are followed by a boot state capture.
+	gs_bootStateTimer = gs_bootStateResetPending? 50: 0;
+	gs_bootStateResetPending = false;
 }
 
 Controller::Controller()
@@ -539,6 +572,10 @@ int Controller::loadState(const char* file)
 		cartridge = file_name;
 
 	int ret = machine_read_snapshot((char*)file, 0);
+
+	// The snapshot writes the drive types directly without notifying the subscribers.
+	syncDrives();
+	syncSetting(DRIVE_STATUS);
 	
 	if (!cartridge.empty()){
 		// When loading a snapshot Vice detaches any attached cartridges. Reading the slot returns null 
@@ -731,7 +768,7 @@ int	Controller::getSaveStatePatchInfo(patch_data_s* pinfo)
 
 void Controller::resetComputer()
 {
-	machine_trigger_reset(gs_machineResetMode);
+	resetMachine(gs_machineResetMode);
 }
 
 void Controller::setModelProperty(int key, const char* value)
@@ -766,6 +803,8 @@ void Controller::setModelProperty(int key, const char* value)
 		setCartridgeReset(value);break;
 	case MACHINE_RESET:
 		setMachineResetMode(value); break;
+	case MOUSE:
+		setMouse(value); break;
 	}
 }
 
@@ -822,12 +861,12 @@ void Controller::changeJoystickPort(const char* port)
 	if (!strcmp(port, "Port 1")){
 		g_joystickPort = 1;
 		resources_set_int(VICE_RES_JOY_PORT1_DEV, 1);  // 1 = Joystick
-		resources_set_int(VICE_RES_JOY_PORT2_DEV, 0);  // 0 = None
+		resources_set_int(VICE_RES_JOY_PORT2_DEV, gs_mouseDevice);  // Mouse or none
 	}
 	else if (!strcmp(port, "Port 2")){
 		g_joystickPort = 2;
 		resources_set_int(VICE_RES_JOY_PORT2_DEV, 1);
-		resources_set_int(VICE_RES_JOY_PORT1_DEV, 0);
+		resources_set_int(VICE_RES_JOY_PORT1_DEV, gs_mouseDevice);
 	}
 }
 
@@ -1032,14 +1071,11 @@ void Controller::setDriveStatus(const char* val)
 {
 	int drive_id = getCurrentDriveId();
 
-	if (!strcmp(val, "Active")){
-		resources_set_int_sprintf("Drive%dType", 1542, drive_id);
-		gs_view->setDriveStatus(drive_id-8, 1);
-	}
-	else if (!strcmp(val, "Not active")){
-		resources_set_int_sprintf("Drive%dType", DRIVE_TYPE_NONE, drive_id);
-		gs_view->setDriveStatus(drive_id-8, 0);
-	}
+	// The statusbar is updated by driveTypeChanged().
+	if (!strcmp(val, "Active"))
+		resources_handle_set_int(getDriveTypeHandle(drive_id), 1542);
+	else if (!strcmp(val, "Not active"))
+		resources_handle_set_int(getDriveTypeHandle(drive_id), DRIVE_TYPE_NONE);
 }
 
 void Controller::setDriveEmulation(const char* val)
@@ -1090,6 +1126,19 @@ void Controller::setCartridgeReset(const char* val)
 		resources_set_int(VICE_RES_CARTRIDGE_RESET, 0);
 }
 
+void Controller::setMouse(const char* val)
+{
+	// Emulated mouse/paddles on the control port that the joystick does not use.
+	if (!strcmp(val, "1351"))
+		setMouseDevice(JOYPORT_ID_MOUSE_1351);
+	else if (!strcmp(val, "NEOS"))
+		setMouseDevice(JOYPORT_ID_MOUSE_NEOS);
+	else if (!strcmp(val, "Paddles"))
+		setMouseDevice(JOYPORT_ID_PADDLES);
+	else if (!strcmp(val, "None"))
+		setMouseDevice(JOYPORT_ID_NONE);
+}
+
 void Controller::setMachineResetMode(const char* val)
 {
 	if (!strcmp(val, "Hard"))
@@ -1252,18 +1301,11 @@ void Controller::syncSetting(int key)
 		// Update status of the currently displayed drive in Devices menu.
 		int drive_type;
 		int drive_id = getCurrentDriveId();
-		if (resources_get_int_sprintf("Drive%dType", &drive_type, drive_id) < 0){
+		if (resources_handle_get_int(getDriveTypeHandle(drive_id), &drive_type) < 0){
 			return;
 		}
 		string str_val = (drive_type == DRIVE_TYPE_NONE)? "Not active": "Active";
 		gs_view->onSettingChanged(key, str_val.c_str(),0,0,0,1);
-
-		// Update statusbar. Check all drives.
-		for (int i=8; i<12; ++i){
-			if (resources_get_int_sprintf("Drive%dType", &drive_type, i) < 0)
-				continue;
-			gs_view->setDriveStatus(i-8, drive_type);
-		}
 		break;
 		}
 	case DRIVE_TRUE_EMULATION:
@@ -1405,6 +1447,26 @@ void Controller::syncSetting(int key)
 		if (!str_val.empty())
 			gs_view->onSettingChanged(key, str_val.c_str(),0,0,0,1);
 
+		break;
+		}
+	case MOUSE:
+		{
+		int val;
+		string str_val;
+
+		// The mouse is on the port that the joystick does not use.
+		if (resources_get_int(g_joystickPort == 1? VICE_RES_JOY_PORT2_DEV: VICE_RES_JOY_PORT1_DEV, &val) < 0)
+			return;
+
+		switch (val){
+		case JOYPORT_ID_MOUSE_1351: str_val = "1351"; break;
+		case JOYPORT_ID_MOUSE_NEOS: str_val = "NEOS"; break;
+		case JOYPORT_ID_PADDLES: str_val = "Paddles"; break;
+		default: val = JOYPORT_ID_NONE; str_val = "None"; break;
+		}
+
+		setMouseDevice(val);
+		gs_view->onSettingChanged(key, str_val.c_str(),0,0,0,1);
 		break;
 		}
 	case CPU_SPEED:
@@ -1462,6 +1524,7 @@ void Controller::syncModelSettings()
 	syncSetting(SID_MODEL);
 	syncSetting(COLOR_PALETTE);
 	syncSetting(JOYSTICK_PORT);
+	syncSetting(MOUSE);
 	syncSetting(CPU_SPEED);
 	syncSetting(SOUND);
 	syncSetting(DRIVE_STATUS);
@@ -1528,7 +1591,7 @@ int Controller::getImageType(const char* image)
 	string file = image;
 
 	static const char* disk_ext[] = {"D64","D71","D80","D81","D82","G64","G41","X64",0};
-	static const char* tape_ext[] = {"T64","TAP",0};
+	static const char* tape_ext[] = {"T64","TAP","WAV","VOC",0};
 	static const char* cart_ext[] = {"CRT",0};
 	static const char* prog_ext[] = {"PRG","P00",0};
 
@@ -1722,28 +1785,205 @@ void Controller::detachImage(int device)
 
 static void toggleJoystickPorts()
 {
+	// Move the joystick first, the mouse can only be on one port at a time.
 	if (g_joystickPort == 1){
 		g_joystickPort = 2;
-		resources_set_int(VICE_RES_JOY_PORT1_DEV, 0); // 0 = None  
 		resources_set_int(VICE_RES_JOY_PORT2_DEV, 1); // 1 = Joystick
+		resources_set_int(VICE_RES_JOY_PORT1_DEV, gs_mouseDevice); // Mouse or none
 		gs_view->onSettingChanged(JOYSTICK_PORT,"Port 2","",0,0,1);
 	}
 	else{
 		g_joystickPort = 1;
 		resources_set_int(VICE_RES_JOY_PORT1_DEV, 1); 
-		resources_set_int(VICE_RES_JOY_PORT2_DEV, 0); 
+		resources_set_int(VICE_RES_JOY_PORT2_DEV, gs_mouseDevice); 
 		gs_view->onSettingChanged(JOYSTICK_PORT,"Port 1","",0,0,1);
 	}
 }
 
 static void toggleWarpMode()
 {
+	static resource_handle_t handle;
 	int value;
-    if (resources_get_int(VICE_RES_WARP_MODE, &value) < 0)
-        return;
+
+	resources_resolve_handle(&handle, VICE_RES_WARP_MODE);
+	if (resources_handle_get_int(handle, &value) < 0)
+		return;
 
 	value = value? 0:1;
-	resources_set_int(VICE_RES_WARP_MODE, value);
+	resources_handle_set_int(handle, value);
+}
+
+static void setMouseDevice(int device)
+{
+	gs_mouseDevice = device;
+	resources_set_int(g_joystickPort == 1? VICE_RES_JOY_PORT2_DEV: VICE_RES_JOY_PORT1_DEV, device);
+	resources_set_int(VICE_RES_MOUSE, device != JOYPORT_ID_NONE);
+
+	gs_scanMouse = device != JOYPORT_ID_NONE;
+	if (!gs_scanMouse && gs_mouseButton){
+		// After the presses still waiting to be replayed.
+		mouse_button_timestamp(0, 0, vsyncarch_gettime());
+		gs_mouseButton = 0;
+	}
+}
+
+static void moveMouse(ControlPadMap* map)
+{
+	// Move and press with the time the touch sample was taken. mousedrv replays the samples
+	// of a frame during the next one at their own emulated times, so the mouse emulation
+	// sees every sample and spreads its movement over the time between the samples.
+	unsigned long age = (unsigned long)((unsigned long long)map->touch_age * vsyncarch_frequency() / 1000000);
+	unsigned long timestamp = vsyncarch_gettime() - age;
+
+	if (map->touch_x || map->touch_y)
+		mouse_move_timestamp(map->touch_x / MOUSE_TOUCH_DIVIDER, map->touch_y / MOUSE_TOUCH_DIVIDER, timestamp);
+
+	if (map->ispress != gs_mouseButton){
+		gs_mouseButton = map->ispress;
+		mouse_button_timestamp(0, gs_mouseButton, timestamp);
+	}
+}
+
+static bool getBootStateKey(string& key)
+{
+	// Returns the configuration a boot state is valid for.
+	// Reading a snapshot takes out any attached cartridges and tapes, so there is no key with one attached.
+	if (cart_getid_slotmain() != CARTRIDGE_NONE 
+		|| cart_getid_slot0() != CARTRIDGE_NONE 
+		|| cart_getid_slot1() != CARTRIDGE_NONE
+		|| (tape_image_dev1 && tape_image_dev1->name))
+		return false;
+
+	char* value = resources_write_event_relevant_to_string("\n");
+	key = value;
+	lib_free(value);
+
+	// ROMs are not event relevant but they sure change the boot.
+	const char* roms[] = {"KernalName", "BasicName", "ChargenName"};
+	for (int i=0; i<3; ++i){
+		value = resources_write_item_to_string(roms[i], "\n");
+		if (value){
+			key += value;
+			lib_free(value);
+		}
+	}
+
+	// The state is saved without the disks but the drives in it have seen them.
+	for (unsigned int unit=8; unit<12; ++unit){
+		const char* disk = file_system_get_disk_name(unit);
+		key += disk? disk: "";
+		key += "\n";
+	}
+
+	return true;
+}
+
+static void saveBootStateTrap(uint16_t addr, void* data)
+{
+	string key;
+
+	// Keep the state only if the configuration is still the same as at the reset.
+	if (!getBootStateKey(key) || key != gs_bootStateCaptureKey)
+		return;
+
+	if (machine_write_snapshot(BOOT_STATE_FILE, 0, 0, 0) < 0){
+		gs_bootStateKey.clear();
+		return;
+	}
+
+	gs_bootStateKey = key;
+}
+
+#ifdef PSV_DEBUG_CODE
+static bool isBootStateVolatile(uint16_t addr)
+{
+	// Locations that differ between two boots to the same 'READY.': the stack page written by the IRQs, 
+	// the jiffy clock, the cursor blink and the character under the cursor the blink inverts.
+	uint16_t cursor = (gs_bootStateCheckRam[0xd1] | (gs_bootStateCheckRam[0xd2] << 8)) + gs_bootStateCheckRam[0xd3];
+
+	return (addr >= 0x100 && addr < 0x200)
+		|| (addr >= 0xa0 && addr <= 0xa2)
+		|| (addr >= 0xcc && addr <= 0xcf)
+		|| addr == cursor;
+}
+
+static void checkBootStateTrap(uint16_t addr, void* data)
+{
+	// Compares the RAM at the first 'READY.' of a real hard reset with the RAM the cached
+	// boot state gave. The result goes to the debug log.
+	int bank = mem_bank_from_name("ram");
+	int diffs = 0;
+
+	for (unsigned int i=0; i<0x10000; ++i){
+		uint8_t value = mem_bank_peek(bank, (uint16_t)i, NULL);
+		if (value == gs_bootStateCheckRam[i] || isBootStateVolatile((uint16_t)i))
+			continue;
+		if (diffs++ < 16)
+			PSV_DEBUG("Boot state check: $%04x is $%02x after the real reset, $%02x from the cache", i, value, gs_bootStateCheckRam[i]);
+	}
+
+	PSV_DEBUG("Boot state check: %s, %d bytes differ", diffs? "FAILED": "ok", diffs);
+	lib_free(gs_bootStateCheckRam);
+	gs_bootStateCheckRam = NULL;
+}
+#endif
+
+static void loadBootStateTrap(uint16_t addr, void* data)
+{
+	if (machine_read_snapshot(BOOT_STATE_FILE, 0) < 0){
+		// Fall back to a real reset.
+		gs_bootStateKey.clear();
+		resetMachine(MACHINE_RESET_MODE_HARD);
+		return;
+	}
+
+	// Reset what lives outside the snapshot like the machine reset does.
+	serial_traps_reset();
+	printer_reset();
+	datasette_reset();
+	PSV_NotifyReset();
+
+#ifdef PSV_DEBUG_CODE
+	// Self-check of debug builds: keep the RAM the cache gave and follow up with a real
+	// hard reset. checkBootStateTrap() compares the two at its first 'READY.'.
+	int bank = mem_bank_from_name("ram");
+
+	if (!gs_bootStateCheckRam)
+		gs_bootStateCheckRam = (uint8_t*)lib_malloc(0x10000);
+	for (unsigned int i=0; i<0x10000; ++i)
+		gs_bootStateCheckRam[i] = mem_bank_peek(bank, (uint16_t)i, NULL);
+
+	gs_bootStateResetPending = true;
+	machine_trigger_reset(MACHINE_RESET_MODE_HARD);
+#endif
+}
+
+static void resetMachine(unsigned int mode)
+{
+	// The KERNAL spends about 2.5 seconds in the RAM test and BASIC init after a hard reset,
+	// but it always ends up in the same state with the same configuration. The state at the 
+	// first 'READY.' is saved after a real hard reset and restored by the following hard resets
+	// as long as the configuration is unchanged. Anything else does a real reset.
+	// Debug builds check every restored state against a real reset, see loadBootStateTrap().
+	string key;
+
+#ifdef PSV_DEBUG_CODE
+	// A new reset ends a check still waiting for its 'READY.'.
+	lib_free(gs_bootStateCheckRam);
+	gs_bootStateCheckRam = NULL;
+#endif
+
+	if (mode == MACHINE_RESET_MODE_HARD && getBootStateKey(key)){
+		if (!gs_bootStateKey.empty() && key == gs_bootStateKey){
+			interrupt_maincpu_trigger_trap(loadBootStateTrap, 0);
+			return;
+		}
+
+		gs_bootStateCaptureKey = key;
+		gs_bootStateResetPending = true;
+	}
+
+	machine_trigger_reset(mode);
 }
 
 static void	checkPendingActions()
@@ -1848,23 +2088,46 @@ static void	checkPendingActions()
 		if (--gs_activateDriveTimer != 0) return;
 
 		int drive_id = getCurrentDriveId();
-		resources_set_int_sprintf("Drive%dType", 1542, drive_id);
+		resources_handle_set_int(getDriveTypeHandle(drive_id), 1542);
 	}
 	if (gs_deactivateDriveTimer > 0){
 		if (--gs_deactivateDriveTimer != 0) return;
 
 		int drive_id = getCurrentDriveId();
-		resources_set_int_sprintf("Drive%dType", DRIVE_TYPE_NONE, drive_id);
+		resources_handle_set_int(getDriveTypeHandle(drive_id), DRIVE_TYPE_NONE);
 	}
 	if (gs_activateDriveAndLoadDiskTimer > 0){
 		if (--gs_activateDriveAndLoadDiskTimer != 0) return;
 
 		int drive_id = getCurrentDriveId();
-		resources_set_int_sprintf("Drive%dType", 1542, drive_id);
+		resources_handle_set_int(getDriveTypeHandle(drive_id), 1542);
 
 		// Now schedule the load disk action.
 		gs_loadDiskTimer = 50;
 	}	
+	if (gs_bootStateTimer > 0){
+		if (--gs_bootStateTimer != 0) return;
+		int ret = scanScreen("READY.", CURSOR_WAIT_BLINK);
+
+		switch (ret){
+		case 0:
+			// First 'READY.' after the reset. Save the state between two instructions.
+#ifdef PSV_DEBUG_CODE
+			if (gs_bootStateCheckRam){
+				interrupt_maincpu_trigger_trap(checkBootStateTrap, 0);
+				break;
+			}
+#endif
+			interrupt_maincpu_trigger_trap(saveBootStateTrap, 0);
+			break;
+		case 1:
+			break;
+		case 2:
+			if (isCpuInRam())
+				return;
+			gs_bootStateTimer = 10;
+		}
+	}
 }
 
 static void setPendingAction(ctrl_pending_action_e action)
@@ -2096,6 +2359,42 @@ static int getCurrentDriveId()
 	return ret;
 }
 
+static resource_handle_t getDriveTypeHandle(int drive_id)
+{
+	resource_handle_t* handle = &gs_driveTypeHandles[(drive_id-8) & 3];
+
+	if (*handle == RESOURCE_HANDLE_NONE){
+		char* name = lib_msprintf("Drive%dType", drive_id);
+		resources_resolve_handle(handle, name);
+		lib_free(name);
+	}
+
+	return *handle;
+}
+
+static void driveTypeChanged(const char* name, void* param)
+{
+	int drive_id = (int)(intptr_t)param;
+	int drive_type;
+
+	if (resources_handle_get_int(getDriveTypeHandle(drive_id), &drive_type) < 0)
+		return;
+
+	gs_view->setDriveStatus(drive_id-8, drive_type);
+}
+
+static void syncDrives()
+{
+	// Update the drive states in the statusbar.
+	for (int i=8; i<12; ++i){
+		driveTypeChanged(NULL, (void*)(intptr_t)i);
+	}
+
+	// Vice only reports the drive leds when they change. Make it report them all again.
+	drive_enable_update_ui(drive_context[0]);
+	drive_update_ui_status();
+}
+
 static bool isTapOnTape()
 {
 	// Checks if a TAP file is attached to the datasette.
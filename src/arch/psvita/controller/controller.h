@@ -32,6 +32,7 @@ void		PSV_SetViewport(int x, int y, int width, int height);
 void		PSV_GetViewInfo(int* width, int* height, unsigned char** ppixels, int* pitch, int* bpp);
 void		PSV_ScanControls();
 void		PSV_ApplySettings();
+void		PSV_Shutdown();
 void		PSV_ActivateMenu();
 int			PSV_RGBToPixel(uint8_t r, uint8_t g, uint8_t b);
 void		PSV_NotifyPalette(unsigned char* palette, int size);
@@ -112,7 +113,7 @@ private:
 	void			setDatasetteReset(const char* val);
 	void			setCartridgeReset(const char* val);
 	void			setMachineResetMode(const char* val);
-	void			setMouseSampling(const char* val);
+	void			setMouse(const char* val);
 	int				getImageType(const char* image);
 	void			getImageFileContents(int peripheral, const char* image, const char*** values, int* size);
 	void			updatePalette();
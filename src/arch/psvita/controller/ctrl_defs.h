@@ -19,6 +19,12 @@ enum ctrl_pending_action_e{
 #define CURSOR_WAIT_BLINK   0
 #define CURSOR_NOWAIT_BLINK 1
 
+// Size of the control map buffer filled in every scan.
+#define MAX_CONTROL_MAPS    16
+
+// Touch pad units per mouse unit.
+#define MOUSE_TOUCH_DIVIDER 4.0f
+
 
 static bool	  gs_frameDrawn = false;
 static bool   gs_bootTime = true;	
@@ -39,12 +45,23 @@ static int    gs_scanScreenPressPlayTimer = 0;
 static int    gs_scanScreenLoadingTimer = 0;
 static int	  gs_scanScreenReadyTimer = 0;
 static bool   gs_scanMouse = false;
+static int	  gs_mouseDevice = 0;
+static int	  gs_mouseButton = 0;
 static int	  gs_machineResetMode = 1;
+static int	  gs_bootStateTimer = 0;
+static bool   gs_bootStateResetPending = false;
+static string gs_bootStateKey;
+static string gs_bootStateCaptureKey;
+#ifdef PSV_DEBUG_CODE
+static uint8_t* gs_bootStateCheckRam = NULL;
+#endif
 static string gs_loadProgramName;
 int			  g_joystickPort = 2;
 
 static void	 toggleJoystickPorts();
 static void	 toggleWarpMode();
+static void	 setMouseDevice(int device);
+static void	 moveMouse(ControlPadMap* map);
 static void	 setPendingAction(ctrl_pending_action_e);
 static void	 checkPendingActions();
 static void	 setSoundVolume(int);
@@ -55,6 +72,8 @@ static bool	 isFileOfType(const char* fname, const char* type);
 static void	 strToUpperCase(string& str);
 static int   getCurrentDriveId();
 static bool  isTapOnTape();
+static void	 resetMachine(unsigned int mode);
+static bool	 getBootStateKey(string& key);
 
 
 #endif
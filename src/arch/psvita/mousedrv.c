@@ -41,6 +41,10 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include "alarm.h"
+#include "clkguard.h"
+#include "machine.h"
+#include "maincpu.h"
 #include "mouse.h"
 #include "mousedrv.h"
 #include "log.h"
@@ -55,6 +59,23 @@ static mouse_func_t mouse_funcs;
 static float mouse_x = 0.0, mouse_y = 0.0;
 static unsigned long mouse_timestamp = 0;
 
+/* Touch samples arrive once per frame, several at a time.  They wait here
+   and are applied one frame after they were taken, each at its own
+   emulated time, so the emulated mouse sees them at the sensor's spacing.  */
+#define MOUSE_SAMPLES 32
+
+typedef struct mouse_sample_s {
+    float dx, dy;
+    int bnumber;                /* button to set to `state', -1 if none */
+    int state;
+    unsigned long timestamp;    /* sample time plus the replay delay */
+    CLOCK clk;                  /* emulated time to apply the sample at */
+} mouse_sample_t;
+
+static mouse_sample_t mouse_samples[MOUSE_SAMPLES];
+static unsigned int mouse_sample_first = 0, mouse_sample_count = 0;
+static alarm_t *mouse_sample_alarm = NULL;
+
 void mousedrv_mouse_changed(void)
 {
 #ifdef HAVE_MOUSE
@@ -81,8 +102,98 @@ int mousedrv_cmdline_options_init(void)
 
 /* ------------------------------------------------------------------------- */
 
+static void mouse_apply_sample(void)
+{
+    mouse_sample_t *sample = &mouse_samples[mouse_sample_first];
+
+    mouse_x = fmodf(mouse_x + sample->dx, (float)0xffff);
+    mouse_y = fmodf(mouse_y - sample->dy, (float)0xffff);
+
+    /* mouse.c takes only a new time stamp as a new reading */
+    if (sample->dx != 0.0f || sample->dy != 0.0f) {
+        if ((long)(sample->timestamp - mouse_timestamp) <= 0) {
+            sample->timestamp = mouse_timestamp + 1;
+        }
+        mouse_timestamp = sample->timestamp;
+    }
+
+    if (sample->bnumber >= 0) {
+        mouse_button(sample->bnumber, sample->state);
+    }
+
+    mouse_sample_first = (mouse_sample_first + 1) % MOUSE_SAMPLES;
+    mouse_sample_count--;
+}
+
+static void mouse_sample_alarm_handler(CLOCK offset, void *data)
+{
+    alarm_unset(mouse_sample_alarm);
+
+    while (mouse_sample_count > 0 && mouse_samples[mouse_sample_first].clk <= maincpu_clk) {
+        mouse_apply_sample();
+    }
+    if (mouse_sample_count > 0) {
+        alarm_set(mouse_sample_alarm, mouse_samples[mouse_sample_first].clk);
+    }
+}
+
+static void mouse_clk_overflow_callback(CLOCK sub, void *data)
+{
+    unsigned int i;
+
+    for (i = 0; i < mouse_sample_count; i++) {
+        mouse_sample_t *sample = &mouse_samples[(mouse_sample_first + i) % MOUSE_SAMPLES];
+
+        sample->clk = sample->clk > sub ? sample->clk - sub : 0;
+    }
+}
+
 void mousedrv_init(void)
 {
+    mouse_sample_alarm = alarm_new(maincpu_alarm_context, "MousedrvSample", mouse_sample_alarm_handler, NULL);
+    clk_guard_add_callback(maincpu_clk_guard, mouse_clk_overflow_callback, NULL);
+}
+
+/* Queues a sample taken at `timestamp'.  */
+static void mouse_queue_sample(float dx, float dy, int bnumber, int state, unsigned long timestamp)
+{
+    CLOCK delay = (CLOCK)machine_get_cycles_per_frame();
+    unsigned long frame = (unsigned long)((double)vsyncarch_frequency() * delay / machine_get_cycles_per_second());
+    unsigned long age = vsyncarch_gettime() - timestamp;
+    CLOCK age_clk = (CLOCK)((double)age * machine_get_cycles_per_second() / vsyncarch_frequency());
+    mouse_sample_t *sample;
+
+    if (mouse_sample_alarm == NULL) {
+        /* no emulated time yet */
+        return;
+    }
+
+    /* Make room, and catch up when the emulated time went back, as on a reset.  */
+    while (mouse_sample_count > 0
+           && (mouse_sample_count == MOUSE_SAMPLES
+               || mouse_samples[(mouse_sample_first + mouse_sample_count - 1) % MOUSE_SAMPLES].clk > maincpu_clk + 2 * delay)) {
+        mouse_apply_sample();
+    }
+
+    sample = &mouse_samples[(mouse_sample_first + mouse_sample_count) % MOUSE_SAMPLES];
+    sample->dx = dx;
+    sample->dy = dy;
+    sample->bnumber = bnumber;
+    sample->state = state;
+    sample->timestamp = timestamp + frame;
+    sample->clk = maincpu_clk + (age_clk < delay ? delay - age_clk : 0);
+
+    /* keep the order of the samples */
+    if (mouse_sample_count > 0) {
+        mouse_sample_t *last = &mouse_samples[(mouse_sample_first + mouse_sample_count - 1) % MOUSE_SAMPLES];
+
+        if (sample->clk < last->clk) {
+            sample->clk = last->clk;
+        }
+    }
+    mouse_sample_count++;
+
+    alarm_set(mouse_sample_alarm, mouse_samples[mouse_sample_first].clk);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -126,10 +237,22 @@ int mousedrv_get_y(void)
 
 void mouse_move(float dx, float dy)
 {
-	mouse_x = (float)((int)(mouse_x + dx) % 0xffff);
-    mouse_y = (float)((int)(mouse_y - dy) % 0xffff);
-   
-	mouse_timestamp = vsyncarch_gettime();
+    mouse_move_timestamp(dx, dy, vsyncarch_gettime());
+}
+
+/* Move by a sample taken at `timestamp'.  The move is applied one frame
+   later at the emulated time matching its place among the samples, so
+   mouse.c spreads it over the time between the samples.  Fractions are
+   kept for the next move.  */
+void mouse_move_timestamp(float dx, float dy, unsigned long timestamp)
+{
+    mouse_queue_sample(dx, dy, -1, 0, timestamp);
+}
+
+/* Set a button in order with the moves, see mouse_move_timestamp().  */
+void mouse_button_timestamp(int bnumber, int state, unsigned long timestamp)
+{
+    mouse_queue_sample(0.0f, 0.0f, bnumber, state, timestamp);
 }
 
 unsigned long mousedrv_get_timestamp(void)
@@ -42,6 +42,8 @@ extern unsigned long mousedrv_get_timestamp(void);
 
 extern void mouse_button(int bnumber, int state);
 extern void mouse_move(float dx, float dy);
+extern void mouse_move_timestamp(float dx, float dy, unsigned long timestamp);
+extern void mouse_button_timestamp(int bnumber, int state, unsigned long timestamp);
 
 extern void mousedrv_button_left(int pressed);
 extern void mousedrv_button_right(int pressed);
@@ -0,0 +1,758 @@
+/*
+ * rawnetarch.c - raw ethernet interface, in-process virtual segment.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/*
+ * There is no raw network access on this platform, so the emulated chip is
+ * connected to a virtual ethernet segment instead.  A peer living in the
+ * same process plays every other host on that segment:
+ *
+ * - ARP requests for any address but the sender's own are answered.
+ * - ICMP echo requests are answered.
+ * - UDP: echo (7), discard (9) and chargen (19).
+ * - TCP: echo (7) and discard (9), everything else is reset.
+ *
+ * The peer answers synchronously when a frame is transmitted and queues the
+ * answer; rawnet_arch_receive() hands the queued frames to the chip.  While
+ * the queue is full, frames sent by the chip are dropped as if lost on the
+ * wire, so the emulated TCP/IP stack retransmits them.
+ * Everything is deterministic, which makes the segment usable for tests and
+ * for profiling the chip emulation.  Statistics are logged on deactivation.
+ */
+
+#include "vice.h"
+
+#ifdef HAVE_RAWNET
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "lib.h"
+#include "log.h"
+#include "rawnetarch.h"
+#include "types.h"
+#include "util.h"
+
+#define RAWNET_VIRTUAL_NAME "virtual"
+#define RAWNET_VIRTUAL_DESCRIPTION "In-process virtual ethernet segment"
+
+/* frames are queued with FCS, but without preamble */
+#define VIRT_MAX_FRAME 1518
+#define VIRT_MIN_FRAME 64
+#define VIRT_FCS_LEN 4
+
+#define VIRT_QUEUE_SIZE 32      /* must be a power of two */
+
+#define VIRT_TCP_CONNECTIONS 8
+
+#define ETH_HDR_LEN 14
+#define ETH_TYPE_IP 0x0800
+#define ETH_TYPE_ARP 0x0806
+
+#define IP_HDR_LEN 20
+#define IP_PROTO_ICMP 1
+#define IP_PROTO_TCP 6
+#define IP_PROTO_UDP 17
+
+#define UDP_HDR_LEN 8
+#define TCP_HDR_LEN 20
+
+#define TCP_FIN 0x01
+#define TCP_SYN 0x02
+#define TCP_RST 0x04
+#define TCP_PSH 0x08
+#define TCP_ACK 0x10
+
+#define PORT_ECHO 7
+#define PORT_DISCARD 9
+#define PORT_CHARGEN 19
+
+/* largest payload that fits into one frame */
+#define IP_MAX_PAYLOAD (VIRT_MAX_FRAME - VIRT_FCS_LEN - ETH_HDR_LEN - IP_HDR_LEN)
+
+typedef struct virt_frame_s {
+    int len;
+    uint8_t data[VIRT_MAX_FRAME];
+} virt_frame_t;
+
+enum {
+    TCP_FREE = 0,
+    TCP_SYN_RCVD,
+    TCP_ESTABLISHED,
+    TCP_LAST_ACK
+};
+
+typedef struct virt_tcp_s {
+    int state;
+    uint8_t remote_ip[4];
+    uint8_t local_ip[4];
+    unsigned int remote_port;
+    unsigned int local_port;
+    uint32_t snd_nxt;
+    uint32_t rcv_nxt;
+} virt_tcp_t;
+
+typedef struct virt_stats_s {
+    unsigned long tx_frames;
+    unsigned long tx_bytes;
+    unsigned long rx_frames;
+    unsigned long rx_bytes;
+    unsigned long dropped;
+    unsigned long unanswered;
+} virt_stats_t;
+
+static log_t rawnet_arch_log = LOG_ERR;
+
+static int virt_active = 0;
+static int virt_rx_enabled = 0;
+
+/* the peer uses a locally administered unicast address */
+static const uint8_t virt_mac[6] = { 0x02, 0x56, 0x49, 0x43, 0x45, 0x01 };
+
+static virt_frame_t virt_queue[VIRT_QUEUE_SIZE];
+static unsigned int virt_queue_head = 0;
+static unsigned int virt_queue_tail = 0;
+
+static virt_tcp_t virt_tcp[VIRT_TCP_CONNECTIONS];
+static uint32_t virt_tcp_iss = 0;
+
+static virt_stats_t virt_stats;
+
+static int enumadapter_done = 0;
+
+/* ------------------------------------------------------------------------- */
+/*    helpers                                                                */
+
+static unsigned int get_be16(const uint8_t *p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+static uint32_t get_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void set_be16(uint8_t *p, unsigned int value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+static void set_be32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+/* one's complement sum as used by the IP, ICMP, UDP and TCP checksums */
+static uint32_t csum_add(uint32_t sum, const uint8_t *p, int len)
+{
+    while (len > 1) {
+        sum += (p[0] << 8) | p[1];
+        p += 2;
+        len -= 2;
+    }
+    if (len > 0) {
+        sum += p[0] << 8;
+    }
+    return sum;
+}
+
+static unsigned int csum_fold(uint32_t sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return ~sum & 0xffff;
+}
+
+/* checksum over the IPv4 pseudo header and the transport segment */
+static unsigned int csum_transport(const uint8_t *ip, int proto, const uint8_t *seg, int len)
+{
+    uint32_t sum = 0;
+
+    sum = csum_add(sum, ip + 12, 8);
+    sum += proto + len;
+    return csum_fold(csum_add(sum, seg, len));
+}
+
+/* ------------------------------------------------------------------------- */
+/*    receive queue                                                          */
+
+static int queue_used(void)
+{
+    return (int)(virt_queue_tail - virt_queue_head);
+}
+
+/* Returns the frame at the tail of the queue to be filled, or NULL if the
+   queue is full.  The frame is only queued by queue_commit().  */
+static uint8_t *queue_reserve(void)
+{
+    if (queue_used() >= VIRT_QUEUE_SIZE) {
+        return NULL;
+    }
+    return virt_queue[virt_queue_tail & (VIRT_QUEUE_SIZE - 1)].data;
+}
+
+static void queue_commit(int len)
+{
+    virt_frame_t *frame = &virt_queue[virt_queue_tail & (VIRT_QUEUE_SIZE - 1)];
+
+    if (len < VIRT_MIN_FRAME - VIRT_FCS_LEN) {
+        memset(frame->data + len, 0, VIRT_MIN_FRAME - VIRT_FCS_LEN - len);
+        len = VIRT_MIN_FRAME - VIRT_FCS_LEN;
+    }
+    crc32_to_le(frame->data + len, crc32_buf((const char *)frame->data, (unsigned int)len));
+    frame->len = len + VIRT_FCS_LEN;
+
+    virt_queue_tail++;
+}
+
+static void queue_clear(void)
+{
+    virt_queue_head = 0;
+    virt_queue_tail = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*    building answers                                                       */
+
+/* Fills in the ethernet header of an answer to the frame `req'.  */
+static void build_eth(uint8_t *out, const uint8_t *req, unsigned int type)
+{
+    memcpy(out, req + 6, 6);
+    memcpy(out + 6, virt_mac, 6);
+    set_be16(out + 12, type);
+}
+
+/* Fills in the ethernet and IP headers of an answer to the frame `req',
+   returns the length of the frame.  */
+static int build_ip(uint8_t *out, const uint8_t *req, int proto, int payload_len)
+{
+    static unsigned int ident = 0;
+    const uint8_t *req_ip = req + ETH_HDR_LEN;
+    uint8_t *ip = out + ETH_HDR_LEN;
+
+    build_eth(out, req, ETH_TYPE_IP);
+
+    ip[0] = 0x45;
+    ip[1] = 0;
+    set_be16(ip + 2, IP_HDR_LEN + payload_len);
+    set_be16(ip + 4, ident++);
+    set_be16(ip + 6, 0);
+    ip[8] = 64;
+    ip[9] = (uint8_t)proto;
+    set_be16(ip + 10, 0);
+    memcpy(ip + 12, req_ip + 16, 4);
+    memcpy(ip + 16, req_ip + 12, 4);
+    set_be16(ip + 10, csum_fold(csum_add(0, ip, IP_HDR_LEN)));
+
+    return ETH_HDR_LEN + IP_HDR_LEN + payload_len;
+}
+
+/* ------------------------------------------------------------------------- */
+/*    the peer                                                               */
+
+static int peer_arp(const uint8_t *frame, int len, uint8_t *out)
+{
+    const uint8_t *arp = frame + ETH_HDR_LEN;
+    uint8_t *reply = out + ETH_HDR_LEN;
+
+    if (len < ETH_HDR_LEN + 28
+        || get_be16(arp) != 1 || get_be16(arp + 2) != ETH_TYPE_IP
+        || arp[4] != 6 || arp[5] != 4 || get_be16(arp + 6) != 1) {
+        return 0;
+    }
+
+    /* ignore address probes and gratuitous announcements */
+    if (get_be32(arp + 14) == 0 || memcmp(arp + 14, arp + 24, 4) == 0) {
+        return 0;
+    }
+
+    build_eth(out, frame, ETH_TYPE_ARP);
+    memcpy(reply, arp, 6);
+    set_be16(reply + 6, 2);
+    memcpy(reply + 8, virt_mac, 6);
+    memcpy(reply + 14, arp + 24, 4);
+    memcpy(reply + 18, arp + 8, 10);
+
+    return ETH_HDR_LEN + 28;
+}
+
+static int peer_icmp(const uint8_t *frame, const uint8_t *seg, int seg_len, uint8_t *out)
+{
+    uint8_t *icmp = out + ETH_HDR_LEN + IP_HDR_LEN;
+
+    /* echo request */
+    if (seg_len < 8 || seg[0] != 8) {
+        return 0;
+    }
+
+    memcpy(icmp, seg, seg_len);
+    icmp[0] = 0;
+    set_be16(icmp + 2, 0);
+    set_be16(icmp + 2, csum_fold(csum_add(0, icmp, seg_len)));
+
+    return build_ip(out, frame, IP_PROTO_ICMP, seg_len);
+}
+
+static int peer_udp(const uint8_t *frame, const uint8_t *seg, int seg_len, uint8_t *out)
+{
+    uint8_t *udp = out + ETH_HDR_LEN + IP_HDR_LEN;
+    int data_len;
+    int i;
+
+    if (seg_len < UDP_HDR_LEN || (int)get_be16(seg + 4) > seg_len) {
+        return 0;
+    }
+    seg_len = get_be16(seg + 4);
+    data_len = seg_len - UDP_HDR_LEN;
+
+    switch (get_be16(seg + 2)) {
+        case PORT_ECHO:
+            memcpy(udp + UDP_HDR_LEN, seg + UDP_HDR_LEN, data_len);
+            break;
+        case PORT_CHARGEN:
+            /* RFC 864: a random number of characters, here the same length
+               as the request, at least one line */
+            if (data_len < 74) {
+                data_len = 74;
+            }
+            for (i = 0; i < data_len; i++) {
+                udp[UDP_HDR_LEN + i] = (uint8_t)((i % 74) >= 72 ? "\r\n"[(i % 74) - 72] : ' ' + 1 + ((i / 74 + i % 74) % 94));
+            }
+            break;
+        default:
+            return 0;
+    }
+
+    set_be16(udp, get_be16(seg + 2));
+    set_be16(udp + 2, get_be16(seg));
+    set_be16(udp + 4, UDP_HDR_LEN + data_len);
+    set_be16(udp + 6, 0);
+    build_ip(out, frame, IP_PROTO_UDP, UDP_HDR_LEN + data_len);
+    set_be16(udp + 6, csum_transport(out + ETH_HDR_LEN, IP_PROTO_UDP, udp, UDP_HDR_LEN + data_len));
+
+    return ETH_HDR_LEN + IP_HDR_LEN + UDP_HDR_LEN + data_len;
+}
+
+static int tcp_segment(const uint8_t *frame, const uint8_t *seg, uint8_t *out,
+                       uint32_t seq, uint32_t ack, int flags,
+                       const uint8_t *data, int data_len)
+{
+    uint8_t *tcp = out + ETH_HDR_LEN + IP_HDR_LEN;
+    int hdr_len = (flags & TCP_SYN) ? TCP_HDR_LEN + 4 : TCP_HDR_LEN;
+
+    set_be16(tcp, get_be16(seg + 2));
+    set_be16(tcp + 2, get_be16(seg));
+    set_be32(tcp + 4, seq);
+    set_be32(tcp + 8, ack);
+    tcp[12] = (uint8_t)((hdr_len / 4) << 4);
+    tcp[13] = (uint8_t)flags;
+    set_be16(tcp + 14, IP_MAX_PAYLOAD - TCP_HDR_LEN);
+    set_be16(tcp + 16, 0);
+    set_be16(tcp + 18, 0);
+    if (flags & TCP_SYN) {
+        /* maximum segment size option */
+        tcp[20] = 2;
+        tcp[21] = 4;
+        set_be16(tcp + 22, IP_MAX_PAYLOAD - TCP_HDR_LEN);
+    }
+    if (data_len > 0) {
+        memcpy(tcp + hdr_len, data, data_len);
+    }
+
+    build_ip(out, frame, IP_PROTO_TCP, hdr_len + data_len);
+    set_be16(tcp + 16, csum_transport(out + ETH_HDR_LEN, IP_PROTO_TCP, tcp, hdr_len + data_len));
+
+    return ETH_HDR_LEN + IP_HDR_LEN + hdr_len + data_len;
+}
+
+static virt_tcp_t *tcp_lookup(const uint8_t *ip, const uint8_t *seg)
+{
+    int i;
+
+    for (i = 0; i < VIRT_TCP_CONNECTIONS; i++) {
+        virt_tcp_t *conn = &virt_tcp[i];
+
+        if (conn->state != TCP_FREE
+            && conn->remote_port == get_be16(seg)
+            && conn->local_port == get_be16(seg + 2)
+            && memcmp(conn->remote_ip, ip + 12, 4) == 0
+            && memcmp(conn->local_ip, ip + 16, 4) == 0) {
+            return conn;
+        }
+    }
+    return NULL;
+}
+
+static virt_tcp_t *tcp_open(const uint8_t *ip, const uint8_t *seg)
+{
+    int i;
+
+    for (i = 0; i < VIRT_TCP_CONNECTIONS; i++) {
+        virt_tcp_t *conn = &virt_tcp[i];
+
+        if (conn->state == TCP_FREE) {
+            memcpy(conn->remote_ip, ip + 12, 4);
+            memcpy(conn->local_ip, ip + 16, 4);
+            conn->remote_port = get_be16(seg);
+            conn->local_port = get_be16(seg + 2);
+            conn->rcv_nxt = get_be32(seg + 4) + 1;
+            virt_tcp_iss += 0x10000;
+            conn->snd_nxt = virt_tcp_iss;
+            conn->state = TCP_SYN_RCVD;
+            return conn;
+        }
+    }
+    return NULL;
+}
+
+static int peer_tcp(const uint8_t *frame, const uint8_t *seg, int seg_len, uint8_t *out)
+{
+    const uint8_t *ip = frame + ETH_HDR_LEN;
+    virt_tcp_t *conn;
+    uint32_t seq;
+    int hdr_len;
+    int data_len;
+    int flags;
+    int port;
+
+    if (seg_len < TCP_HDR_LEN) {
+        return 0;
+    }
+    hdr_len = (seg[12] >> 4) * 4;
+    if (hdr_len < TCP_HDR_LEN || hdr_len > seg_len) {
+        return 0;
+    }
+    data_len = seg_len - hdr_len;
+    flags = seg[13];
+    seq = get_be32(seg + 4);
+    port = get_be16(seg + 2);
+
+    if (flags & TCP_RST) {
+        conn = tcp_lookup(ip, seg);
+        if (conn != NULL) {
+            conn->state = TCP_FREE;
+        }
+        return 0;
+    }
+
+    conn = tcp_lookup(ip, seg);
+
+    if ((flags & (TCP_SYN | TCP_ACK)) == TCP_SYN) {
+        if (conn == NULL && (port == PORT_ECHO || port == PORT_DISCARD)) {
+            conn = tcp_open(ip, seg);
+        }
+        if (conn == NULL) {
+            return tcp_segment(frame, seg, out, 0, seq + data_len + 1, TCP_RST | TCP_ACK, NULL, 0);
+        }
+        /* a new or a repeated SYN */
+        return tcp_segment(frame, seg, out, conn->snd_nxt, conn->rcv_nxt, TCP_SYN | TCP_ACK, NULL, 0);
+    }
+
+    if (conn == NULL) {
+        if (flags & TCP_ACK) {
+            return tcp_segment(frame, seg, out, get_be32(seg + 8), 0, TCP_RST, NULL, 0);
+        }
+        return tcp_segment(frame, seg, out, 0, seq + data_len, TCP_RST | TCP_ACK, NULL, 0);
+    }
+
+    if (conn->state == TCP_SYN_RCVD && (flags & TCP_ACK) && get_be32(seg + 8) == conn->snd_nxt + 1) {
+        conn->snd_nxt++;
+        conn->state = TCP_ESTABLISHED;
+    }
+
+    if (conn->state == TCP_LAST_ACK) {
+        if ((flags & TCP_ACK) && get_be32(seg + 8) == conn->snd_nxt) {
+            conn->state = TCP_FREE;
+            return 0;
+        }
+        /* our FIN got lost, send it again */
+        return tcp_segment(frame, seg, out, conn->snd_nxt - 1, conn->rcv_nxt, TCP_FIN | TCP_ACK, NULL, 0);
+    }
+
+    if (seq != conn->rcv_nxt) {
+        /* out of order or repeated, acknowledge what we have */
+        if (data_len > 0 || (flags & TCP_FIN)) {
+            return tcp_segment(frame, seg, out, conn->snd_nxt, conn->rcv_nxt, TCP_ACK, NULL, 0);
+        }
+        return 0;
+    }
+
+    conn->rcv_nxt += data_len;
+
+    if (flags & TCP_FIN) {
+        conn->rcv_nxt++;
+        conn->snd_nxt++;
+        conn->state = TCP_LAST_ACK;
+        /* the echoed data and the FIN share one segment */
+        if (port == PORT_ECHO && data_len > 0) {
+            conn->snd_nxt += data_len;
+            return tcp_segment(frame, seg, out, conn->snd_nxt - data_len - 1, conn->rcv_nxt,
+                               TCP_FIN | TCP_PSH | TCP_ACK, seg + hdr_len, data_len);
+        }
+        return tcp_segment(frame, seg, out, conn->snd_nxt - 1, conn->rcv_nxt, TCP_FIN | TCP_ACK, NULL, 0);
+    }
+
+    if (data_len == 0) {
+        return 0;
+    }
+
+    if (port == PORT_ECHO) {
+        conn->snd_nxt += data_len;
+        return tcp_segment(frame, seg, out, conn->snd_nxt - data_len, conn->rcv_nxt,
+                           TCP_PSH | TCP_ACK, seg + hdr_len, data_len);
+    }
+    return tcp_segment(frame, seg, out, conn->snd_nxt, conn->rcv_nxt, TCP_ACK, NULL, 0);
+}
+
+static int peer_ip(const uint8_t *frame, int len, uint8_t *out)
+{
+    const uint8_t *ip = frame + ETH_HDR_LEN;
+    int hdr_len;
+    int total_len;
+
+    if (len < ETH_HDR_LEN + IP_HDR_LEN || (ip[0] >> 4) != 4) {
+        return 0;
+    }
+    hdr_len = (ip[0] & 0x0f) * 4;
+    total_len = get_be16(ip + 2);
+    if (hdr_len < IP_HDR_LEN || total_len < hdr_len || total_len > len - ETH_HDR_LEN
+        || total_len > IP_HDR_LEN + IP_MAX_PAYLOAD
+        || csum_fold(csum_add(0, ip, hdr_len)) != 0) {
+        return 0;
+    }
+
+    /* fragments are not reassembled */
+    if (get_be16(ip + 6) & 0x3fff) {
+        return 0;
+    }
+
+    /* nobody is there to answer broadcasts and multicasts */
+    if (ip[16] >= 224 || (frame[0] & 1)) {
+        return 0;
+    }
+
+    switch (ip[9]) {
+        case IP_PROTO_ICMP:
+            return peer_icmp(frame, ip + hdr_len, total_len - hdr_len, out);
+        case IP_PROTO_UDP:
+            return peer_udp(frame, ip + hdr_len, total_len - hdr_len, out);
+        case IP_PROTO_TCP:
+            return peer_tcp(frame, ip + hdr_len, total_len - hdr_len, out);
+    }
+    return 0;
+}
+
+/* Handles a frame sent by the chip, returns non-zero if an answer was
+   queued.  */
+static int peer_handle_frame(const uint8_t *frame, int len)
+{
+    uint8_t *out;
+    int out_len = 0;
+
+    out = queue_reserve();
+    if (out == NULL) {
+        virt_stats.dropped++;
+        return 0;
+    }
+
+    if (len >= ETH_HDR_LEN) {
+        switch (get_be16(frame + 12)) {
+            case ETH_TYPE_ARP:
+                out_len = peer_arp(frame, len, out);
+                break;
+            case ETH_TYPE_IP:
+                out_len = peer_ip(frame, len, out);
+                break;
+        }
+    }
+
+    if (out_len == 0) {
+        virt_stats.unanswered++;
+        return 0;
+    }
+
+    queue_commit(out_len);
+    return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/*    rawnetarch.h API                                                       */
+
+int rawnet_arch_enumadapter_open(void)
+{
+    enumadapter_done = 0;
+    return 1;
+}
+
+int rawnet_arch_enumadapter(char **ppname, char **ppdescription)
+{
+    if (enumadapter_done) {
+        return 0;
+    }
+    enumadapter_done = 1;
+
+    *ppname = lib_stralloc(RAWNET_VIRTUAL_NAME);
+    *ppdescription = lib_stralloc(RAWNET_VIRTUAL_DESCRIPTION);
+    return 1;
+}
+
+int rawnet_arch_enumadapter_close(void)
+{
+    return 1;
+}
+
+char *rawnet_arch_get_standard_interface(void)
+{
+    return lib_stralloc(RAWNET_VIRTUAL_NAME);
+}
+
+int rawnet_arch_init(void)
+{
+    rawnet_arch_log = log_open("RAWNET");
+    return 1;
+}
+
+void rawnet_arch_pre_reset(void)
+{
+    virt_rx_enabled = 0;
+}
+
+void rawnet_arch_post_reset(void)
+{
+    queue_clear();
+    memset(virt_tcp, 0, sizeof(virt_tcp));
+}
+
+int rawnet_arch_activate(const char *interface_name)
+{
+    if (interface_name == NULL || strcmp(interface_name, RAWNET_VIRTUAL_NAME) != 0) {
+        log_error(rawnet_arch_log, "Unknown ethernet interface `%s', only `%s' is available.",
+                  interface_name ? interface_name : "", RAWNET_VIRTUAL_NAME);
+        return 0;
+    }
+
+    queue_clear();
+    memset(virt_tcp, 0, sizeof(virt_tcp));
+    memset(&virt_stats, 0, sizeof(virt_stats));
+    virt_active = 1;
+
+    log_message(rawnet_arch_log, "Using interface `%s' (%s).", RAWNET_VIRTUAL_NAME, RAWNET_VIRTUAL_DESCRIPTION);
+    return 1;
+}
+
+void rawnet_arch_deactivate(void)
+{
+    if (!virt_active) {
+        return;
+    }
+    virt_active = 0;
+
+    log_message(rawnet_arch_log,
+                "Detached: sent %lu frames (%lu bytes), received %lu frames (%lu bytes), %lu unanswered, %lu dropped.",
+                virt_stats.tx_frames, virt_stats.tx_bytes, virt_stats.rx_frames, virt_stats.rx_bytes,
+                virt_stats.unanswered, virt_stats.dropped);
+}
+
+void rawnet_arch_set_mac(const uint8_t mac[6])
+{
+    /* answers are addressed to the sender of the request */
+}
+
+void rawnet_arch_set_hashfilter(const uint32_t hash_mask[2])
+{
+    /* the chip emulation filters the frames itself */
+}
+
+void rawnet_arch_recv_ctl(int bBroadcast, int bIA, int bMulticast, int bCorrect, int bPromiscuous, int bIAHash)
+{
+    /* the chip emulation filters the frames itself */
+}
+
+void rawnet_arch_line_ctl(int bEnableTransmitter, int bEnableReceiver)
+{
+    virt_rx_enabled = bEnableReceiver;
+
+    /* answers to frames the chip can no longer receive are lost */
+    if (!bEnableReceiver) {
+        queue_clear();
+    }
+}
+
+void rawnet_arch_transmit(int force, int onecoll, int inhibit_crc, int tx_pad_dis, int txlength, uint8_t *txframe)
+{
+    if (!virt_active) {
+        return;
+    }
+
+    virt_stats.tx_frames++;
+    virt_stats.tx_bytes += txlength;
+
+    if (virt_rx_enabled) {
+        peer_handle_frame(txframe, txlength);
+    }
+}
+
+int rawnet_arch_receive(uint8_t *pbuffer, int *plen, int *phashed, int *phash_index, int *prx_ok, int *pcorrect_mac, int *pbroadcast, int *pcrc_error)
+{
+    virt_frame_t *frame;
+    int len;
+
+    if (!virt_active || queue_used() == 0) {
+        return 0;
+    }
+
+    frame = &virt_queue[virt_queue_head & (VIRT_QUEUE_SIZE - 1)];
+    virt_queue_head++;
+
+    /* the chip always reads whole words */
+    len = frame->len;
+    if (len > *plen) {
+        len = *plen;
+    }
+    memcpy(pbuffer, frame->data, len);
+    if (len & 1) {
+        pbuffer[len++] = 0;
+    }
+
+    *plen = len;
+    *phashed = 0;
+    *phash_index = 0;
+    *pcorrect_mac = 0;
+    *pbroadcast = 0;
+    *prx_ok = 1;
+    *pcrc_error = 0;
+
+    virt_stats.rx_frames++;
+    virt_stats.rx_bytes += len;
+
+    return 1;
+}
+
+#endif /* #ifdef HAVE_RAWNET */
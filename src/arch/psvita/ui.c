@@ -268,6 +268,11 @@ int c64scui_init_early(void)
     return 0;
 }
 
+int scpu64ui_init_early(void)
+{
+    return 0;
+}
+
 int c64ui_init(void)
 {
 	return 0;
@@ -278,12 +283,24 @@ int c64scui_init(void)
 	return 0;
 }
 
+int scpu64ui_init(void)
+{
+	return 0;
+}
+
 void c64ui_shutdown(void)
 {
+	PSV_Shutdown();
 }
 
 void c64scui_shutdown(void)
 {
+	PSV_Shutdown();
+}
+
+void scpu64ui_shutdown(void)
+{
+	PSV_Shutdown();
 }
 
  
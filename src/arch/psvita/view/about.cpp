@@ -25,6 +25,7 @@
 #include "texter.h"
 #include "app_defs.h"
 #include "resources.h"
+#include "atlas.h"
 
 #include <vector>
 #include <vita2d.h>
@@ -51,7 +52,7 @@ void About::doModal()
 
 void About::init()
 {
-	m_rainbowLogo = vita2d_load_PNG_buffer(img_rainbow_logo);
+	m_rainbowLogo = atlasLoadTexture(img_rainbow_logo);
 }
 
 void About::show()
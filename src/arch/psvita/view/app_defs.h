@@ -22,6 +22,9 @@
 // Default configuration file
 #define DEF_CONF_FILE_PATH APP_DATA_DIR CONF_FILE_NAME
 
+// Machine state at the first 'READY.' after a hard reset
+#define BOOT_STATE_FILE APP_DATA_DIR		"bootstate.vsf"
+
 // Ini file strings
 #define INI_FILE_SEC_CONTROLS				"Controls"
 #define INI_FILE_SEC_SETTINGS				"Settings"
@@ -89,6 +92,7 @@
 #define SETTINGS_VIEW						31
 #define SETTINGS_MODEL						32
 #define SETTINGS_MODEL_NOT_IN_SNAP			33
+#define MOUSE_TOUCH_PAD						34
 
 // Setting types
 #define ST_MODEL							1 
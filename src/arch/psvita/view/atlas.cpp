@@ -0,0 +1,78 @@
+/* atlas.cpp: Application bitmaps pre-decoded into a texel file.
+
+   Copyright (C) 2019-2020 Amnon-Dan Meir.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Author contact information: 
+     Email: ammeir71@yahoo.com
+*/
+
+#include "atlas.h"
+#include "app_defs.h"
+
+#include <stdio.h>
+#include <vita2d.h>
+
+
+static FILE* s_atlas = NULL;
+
+static const AtlasRegion* findRegion(const char* img)
+{
+	for (const AtlasRegion* r = g_atlasRegions; r->img; ++r){
+		if (r->img == img)
+			return r;
+	}
+
+	return NULL;
+}
+
+vita2d_texture* atlasLoadTexture(const char* img)
+{
+	const AtlasRegion* r = findRegion(img);
+
+	if (!r)
+		return vita2d_load_PNG_buffer(img);
+
+	// Kept open, the bitmaps are loaded whenever a view is created.
+	if (!s_atlas){
+		s_atlas = fopen(APP_RESOURCES "/ui_atlas.bin", "rb");
+		if (!s_atlas)
+			return NULL;
+	}
+
+	// Same texture format vita2d_load_PNG_buffer() creates.
+	vita2d_texture* tex = vita2d_create_empty_texture(r->width, r->height);
+	if (!tex)
+		return NULL;
+
+	unsigned char* dst = (unsigned char*)vita2d_texture_get_datap(tex);
+	unsigned int dst_pitch = vita2d_texture_get_stride(tex);
+	size_t row_size = r->width * 4;
+
+	if (fseek(s_atlas, r->offset, SEEK_SET) != 0){
+		vita2d_free_texture(tex);
+		return NULL;
+	}
+
+	for (int y=0; y<r->height; ++y){
+		if (fread(dst, 1, row_size, s_atlas) != row_size){
+			vita2d_free_texture(tex);
+			return NULL;
+		}
+		dst += dst_pitch;
+	}
+
+	return tex;
+}
@@ -0,0 +1,51 @@
+/* atlas.h: Application bitmaps pre-decoded into a texel file.
+
+   Copyright (C) 2019-2020 Amnon-Dan Meir.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+   Author contact information: 
+     Email: ammeir71@yahoo.com
+
+   ---------------------------------------------------------------------
+
+   The texels (ui_atlas.bin, shipped in the app resources) and the region
+   table (atlas_data.cpp, built instead of resources.cpp) are generated at
+   build time from the PNG byte arrays in resources.cpp:
+
+   python3 src/buildtools/mkuiatlas.py resources.cpp atlas_data.cpp ui_atlas.bin
+
+   Run the same script with --check to compare every bitmap against its
+   PNG decoded by Pillow.
+*/
+
+#ifndef ATLAS_H
+#define ATLAS_H
+
+typedef struct{
+	const char* img;	// Placeholder of the PNG byte array in resources.cpp
+	long		offset;	// Position of the RGBA texels in ui_atlas.bin
+	int			width;
+	int			height;
+} AtlasRegion;
+
+extern const AtlasRegion	 g_atlasRegions[];
+
+class vita2d_texture;
+
+// Returns a texture for a bitmap in resources.cpp. The texels are read from
+// ui_atlas.bin, bitmaps that are not in it are decoded from the PNG.
+vita2d_texture*	atlasLoadTexture(const char* img);
+
+#endif
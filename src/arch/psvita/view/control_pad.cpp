@@ -28,8 +28,11 @@
 #include <cstring>
 #include <psp2/ctrl.h>
 #include <psp2/touch.h>
+#include <psp2/kernel/processmgr.h>
 
 
+#define MOUSE_TOUCH_BUFFERS	4
+
 static int	gs_analogDirectionLookUp[9] = {0, ANALOG_UP, ANALOG_DOWN, 0, ANALOG_LEFT, 0, 0, 0, ANALOG_RIGHT};
 
 ControlPad::ControlPad()
@@ -48,16 +51,23 @@ void ControlPad::init(View* view, Controls* controls, VirtualKeyboard* keyboard)
 	m_joystickMask = 0x00;
 	m_realBtnMask = 0;
 	m_joystickScanSide = 0;
+	m_mouseTouchPort = SCE_TOUCH_PORT_BACK;
+	m_mouseLastTime = 0;
+	m_mouseFingerId = -1;
+	m_mouseLastX = 0;
+	m_mouseLastY = 0;
+	m_mouseButton = 0;
 	
 	// Digital buttons + Analog support.
 	sceCtrlSetSamplingMode(SCE_CTRL_MODE_ANALOG);
 	
-	// Enable front touchscreen
+	// Enable front touchscreen and rear touchpad
 	sceTouchSetSamplingState(SCE_TOUCH_PORT_FRONT, SCE_TOUCH_SAMPLING_STATE_START);
+	sceTouchSetSamplingState(SCE_TOUCH_PORT_BACK, SCE_TOUCH_SAMPLING_STATE_START);
 	//sceTouchEnableTouchForce(SCE_TOUCH_PORT_FRONT);
 }
 
-void ControlPad::scan(ControlPadMap** maps, int* psize, bool scan_keyboard, bool scan_mouse)
+void ControlPad::scan(ControlPadMap** maps, int* psize, int max_size, bool scan_keyboard, bool scan_mouse)
 {
 	static SceCtrlData ctrl;
 	static SceTouchData touch;
@@ -116,6 +126,121 @@ void ControlPad::scan(ControlPadMap** maps, int* psize, bool scan_keyboard, bool
 		m_keyboard->input(touchBuf, touch_count);
 		m_keyboard->getKeyMaps(maps, psize);
 	}
+
+	if (scan_mouse)
+		getMouseMaps(maps + *psize, psize, max_size - *psize, scan_keyboard);
+}
+
+void ControlPad::getMouseMaps(ControlPadMap** maps, int* size, int max_size, bool keyboard_on_view)
+{
+	// Every new touch sample becomes a map with the finger movement since the previous sample
+	// and its age, so the mouse emulation can replay the samples at their own times and no
+	// button press or release between two frames is lost.
+	// A second finger on the pad holds the left mouse button.
+	// When there is no room for another map the movement is added to the last one.
+
+	static SceTouchData touch[MOUSE_TOUCH_BUFFERS];
+	static ControlPadMap mouseBuf[MOUSE_TOUCH_BUFFERS + 1];
+	int order[MOUSE_TOUCH_BUFFERS];
+	int count = 0;
+	int buf_count = 0;
+
+	if (max_size <= 0)
+		return;
+
+	// The front touchscreen belongs to the keyboard when it is on view.
+	if (m_mouseTouchPort != SCE_TOUCH_PORT_FRONT || !keyboard_on_view)
+		count = sceTouchPeek(m_mouseTouchPort, touch, MOUSE_TOUCH_BUFFERS);
+
+	if (count <= 0){
+		// Nothing to read. Let go of the finger and the button.
+		m_mouseFingerId = -1;
+		if (m_mouseButton){
+			m_mouseButton = 0;
+			ControlPadMap* map = &mouseBuf[0];
+			memset(map, 0, sizeof(ControlPadMap));
+			map->istouch = 1;
+			*maps++ = map; (*size)++;
+		}
+		return;
+	}
+
+	// Handle the samples from the oldest to the newest.
+	for (int i=0; i<count; ++i){
+		int j = i;
+		while (j > 0 && touch[order[j-1]].timeStamp > touch[i].timeStamp){
+			order[j] = order[j-1];
+			j--;
+		}
+		order[j] = i;
+	}
+
+	// The ages count from now, so the samples keep their spacing from one scan to the next.
+	// Should the clocks not agree, the newest sample counts as taken now.
+	unsigned long long latest = touch[order[count-1]].timeStamp;
+	unsigned long long now = sceKernelGetProcessTimeWide();
+	if (now < latest || now - latest > 100000)
+		now = latest;
+
+	for (int i=0; i<count; ++i){
+		SceTouchData* sample = &touch[order[i]];
+
+		if (sample->timeStamp <= m_mouseLastTime)
+			continue;
+
+		m_mouseLastTime = sample->timeStamp;
+
+		int dx = 0, dy = 0;
+		int button = sample->reportNum > 1;
+
+		if (sample->reportNum > 0){
+			// Follow the same finger as long as it stays on the pad.
+			SceTouchReport* report = &sample->report[0];
+			for (int k=0; k<sample->reportNum; ++k){
+				if (sample->report[k].id == m_mouseFingerId){
+					report = &sample->report[k];
+					break;
+				}
+			}
+
+			if (report->id == m_mouseFingerId){
+				dx = report->x - m_mouseLastX;
+				dy = report->y - m_mouseLastY;
+			}
+
+			m_mouseFingerId = report->id;
+			m_mouseLastX = report->x;
+			m_mouseLastY = report->y;
+		}
+		else{
+			m_mouseFingerId = -1;
+		}
+
+		if (!dx && !dy && button == m_mouseButton)
+			continue;
+
+		if (buf_count == max_size){
+			// Out of room, keep the movement but the button state of the newest sample.
+			ControlPadMap* map = &mouseBuf[buf_count-1];
+			map->ispress = button;
+			map->touch_x += dx;
+			map->touch_y += dy;
+			map->touch_age = (unsigned int)(now - sample->timeStamp);
+			m_mouseButton = button;
+			continue;
+		}
+
+		m_mouseButton = button;
+
+		ControlPadMap* map = &mouseBuf[buf_count++];
+		memset(map, 0, sizeof(ControlPadMap));
+		map->istouch = 1;
+		map->ispress = button;
+		map->touch_x = dx;
+		map->touch_y = dy;
+		map->touch_age = (unsigned int)(now - sample->timeStamp);
+		*maps++ = map; (*size)++;
+	}
 }
 
 void ControlPad::getMaps(int curr_bmask, int prev_bmask, 
@@ -182,6 +307,16 @@ void ControlPad::changeJoystickScanSide(const char* side)
 		m_joystickScanSide = 0;
 }
 
+void ControlPad::changeMouseTouchPad(const char* pad)
+{
+	if (!strcmp(pad, "Front"))
+		m_mouseTouchPort = SCE_TOUCH_PORT_FRONT;
+	else if (!strcmp(pad, "Rear"))
+		m_mouseTouchPort = SCE_TOUCH_PORT_BACK;
+
+	m_mouseFingerId = -1;
+}
+
 void ControlPad::waitTillButtonsReleased()
 {
 	SceCtrlData ctrl;
@@ -39,6 +39,7 @@ typedef struct{
 	int joypin;
 	int touch_x;
 	int touch_y;
+	unsigned int touch_age; // Microseconds from the touch sample to the scan
 } ControlPadMap;
 
 
@@ -62,18 +63,28 @@ private:
 	// button presses/releases and to help identify the right map.
 	int				m_realBtnMask;
 
+	// Touch pad mouse.
+	int				m_mouseTouchPort;
+	unsigned long long m_mouseLastTime;
+	int				m_mouseFingerId;
+	int				m_mouseLastX;
+	int				m_mouseLastY;
+	int				m_mouseButton;
+
 	int				touchCoordinatesToButton(int x, int y);
 	void			getMaps(int curr_bmask, int prev_bmask, 
 							char curr_jmask, char prev_jmask,
 							ControlPadMap** maps, int* size);
+	void			getMouseMaps(ControlPadMap** maps, int* size, int max_size, bool keyboard_on_view);
 	
 public:
 					ControlPad();
 	virtual			~ControlPad();
 
 	void			init(View*, Controls*, VirtualKeyboard*);
-	void			scan(ControlPadMap** maps, int* size, bool touchScan, bool scan_mouse = false);
+	void			scan(ControlPadMap** maps, int* size, int max_size, bool touchScan, bool scan_mouse = false);
 	void			changeJoystickScanSide(const char* side);
+	void			changeMouseTouchPad(const char* pad);
 	void			waitTillButtonsReleased();
 };
 
@@ -29,6 +29,7 @@
 #include "file_explorer.h"
 #include "ini_parser.h"
 #include "resources.h"
+#include "atlas.h"
 #include "app_defs.h"
 #include "debug_psv.h"
 #include <cstring>
@@ -857,113 +858,113 @@ void Controls::loadResources()
 {
 	BitmapInfo bi;
 	bi.size = 1;
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_up_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_up_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_analog_up_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_analog_up_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_down_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_down_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_analog_down_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_analog_down_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_left_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_left_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_analog_left_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_analog_left_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_right_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_analog_right_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_analog_right_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_analog_right_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_up_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_up_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_up_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_up_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_down_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_down_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_down_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_down_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_left_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_left_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_left_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_left_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_right_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_dpad_right_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_right_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_dpad_right_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_cross_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_cross_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_cross_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_cross_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_square_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_square_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_square_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_square_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_triangle_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_triangle_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_triangle_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_triangle_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_circle_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_circle_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_circle_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_circle_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_select_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_select_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_select_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_select_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_start_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_start_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_start_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_start_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
 	g_controlBitmaps.push_back(bi);
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_rtrigger_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_rtrigger_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_rtrigger_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_rtrigger_blue);
 	g_controlBitmaps.push_back(bi);
 	
 	// Combination bitmaps
 	// L + R
 	bi.size = 3; bi.x_offset[0] = 0; bi.x_offset[1] = 35; bi.x_offset[2] = 47;
 	bi.y_offset[0] = 0; bi.y_offset[1] = 5; bi.y_offset[2] = 0;
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_black);
-	bi.arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_rtrigger_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
-	bi.highlight_arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_blue);
-	bi.highlight_arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_rtrigger_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.arr[1] = atlasLoadTexture(img_ctrl_plus_black);
+	bi.arr[2] = atlasLoadTexture(img_ctrl_btn_rtrigger_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
+	bi.highlight_arr[1] = atlasLoadTexture(img_ctrl_plus_blue);
+	bi.highlight_arr[2] = atlasLoadTexture(img_ctrl_btn_rtrigger_blue);
 	g_controlBitmaps.push_back(bi);
 	// L + CROSS
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_black);
-	bi.arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_cross_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
-	bi.highlight_arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_blue);
-	bi.highlight_arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_cross_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.arr[1] = atlasLoadTexture(img_ctrl_plus_black);
+	bi.arr[2] = atlasLoadTexture(img_ctrl_btn_cross_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
+	bi.highlight_arr[1] = atlasLoadTexture(img_ctrl_plus_blue);
+	bi.highlight_arr[2] = atlasLoadTexture(img_ctrl_btn_cross_blue);
 	g_controlBitmaps.push_back(bi);
 	// L + SQUARE
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_black);
-	bi.arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_square_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
-	bi.highlight_arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_blue);
-	bi.highlight_arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_square_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.arr[1] = atlasLoadTexture(img_ctrl_plus_black);
+	bi.arr[2] = atlasLoadTexture(img_ctrl_btn_square_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
+	bi.highlight_arr[1] = atlasLoadTexture(img_ctrl_plus_blue);
+	bi.highlight_arr[2] = atlasLoadTexture(img_ctrl_btn_square_blue);
 	g_controlBitmaps.push_back(bi);
 	// L + TRIANGLE
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_black);
-	bi.arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_triangle_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
-	bi.highlight_arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_blue);
-	bi.highlight_arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_triangle_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.arr[1] = atlasLoadTexture(img_ctrl_plus_black);
+	bi.arr[2] = atlasLoadTexture(img_ctrl_btn_triangle_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
+	bi.highlight_arr[1] = atlasLoadTexture(img_ctrl_plus_blue);
+	bi.highlight_arr[2] = atlasLoadTexture(img_ctrl_btn_triangle_blue);
 	g_controlBitmaps.push_back(bi);
 	// L + CIRCLE
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_black);
-	bi.arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_circle_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
-	bi.highlight_arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_blue);
-	bi.highlight_arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_circle_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.arr[1] = atlasLoadTexture(img_ctrl_plus_black);
+	bi.arr[2] = atlasLoadTexture(img_ctrl_btn_circle_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
+	bi.highlight_arr[1] = atlasLoadTexture(img_ctrl_plus_blue);
+	bi.highlight_arr[2] = atlasLoadTexture(img_ctrl_btn_circle_blue);
 	g_controlBitmaps.push_back(bi);
 	// L + SELECT
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_black);
-	bi.arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_select_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
-	bi.highlight_arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_blue);
-	bi.highlight_arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_select_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.arr[1] = atlasLoadTexture(img_ctrl_plus_black);
+	bi.arr[2] = atlasLoadTexture(img_ctrl_btn_select_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
+	bi.highlight_arr[1] = atlasLoadTexture(img_ctrl_plus_blue);
+	bi.highlight_arr[2] = atlasLoadTexture(img_ctrl_btn_select_blue);
 	g_controlBitmaps.push_back(bi);
 	// L + START
-	bi.arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_black);
-	bi.arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_black);
-	bi.arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_start_black);
-	bi.highlight_arr[0] = vita2d_load_PNG_buffer(img_ctrl_btn_ltrigger_blue);
-	bi.highlight_arr[1] = vita2d_load_PNG_buffer(img_ctrl_plus_blue);
-	bi.highlight_arr[2] = vita2d_load_PNG_buffer(img_ctrl_btn_start_blue);
+	bi.arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_black);
+	bi.arr[1] = atlasLoadTexture(img_ctrl_plus_black);
+	bi.arr[2] = atlasLoadTexture(img_ctrl_btn_start_black);
+	bi.highlight_arr[0] = atlasLoadTexture(img_ctrl_btn_ltrigger_blue);
+	bi.highlight_arr[1] = atlasLoadTexture(img_ctrl_plus_blue);
+	bi.highlight_arr[2] = atlasLoadTexture(img_ctrl_btn_start_blue);
 	g_controlBitmaps.push_back(bi);
 }
 
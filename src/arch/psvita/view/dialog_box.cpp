@@ -24,6 +24,7 @@
 #include "texter.h"
 #include "iRenderable.h"
 #include "resources.h"
+#include "atlas.h"
 #include "debug_psv.h"
 
 #include <vector>
@@ -125,7 +126,7 @@ void MsgDialog::init(MsgDialogParams& params)
 		}
 		else{
 			// Message is an image
-			m_img = vita2d_load_PNG_buffer(params.img);
+			m_img = atlasLoadTexture(params.img);
 			m_width = vita2d_texture_get_width(m_img);
 			m_height = vita2d_texture_get_height(m_img);
 			m_box_posX = (960 - m_width) / 2;
@@ -137,8 +138,8 @@ void MsgDialog::init(MsgDialogParams& params)
 	m_fb_tex = vita2d_create_empty_texture_format(1024, 544, SCE_GXM_TEXTURE_FORMAT_A8B8G8R8);
 	m_pfb_tex = (unsigned char*)vita2d_texture_get_datap(m_fb_tex);
 	// Dialog buttons.
-	m_img_btn_confirm = vita2d_load_PNG_buffer(img_ctrl_btn_cross_black);
-	m_img_btn_cancel = vita2d_load_PNG_buffer(img_ctrl_btn_circle_black);
+	m_img_btn_confirm = atlasLoadTexture(img_ctrl_btn_cross_black);
+	m_img_btn_cancel = atlasLoadTexture(img_ctrl_btn_circle_black);
 }
 
 void MsgDialog::doModal(MsgDialogResult& res)
@@ -234,7 +234,7 @@ int Extractor::getImageType(const char* image)
 	string file = image;
 
 	static const char* disk_ext[] = {"D64","D71","D80","D81","D82","G64","G41","X64",0};
-	static const char* tape_ext[] = {"T64","TAP",0};
+	static const char* tape_ext[] = {"T64","TAP","WAV","VOC",0};
 	static const char* cart_ext[] = {"CRT",0};
 	static const char* prog_ext[] = {"PRG","P00",0};
 
@@ -25,6 +25,7 @@
 #include "scroll_bar.h"
 #include "texter.h"
 #include "resources.h"
+#include "atlas.h"
 #include "app_defs.h"
 #include "debug_psv.h"
 #include "../zip_support.h"
@@ -96,9 +97,9 @@ void FileExplorer::init(const char* path, int hlIndex, int btIndex, float sbPosY
 	m_highlight = 0;
 	m_borderTop = 0;
 	m_borderBottom = MAX_ENTRIES-1;
-	m_file_icon = vita2d_load_PNG_buffer(img_file_icon);
-	m_folder_icon = vita2d_load_PNG_buffer(img_folder_icon);
-	m_zip_icon = vita2d_load_PNG_buffer(img_file_icon); // Use file icon for ZIP for now
+	m_file_icon = atlasLoadTexture(img_file_icon);
+	m_folder_icon = atlasLoadTexture(img_folder_icon);
+	m_zip_icon = atlasLoadTexture(img_file_icon); // Use file icon for ZIP for now
 	
 	setFilter(filter);
 	readDirContent(path);
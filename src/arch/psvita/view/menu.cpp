@@ -22,6 +22,7 @@
 
 #include "menu.h"
 #include "resources.h"
+#include "atlas.h"
 #include "app_defs.h"
 #include "debug_psv.h"
 #include <vita2d.h>
@@ -145,8 +146,8 @@ void MainMenu::renderMenu()
 
 void MainMenu::loadResources()
 {
-	m_imgMenu = vita2d_load_PNG_buffer(img_main_menu);
-	m_imgMenuArrow = vita2d_load_PNG_buffer(img_main_menu_arrow);
+	m_imgMenu = atlasLoadTexture(img_main_menu);
+	m_imgMenuArrow = atlasLoadTexture(img_main_menu_arrow);
 }
 
 
@@ -96,7 +96,7 @@ static PeripheralEntry	gs_list[] =
 static const char*		gs_browserFilter[] = {
 	"CRT",												// Cartridge image
 	"D64","D71","D80","D81","D82","G64","G41","X64",	// Disk image
-	"T64","TAP",										// Tape image
+	"T64","TAP","WAV","VOC",							// Tape image
 	"PRG","P00",										// Program image
 	"ZIP",												// Archive file
 	NULL
@@ -74,12 +74,14 @@ static const char* gs_joystickPortValues[]		= {"Port 1","Port 2"};
 static const char* gs_joystickSideValues[]		= {"Left","Right"};
 static const char* gs_keyboardModeValues[]		= {"Full screen","Split screen","Slider"};
 static const char* gs_autofireSpeedValues[]		= {"Slow","Medium","Fast"};
+static const char* gs_mouseValues[]				= {"None","1351","NEOS","Paddles"};
+static const char* gs_mouseTouchPadValues[]		= {"Rear","Front"};
 static const char* gs_cpuSpeedValues[]			= {"100%","125%","150%","175%","200%"};
 static const char* gs_hostCpuSpeedValues[]		= {"333 MHz","444 MHz"};
 static const char* gs_audioPlaybackValues[]		= {"Enabled","Disabled"};
 static const char* gs_machineResetValues[]		= {"Hard","Soft"};
 
-static int gs_settingsEntriesSize = 21;
+static int gs_settingsEntriesSize = 23;
 static SettingsEntry gs_list[] = 
 {
 	{"Machine","","",0,0,"",1}, /* Header line */
@@ -96,6 +98,8 @@ static SettingsEntry gs_list[] =
 	{"Joystick side", "JoystickSide", "Left",gs_joystickSideValues,2,"",0,ST_VIEW,JOYSTICK_SIDE,0},
 	{"Autofire speed","AutofireSpeed","Fast",gs_autofireSpeedValues,3,"",0,ST_VIEW,JOYSTICK_AUTOFIRE_SPEED,0},
 	{"Keyboard mode", "KeyboardMode", "Slider",gs_keyboardModeValues,3,"",0,ST_VIEW,KEYBOARD_MODE,0},
+	{"Mouse",         "Mouse",        "None",gs_mouseValues,4,"",0,ST_MODEL,MOUSE,0},
+	{"Mouse touch pad","MouseTouchPad","Rear",gs_mouseTouchPadValues,2,"",0,ST_VIEW,MOUSE_TOUCH_PAD,0},
 	{"Performance","","",0,0,"",1},
 	{"CPU speed",     "CPUSpeed",    "100%",gs_cpuSpeedValues,5,"",0,ST_MODEL,CPU_SPEED,0},
 	{"Host CPU speed","HostCPUSpeed","333 MHz",gs_hostCpuSpeedValues,2,"",0,ST_VIEW,HOST_CPU_SPEED,0},
@@ -686,6 +690,10 @@ void Settings::createConfFile(const char* file)
 		strcat(buf, "\x0D\x0A");
 		strcat(buf, "KeyboardMode=");
 		strcat(buf, "\x0D\x0A");
+		strcat(buf, "Mouse=");
+		strcat(buf, "\x0D\x0A");
+		strcat(buf, "MouseTouchPad=");
+		strcat(buf, "\x0D\x0A");
 		strcat(buf, "CPUSpeed=");
 		strcat(buf, "\x0D\x0A");
 		strcat(buf, "HostCPUSpeed=");
@@ -729,6 +737,7 @@ string Settings::toString(int setting)
 			case JOYSTICK_SIDE:
 			case JOYSTICK_AUTOFIRE_SPEED:
 			case KEYBOARD_MODE:
+			case MOUSE_TOUCH_PAD:
 			case HOST_CPU_SPEED:
 				ret.append(gs_list[i].key_ini_name);
 				ret.append(SNAP_MOD_DELIM_FIELD);
@@ -24,6 +24,7 @@
 #include "view.h"
 #include "texter.h"
 #include "resources.h"
+#include "atlas.h"
 #include "app_defs.h"
 #include <string.h> // memcpy
 #include <vita2d.h>
@@ -303,18 +304,18 @@ void Statusbar::notifyReset()
 
 void Statusbar::loadResources()
 {
-	m_bitmaps[IMG_SB_STATUSBAR] = vita2d_load_PNG_buffer(img_statusbar);
-	m_bitmaps[IMG_SB_LED_ON_GREEN] = vita2d_load_PNG_buffer(img_led_on_green);
-	m_bitmaps[IMG_SB_LED_ON_RED] = vita2d_load_PNG_buffer(img_led_on_red);
-	m_bitmaps[IMG_SB_LED_OFF] = vita2d_load_PNG_buffer(img_led_off);
-	m_bitmaps[IMG_SB_TAPE_STOP_MOTOR_ON] = vita2d_load_PNG_buffer(img_tape_stop_motor_on);
-	m_bitmaps[IMG_SB_TAPE_START_MOTOR_ON] = vita2d_load_PNG_buffer(img_tape_start_motor_on);
-	m_bitmaps[IMG_SB_TAPE_START_MOTOR_OFF] = vita2d_load_PNG_buffer(img_tape_start_motor_off);
-	m_bitmaps[IMG_SB_TAPE_FORWARD_MOTOR_ON] = vita2d_load_PNG_buffer(img_tape_forward_motor_on);
-	m_bitmaps[IMG_SB_TAPE_FORWARD_MOTOR_OFF] = vita2d_load_PNG_buffer(img_tape_forward_motor_off);
-	m_bitmaps[IMG_SB_TAPE_REWIND_MOTOR_ON] = vita2d_load_PNG_buffer(img_tape_rewind_motor_on);
-	m_bitmaps[IMG_SB_TAPE_REWIND_MOTOR_OFF] = vita2d_load_PNG_buffer(img_tape_rewind_motor_off);
-	m_bitmaps[IMG_SB_TAPE_RECORD_MOTOR_ON] = vita2d_load_PNG_buffer(img_tape_record_motor_on);
-	m_bitmaps[IMG_SB_TAPE_RECORD_MOTOR_OFF] = vita2d_load_PNG_buffer(img_tape_record_motor_off);
+	m_bitmaps[IMG_SB_STATUSBAR] = atlasLoadTexture(img_statusbar);
+	m_bitmaps[IMG_SB_LED_ON_GREEN] = atlasLoadTexture(img_led_on_green);
+	m_bitmaps[IMG_SB_LED_ON_RED] = atlasLoadTexture(img_led_on_red);
+	m_bitmaps[IMG_SB_LED_OFF] = atlasLoadTexture(img_led_off);
+	m_bitmaps[IMG_SB_TAPE_STOP_MOTOR_ON] = atlasLoadTexture(img_tape_stop_motor_on);
+	m_bitmaps[IMG_SB_TAPE_START_MOTOR_ON] = atlasLoadTexture(img_tape_start_motor_on);
+	m_bitmaps[IMG_SB_TAPE_START_MOTOR_OFF] = atlasLoadTexture(img_tape_start_motor_off);
+	m_bitmaps[IMG_SB_TAPE_FORWARD_MOTOR_ON] = atlasLoadTexture(img_tape_forward_motor_on);
+	m_bitmaps[IMG_SB_TAPE_FORWARD_MOTOR_OFF] = atlasLoadTexture(img_tape_forward_motor_off);
+	m_bitmaps[IMG_SB_TAPE_REWIND_MOTOR_ON] = atlasLoadTexture(img_tape_rewind_motor_on);
+	m_bitmaps[IMG_SB_TAPE_REWIND_MOTOR_OFF] = atlasLoadTexture(img_tape_rewind_motor_off);
+	m_bitmaps[IMG_SB_TAPE_RECORD_MOTOR_ON] = atlasLoadTexture(img_tape_record_motor_on);
+	m_bitmaps[IMG_SB_TAPE_RECORD_MOTOR_OFF] = atlasLoadTexture(img_tape_record_motor_off);
 	m_bitmaps[IMG_SB_NULL] = NULL;
 }
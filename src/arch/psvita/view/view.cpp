@@ -36,6 +36,7 @@
 #include "guitools.h"
 #include "iRenderable.h"
 #include "resources.h"
+#include "atlas.h"
 #include "stockfont.h"
 #include "app_defs.h"
 #include "debug_psv.h"
@@ -55,7 +56,7 @@ static int			gs_instructionBitmapsSize = 0;
 static const char*  gs_browserFilter[] = {
 	"CRT",												// Cartridge image
 	"D64","D71","D80","D81","D82","G64","G41","X64",	// Disk image
-	"T64","TAP",										// Tape image
+	"T64","TAP","WAV","VOC",							// Tape image
 	"PRG","P00",										// Program image
 	"ZIP",												// Archive file
 	NULL
@@ -519,9 +520,9 @@ bool View::isBorderlessView()
 	return m_settings->getKeyValue(BORDERS) == "Hide"? true: false;
 }
 
-void View::scanControls(ControlPadMap** maps, int* size, bool scan_mouse)
+void View::scanControls(ControlPadMap** maps, int* size, int max_size, bool scan_mouse)
 {
-	m_controlPad->scan(maps, size, g_keyboardStatus == KEYBOARD_UP, scan_mouse);
+	m_controlPad->scan(maps, size, max_size, g_keyboardStatus == KEYBOARD_UP, scan_mouse);
 }
 
 string View::showMainMenu()
@@ -730,6 +731,11 @@ void View::changeJoystickScanSide(const char* side)
 	m_controlPad->changeJoystickScanSide(side);
 }
 
+void View::changeMouseTouchPad(const char* pad)
+{
+	m_controlPad->changeMouseTouchPad(pad);
+}
+
 void View::waitKeysIdle()
 {
 	m_controlPad->waitTillButtonsReleased();
@@ -783,6 +789,9 @@ void View::setProperty(int key, const char* value)
 	case JOYSTICK_SIDE:
 		changeJoystickScanSide(value);
 		break;
+	case MOUSE_TOUCH_PAD:
+		changeMouseTouchPad(value);
+		break;
 	case JOYSTICK_AUTOFIRE_SPEED:
 		m_controller->setJoystickAutofireSpeed(value);
 		break;
@@ -968,22 +977,22 @@ void View::loadResources()
 {
 	gs_instructionBitmapsSize = 16;
 	g_instructionBitmaps = new vita2d_texture*[gs_instructionBitmapsSize];
-	g_instructionBitmaps[0] = vita2d_load_PNG_buffer(img_btn_navigate_up_down);
-	g_instructionBitmaps[1] = vita2d_load_PNG_buffer(img_btn_navigate_up_down_left);
-	g_instructionBitmaps[2] = vita2d_load_PNG_buffer(img_btn_navigate_up_down_x);
-	g_instructionBitmaps[3] = vita2d_load_PNG_buffer(img_btn_dpad_left_blue);
-	g_instructionBitmaps[4] = vita2d_load_PNG_buffer(img_btn_triangle_red);
-	g_instructionBitmaps[5] = vita2d_load_PNG_buffer(img_btn_triangle_magenta);
-	g_instructionBitmaps[6] = vita2d_load_PNG_buffer(img_btn_circle_green);
-	g_instructionBitmaps[7] = vita2d_load_PNG_buffer(img_btn_circle_yellow);
-	g_instructionBitmaps[8] = vita2d_load_PNG_buffer(img_btn_cross_green);
-	g_instructionBitmaps[9] = vita2d_load_PNG_buffer(img_btn_square_magenta);
-	g_instructionBitmaps[10] = vita2d_load_PNG_buffer(img_btn_ltrigger_blue);
-	g_instructionBitmaps[11] = vita2d_load_PNG_buffer(img_btn_rtrigger_blue);
-	g_instructionBitmaps[12] = vita2d_load_PNG_buffer(img_btn_circle_blue);
-	g_instructionBitmaps[13] = vita2d_load_PNG_buffer(img_btn_cross_blue);
-	g_instructionBitmaps[14] = vita2d_load_PNG_buffer(img_btn_square_blue);
-	g_instructionBitmaps[15] = vita2d_load_PNG_buffer(img_btn_triangle_blue);
+	g_instructionBitmaps[0] = atlasLoadTexture(img_btn_navigate_up_down);
+	g_instructionBitmaps[1] = atlasLoadTexture(img_btn_navigate_up_down_left);
+	g_instructionBitmaps[2] = atlasLoadTexture(img_btn_navigate_up_down_x);
+	g_instructionBitmaps[3] = atlasLoadTexture(img_btn_dpad_left_blue);
+	g_instructionBitmaps[4] = atlasLoadTexture(img_btn_triangle_red);
+	g_instructionBitmaps[5] = atlasLoadTexture(img_btn_triangle_magenta);
+	g_instructionBitmaps[6] = atlasLoadTexture(img_btn_circle_green);
+	g_instructionBitmaps[7] = atlasLoadTexture(img_btn_circle_yellow);
+	g_instructionBitmaps[8] = atlasLoadTexture(img_btn_cross_green);
+	g_instructionBitmaps[9] = atlasLoadTexture(img_btn_square_magenta);
+	g_instructionBitmaps[10] = atlasLoadTexture(img_btn_ltrigger_blue);
+	g_instructionBitmaps[11] = atlasLoadTexture(img_btn_rtrigger_blue);
+	g_instructionBitmaps[12] = atlasLoadTexture(img_btn_circle_blue);
+	g_instructionBitmaps[13] = atlasLoadTexture(img_btn_cross_blue);
+	g_instructionBitmaps[14] = atlasLoadTexture(img_btn_square_blue);
+	g_instructionBitmaps[15] = atlasLoadTexture(img_btn_triangle_blue);
 }
 
 
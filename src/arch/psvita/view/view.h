@@ -115,6 +115,7 @@ private:
 	void			changeKeyboardMode(const char* value);
 	void			changeTextureFilter(const char* value);
 	void			changeJoystickScanSide(const char* side);
+	void			changeMouseTouchPad(const char* pad);
 	void			waitKeysIdle();
 	string			getFileNameNoExt(const char* fpath);
 	void			setHostCpuFrequency(const char* freq);
@@ -130,7 +131,7 @@ public:
 	void			init(Controller* controller);
 
 	void			doModal();
-	void			scanControls(ControlPadMap** maps, int* size, bool scan_mouse);
+	void			scanControls(ControlPadMap** maps, int* size, int max_size, bool scan_mouse);
 	int				createView(int width, int height, int bpp);
 	void			updateView();
 	void			updateViewPos();
@@ -27,6 +27,7 @@
 #include "ini_parser.h"
 #include "debug_psv.h"
 #include "resources.h"
+#include "atlas.h"
 #include "app_defs.h"
 #include "debug_psv.h"
 #include <string.h>
@@ -105,10 +106,10 @@ void VirtualKeyboard::init(View* view, Controls* controls)
 		}
 	}
 
-	m_keyboardStd = vita2d_load_PNG_buffer(img_keyboard_std);
-	m_keyboardShift = vita2d_load_PNG_buffer(img_keyboard_shift);
-	m_keyboardCmb = vita2d_load_PNG_buffer(img_keyboard_cmb);
-	m_keyboardCtrl = vita2d_load_PNG_buffer(img_keyboard_ctrl);
+	m_keyboardStd = atlasLoadTexture(img_keyboard_std);
+	m_keyboardShift = atlasLoadTexture(img_keyboard_shift);
+	m_keyboardCmb = atlasLoadTexture(img_keyboard_cmb);
+	m_keyboardCtrl = atlasLoadTexture(img_keyboard_ctrl);
 	m_keyboard = m_keyboardStd;
 }
 
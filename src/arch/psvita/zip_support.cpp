@@ -257,7 +257,7 @@ static bool zip_is_supported_extension_internal(const char* filename) {
     
     // Add more extensions as needed for different Commodore systems
     const char* supported_exts[] = {
-        ".prg", ".p00", ".t64", ".tap", ".d64", ".d71", ".d81", 
+        ".prg", ".p00", ".t64", ".tap", ".wav", ".voc", ".d64", ".d71", ".d81", 
         ".x64", ".g64", ".crt", ".bin", ".rom", nullptr
     };
     
@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+
+#
+# mkuiatlas.py - pre-decode the PS Vita frontend bitmaps into a texel file
+#
+# This file is part of VICE, the Versatile Commodore Emulator.
+# See README for copyright notice.
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+#  02111-1307  USA.
+#
+
+# Usage:
+#   mkuiatlas.py resources.cpp atlas_data.cpp ui_atlas.bin
+#       Decode every PNG byte array in resources.cpp into ui_atlas.bin, which
+#       is shipped in the vpk, and write atlas_data.cpp, which replaces
+#       resources.cpp in the build.  The PNG arrays become one byte
+#       placeholders whose addresses still identify the bitmaps, any other
+#       array is copied unchanged.
+#   mkuiatlas.py --check resources.cpp atlas_data.cpp ui_atlas.bin
+#       Compare every bitmap in ui_atlas.bin against the PNG decoded by
+#       Pillow, a decoder independent of the one used here, and report the
+#       time taken by both.
+#
+# The bitmaps are stored one after the other as RGBA rows, the same layout
+# vita2d_load_PNG_buffer produces for SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR
+# textures: palettes and grey levels are expanded, tRNS becomes alpha, 16 bit
+# samples are stripped and images without alpha get an opaque alpha channel.
+# Identical bitmaps are stored once.
+
+import io
+import re
+import struct
+import sys
+import time
+import zlib
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+
+ARRAY_RE = r'char\s+(\w+)\s*\[\s*\d*\s*\]\s*=\s*\{([^}]*)\}\s*;'
+
+
+def parse_arrays(text):
+    """Return (name, bytes, source) for every `char xxx[] = { ... };' array."""
+    arrays = []
+    for m in re.finditer(ARRAY_RE, text):
+        data = bytes(int(v, 0) for v in re.findall(r'0x[0-9a-fA-F]+|\d+', m.group(2)))
+        arrays.append((m.group(1), data, m.group(0)))
+    return arrays
+
+
+def png_arrays(arrays):
+    """Return (name, bytes) for the arrays holding a PNG."""
+    return [(name, data) for name, data, _ in arrays if data.startswith(PNG_SIGNATURE)]
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa = abs(p - a)
+    pb = abs(p - b)
+    pc = abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+
+def unfilter(raw, height, stride, bpp):
+    out = bytearray(height * stride)
+    prev = bytearray(stride)
+    pos = 0
+    for y in range(height):
+        ftype = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        if ftype == 1:
+            for i in range(bpp, stride):
+                line[i] = (line[i] + line[i - bpp]) & 0xff
+        elif ftype == 2:
+            for i in range(stride):
+                line[i] = (line[i] + prev[i]) & 0xff
+        elif ftype == 3:
+            for i in range(stride):
+                left = line[i - bpp] if i >= bpp else 0
+                line[i] = (line[i] + ((left + prev[i]) >> 1)) & 0xff
+        elif ftype == 4:
+            for i in range(stride):
+                left = line[i - bpp] if i >= bpp else 0
+                upleft = prev[i - bpp] if i >= bpp else 0
+                line[i] = (line[i] + paeth(left, prev[i], upleft)) & 0xff
+        elif ftype != 0:
+            raise ValueError('bad filter type %d' % ftype)
+        out[y * stride:(y + 1) * stride] = line
+        prev = line
+    return out
+
+
+def decode_png(data):
+    """Decode a PNG into (width, height, RGBA bytes)."""
+    if not data.startswith(PNG_SIGNATURE):
+        raise ValueError('not a PNG')
+
+    pos = len(PNG_SIGNATURE)
+    idat = b''
+    palette = None
+    trns = None
+    while pos < len(data):
+        length, ctype = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if ctype == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif ctype == b'PLTE':
+            palette = chunk
+        elif ctype == b'tRNS':
+            trns = chunk
+        elif ctype == b'IDAT':
+            idat += chunk
+        elif ctype == b'IEND':
+            break
+
+    if interlace:
+        raise ValueError('interlaced PNGs are not supported')
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    bits = channels * depth
+    stride = (width * bits + 7) // 8
+    bpp = max(1, bits // 8)
+    raw = unfilter(zlib.decompress(idat), height, stride, bpp)
+
+    def samples(line):
+        if depth == 8:
+            return list(line)
+        if depth == 16:
+            return [line[i] for i in range(0, len(line), 2)]
+        per_byte = 8 // depth
+        mask = (1 << depth) - 1
+        out = []
+        for b in line:
+            for k in range(per_byte):
+                out.append((b >> (8 - depth * (k + 1))) & mask)
+        return out
+
+    def sample16(line, i):
+        return (line[i * 2] << 8) | line[i * 2 + 1]
+
+    rgba = bytearray(width * height * 4)
+    for y in range(height):
+        line = raw[y * stride:(y + 1) * stride]
+        s = samples(line)
+        for x in range(width):
+            o = (y * width + x) * 4
+            if color == 3:
+                i = s[x]
+                r, g, b = palette[i * 3:i * 3 + 3]
+                a = trns[i] if trns is not None and i < len(trns) else 255
+            elif color == 0:
+                v = s[x]
+                key = sample16(line, x) if depth == 16 else v
+                if depth < 8:
+                    v = v * 255 // ((1 << depth) - 1)
+                r = g = b = v
+                a = 0 if trns is not None and key == struct.unpack('>H', trns[:2])[0] else 255
+            elif color == 2:
+                r, g, b = s[x * 3:x * 3 + 3]
+                a = 255
+                if trns is not None:
+                    if depth == 16:
+                        key = tuple(sample16(line, x * 3 + k) for k in range(3))
+                    else:
+                        key = (r, g, b)
+                    if key == struct.unpack('>HHH', trns[:6]):
+                        a = 0
+            elif color == 4:
+                r = g = b = s[x * 2]
+                a = s[x * 2 + 1]
+            else:
+                r, g, b, a = s[x * 4:x * 4 + 4]
+            rgba[o:o + 4] = bytes((r, g, b, a))
+    return width, height, bytes(rgba)
+
+
+def build(arrays):
+    """Returns the texels of all bitmaps and (name, offset, width, height)
+    for every PNG array."""
+    texels = bytearray()
+    unique = {}
+    regions = []
+    for name, data in arrays:
+        # Identical bitmaps share their texels.
+        if data not in unique:
+            width, height, rgba = decode_png(data)
+            unique[data] = (len(texels), width, height)
+            texels += rgba
+        offset, width, height = unique[data]
+        regions.append((name, offset, width, height))
+    return bytes(texels), regions
+
+
+def write_atlas(path, bin_path, arrays, regions):
+    pngs = set(region[0] for region in regions)
+    with open(path, 'w') as f:
+        f.write('/* Autogenerated by mkuiatlas.py from resources.cpp, do not edit */\n\n')
+        f.write('#include "resources.h"\n')
+        f.write('#include "atlas.h"\n\n')
+        f.write('/* The bitmaps are in %s, only the addresses of these\n' % bin_path)
+        f.write('   placeholders are used to look them up.  */\n')
+        for name, _, _ in arrays:
+            if name in pngs:
+                f.write('char %s[1];\n' % name)
+        for name, _, source in arrays:
+            if name not in pngs:
+                f.write('\n%s\n' % source)
+        f.write('\nconst AtlasRegion g_atlasRegions[] = {\n')
+        for name, offset, w, h in regions:
+            f.write('\t{ %s, %d, %d, %d },\n' % (name, offset, w, h))
+        f.write('\t{ 0, 0, 0, 0 }\n};\n')
+
+
+def read_atlas(path):
+    text = open(path).read()
+    return [(m.group(1), int(m.group(2)), int(m.group(3)), int(m.group(4)))
+            for m in re.finditer(r'\{ (img_\w+), (\d+), (\d+), (\d+) \}', text)]
+
+
+def check(resources, atlas, bin_path):
+    try:
+        from PIL import Image
+    except ImportError:
+        print('--check needs Pillow as the reference PNG decoder')
+        return 2
+
+    arrays = dict(png_arrays(parse_arrays(open(resources).read())))
+    regions = read_atlas(atlas)
+    texels = open(bin_path, 'rb').read()
+
+    failed = 0
+    decode_time = 0.0
+    read_time = 0.0
+    for name, offset, w, h in regions:
+        start = time.perf_counter()
+        image = Image.open(io.BytesIO(arrays[name]))
+        image.load()
+        decode_time += time.perf_counter() - start
+        reference = image.convert('RGBA')
+
+        start = time.perf_counter()
+        region = texels[offset:offset + w * h * 4]
+        read_time += time.perf_counter() - start
+
+        if reference.size != (w, h) or region != reference.tobytes():
+            print('%s: texels do not match the PNG' % name)
+            failed += 1
+
+    if len(regions) != len(arrays):
+        print('%d PNG arrays but %d regions' % (len(arrays), len(regions)))
+        failed += 1
+
+    print('%d regions checked, %d mismatches' % (len(regions), failed))
+    print('PNG decode %.1f ms, texel read %.1f ms' % (decode_time * 1000, read_time * 1000))
+    return 1 if failed else 0
+
+
+def main(argv):
+    if len(argv) == 5 and argv[1] == '--check':
+        return check(argv[2], argv[3], argv[4])
+    if len(argv) != 4:
+        sys.stderr.write('usage: %s [--check] resources.cpp atlas_data.cpp ui_atlas.bin\n' % argv[0])
+        return 2
+    arrays = parse_arrays(open(argv[1]).read())
+    texels, regions = build(png_arrays(arrays))
+    with open(argv[3], 'wb') as f:
+        f.write(texels)
+    write_atlas(argv[2], 'ui_atlas.bin', arrays, regions)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
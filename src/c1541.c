@@ -76,6 +76,20 @@
 #include <strings.h>
 #endif
 
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#ifdef HAVE_GLOB_H
+#include <glob.h>
+#endif
+
+#ifdef HAVE_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "archdep.h"
 #include "cbmdos.h"
 #include "cbmimage.h"
@@ -96,6 +110,7 @@
 #include "tape.h"
 #include "util.h"
 #include "uiapi.h"
+#include "vicemaxpath.h"
 #include "vdrive-bam.h"
 #include "vdrive-command.h"
 #include "vdrive-dir.h"
@@ -226,6 +241,7 @@ static const char *image_format_name(unsigned int type);
 /* command handlers */
 static int attach_cmd(int nargs, char **args);
 static int bam_cmd(int nargs, char **args);
+static int batch_cmd(int nargs, char **args);
 static int bcopy_cmd(int nargs, char **args);
 static int bfill_cmd(int nargs, char **args);
 static int block_cmd(int nargs, char **args);
@@ -365,6 +381,17 @@ const command_t command_list[] = {
       "<track-max>",
       0, 3,
       bam_cmd },
+    { "batch",
+      "batch <jobs> <manifest> -<command> [<args>] [-<command> ...]",
+      "Command line only: run the remaining commands once for every disk\n"
+      "image listed in <manifest> (one per line, `-' reads stdin), or matched\n"
+      "by <manifest> if it is a wildcard pattern.  Each image is attached to\n"
+      "unit 8, `{}' in the arguments is replaced by the image name without\n"
+      "directory and extension.  Up to <jobs> images are processed at once.\n"
+      "One result line per image is written to stdout:\n"
+      "`ok|open|fail|crash <tab> <failed command or -> <tab> <image>'.",
+      2, MAXARG,
+      batch_cmd },
     { "bcopy",
       "bcopy <src-track> <src-sector> <dst-track> <dst-sector> [<src-unit> "
       "[<dst-unit>]]",
@@ -4716,6 +4743,382 @@ static int raw_cmd(int nargs, char **args)
     return FD_OK;
 }
 
+/* ------------------------------------------------------------------------- */
+/* Batch mode */
+
+/** \brief  Batch result: the image was processed successfully */
+#define BATCH_OK            0
+
+/** \brief  Batch result: the worker process died */
+#define BATCH_CRASHED       -1
+
+/** \brief  Batch result: the image could not be attached */
+#define BATCH_OPEN_FAILED   1
+
+/** \brief  Batch result: command (result - BATCH_CMD_FAILED) failed */
+#define BATCH_CMD_FAILED    2
+
+
+/** \brief  Command template for batch mode
+ *
+ * The command line after the image list, split into one argument list per
+ * command.
+ */
+typedef struct batch_cmd_s {
+    int nargs;      /**< argument count, including the command name */
+    char **args;    /**< arguments as given on the command line */
+} batch_cmd_t;
+
+
+/** \brief  'batch' command handler
+ *
+ * Batch mode is handled by main() since it needs the rest of the command
+ * line, so this only explains that.
+ *
+ * \param[in]   nargs   argument count
+ * \param[in]   args    argument list
+ *
+ * \return  FD_OK
+ */
+static int batch_cmd(int nargs, char **args)
+{
+    fprintf(stderr, "`batch' can only be used on the command line\n");
+    return FD_OK;
+}
+
+
+/** \brief  Get the wall clock time in seconds
+ */
+static double batch_time(void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+#else
+    return (double)time(NULL);
+#endif
+}
+
+
+/** \brief  Add the images of a manifest to \a list
+ *
+ * \param[in]       manifest    file with one image per line, or "-" for stdin
+ * \param[in,out]   list        image list
+ * \param[in,out]   count       number of images in \a list
+ *
+ * \return  0 on success, -1 if the manifest cannot be read
+ */
+static int batch_read_manifest(const char *manifest, char ***list, int *count)
+{
+    FILE *fd;
+    char line[PATH_MAX];
+    int size = *count;
+
+    if (strcmp(manifest, "-") == 0) {
+        fd = stdin;
+    } else {
+        fd = fopen(manifest, MODE_READ_TEXT);
+        if (fd == NULL) {
+            fprintf(stderr, "cannot open manifest `%s'\n", manifest);
+            return -1;
+        }
+    }
+
+    while (util_get_line(line, (int)sizeof line, fd) >= 0) {
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+        if (*count == size) {
+            size = size ? size * 2 : 64;
+            *list = lib_realloc(*list, (size_t)size * sizeof **list);
+        }
+        (*list)[(*count)++] = lib_stralloc(line);
+    }
+
+    if (fd != stdin) {
+        fclose(fd);
+    }
+    return 0;
+}
+
+
+/** \brief  Build the image list from a manifest or a wildcard pattern
+ *
+ * \param[in]   source  manifest file name, "-" or wildcard pattern
+ * \param[out]  count   number of images
+ *
+ * \return  image list, or NULL when empty or on error
+ */
+static char **batch_image_list(const char *source, int *count)
+{
+    char **list = NULL;
+
+    *count = 0;
+
+#ifdef HAVE_GLOB_H
+    if (strpbrk(source, "*?[") != NULL) {
+        glob_t g;
+        size_t i;
+
+        if (glob(source, 0, NULL, &g) != 0) {
+            fprintf(stderr, "no images match `%s'\n", source);
+            return NULL;
+        }
+        list = lib_malloc(g.gl_pathc * sizeof *list);
+        for (i = 0; i < g.gl_pathc; i++) {
+            list[(*count)++] = lib_stralloc(g.gl_pathv[i]);
+        }
+        globfree(&g);
+        return list;
+    }
+#endif
+
+    if (batch_read_manifest(source, &list, count) < 0) {
+        lib_free(list);
+        return NULL;
+    }
+    return list;
+}
+
+
+/** \brief  Run the command template on a single image
+ *
+ * The image is attached to unit 8 and detached again afterwards, so every
+ * image starts from a freshly set up virtual drive.
+ *
+ * \param[in]   image   disk image
+ * \param[in]   cmds    command template
+ * \param[in]   ncmds   number of commands in \a cmds
+ *
+ * \return  BATCH_OK, BATCH_OPEN_FAILED or BATCH_CMD_FAILED + command index
+ */
+static int batch_process_image(const char *image, const batch_cmd_t *cmds,
+                               int ncmds)
+{
+    char *args[MAXARG];
+    char *stem;
+    char *ext;
+    int result = BATCH_OK;
+    int c;
+    int i;
+
+    close_disk_image(drives[0], UNIT_MIN);
+    drive_index = 0;
+
+    if (open_disk_image(drives[0], image, UNIT_MIN) < 0) {
+        return BATCH_OPEN_FAILED;
+    }
+
+    util_fname_split(image, NULL, &stem);
+    ext = strrchr(stem, '.');
+    if (ext != NULL && ext != stem) {
+        *ext = '\0';
+    }
+
+    for (c = 0; c < ncmds && result == BATCH_OK; c++) {
+        args[0] = lib_stralloc(cmds[c].args[0] + 1);
+        for (i = 1; i < cmds[c].nargs; i++) {
+            args[i] = util_subst(cmds[c].args[i], "{}", stem);
+        }
+        if (lookup_and_execute_command(cmds[c].nargs, args) < 0) {
+            result = BATCH_CMD_FAILED + c;
+        }
+        for (i = 0; i < cmds[c].nargs; i++) {
+            lib_free(args[i]);
+        }
+    }
+
+    lib_free(stem);
+    close_disk_image(drives[0], UNIT_MIN);
+    return result;
+}
+
+
+/** \brief  Print the result line of an image
+ *
+ * \param[in]   image   disk image
+ * \param[in]   result  result of batch_process_image()
+ * \param[in]   cmds    command template
+ */
+static void batch_print_result(const char *image, int result,
+                               const batch_cmd_t *cmds)
+{
+    switch (result) {
+        case BATCH_OK:
+            printf("ok\t-\t%s\n", image);
+            break;
+        case BATCH_OPEN_FAILED:
+            printf("open\t-\t%s\n", image);
+            break;
+        case BATCH_CRASHED:
+            printf("crash\t-\t%s\n", image);
+            break;
+        default:
+            printf("fail\t%s\t%s\n",
+                   cmds[result - BATCH_CMD_FAILED].args[0] + 1, image);
+            break;
+    }
+    fflush(stdout);
+}
+
+
+/** \brief  Batch mode driver
+ *
+ * Syntax: batch \<jobs> \<manifest> -\<command> [\<args>] ...
+ *
+ * Where fork() is available, up to \a jobs images are processed at once,
+ * each in a worker process forked from the fully initialized c1541, so the
+ * workers get an isolated copy of the vdrive, serial and image layers without
+ * paying for process startup.  Command output of the workers goes to stderr,
+ * stdout only receives the result lines.  Without fork() the images are
+ * processed one after the other.
+ *
+ * A summary with the number of images and the elapsed time is printed to
+ * stderr, which makes `c1541 -batch` usable as a benchmark over a corpus of
+ * images.
+ *
+ * \param[in]   argc    argument count, starting with the "batch" command
+ * \param[in]   argv    argument vector
+ *
+ * \return  EXIT_SUCCESS if all images were processed, EXIT_FAILURE otherwise
+ */
+static int batch_run(int argc, char **argv)
+{
+    batch_cmd_t *cmds;
+    char **images;
+    int ncmds = 0;
+    int nimages;
+    int jobs;
+    int failed = 0;
+    int i;
+    double start;
+
+    if (argc < 4 || arg_to_int(argv[1], &jobs) < 0 || jobs < 1) {
+        fprintf(stderr, "syntax: %s\n",
+                command_list[lookup_command("batch")].syntax);
+        return EXIT_FAILURE;
+    }
+
+    /* Split the rest of the command line into commands.  */
+    cmds = lib_calloc((size_t)argc, sizeof *cmds);
+    for (i = 3; i < argc; i++) {
+        if (*argv[i] == '-') {
+            cmds[ncmds++].args = &argv[i];
+        } else if (ncmds == 0) {
+            fprintf(stderr, "expected a command instead of `%s'\n", argv[i]);
+            lib_free(cmds);
+            return EXIT_FAILURE;
+        }
+        if (++cmds[ncmds - 1].nargs > MAXARG) {
+            fprintf(stderr, "too many arguments\n");
+            lib_free(cmds);
+            return EXIT_FAILURE;
+        }
+    }
+
+    images = batch_image_list(argv[2], &nimages);
+    if (images == NULL) {
+        lib_free(cmds);
+        return EXIT_FAILURE;
+    }
+
+    start = batch_time();
+
+#ifdef HAVE_FORK
+    if (jobs > 1) {
+        pid_t *pids = lib_calloc((size_t)jobs, sizeof *pids);
+        int *slot_image = lib_calloc((size_t)jobs, sizeof *slot_image);
+        int next = 0;
+        int running = 0;
+
+        fflush(stdout);
+        fflush(stderr);
+
+        while (next < nimages || running > 0) {
+            int status;
+            pid_t pid;
+            int slot;
+
+            /* Fill all free slots.  */
+            for (slot = 0; slot < jobs && next < nimages; slot++) {
+                if (pids[slot] != 0) {
+                    continue;
+                }
+                pid = fork();
+                if (pid == 0) {
+                    int result;
+
+                    dup2(STDERR_FILENO, STDOUT_FILENO);
+                    result = batch_process_image(images[next], cmds, ncmds);
+                    fflush(stdout);
+                    _exit(result);
+                }
+                if (pid < 0) {
+                    /* Out of processes, handle it here instead.  */
+                    int result = batch_process_image(images[next], cmds, ncmds);
+
+                    batch_print_result(images[next], result, cmds);
+                    failed += (result != BATCH_OK);
+                } else {
+                    pids[slot] = pid;
+                    slot_image[slot] = next;
+                    running++;
+                }
+                next++;
+            }
+
+            if (running == 0) {
+                continue;
+            }
+
+            pid = wait(&status);
+            if (pid < 0) {
+                break;
+            }
+            for (slot = 0; slot < jobs; slot++) {
+                if (pids[slot] == pid) {
+                    int result = WIFEXITED(status) ? WEXITSTATUS(status)
+                                                   : BATCH_CRASHED;
+
+                    if (result >= BATCH_CMD_FAILED + ncmds) {
+                        result = BATCH_CRASHED;
+                    }
+                    batch_print_result(images[slot_image[slot]], result, cmds);
+                    failed += (result != BATCH_OK);
+                    pids[slot] = 0;
+                    running--;
+                    break;
+                }
+            }
+        }
+
+        lib_free(slot_image);
+        lib_free(pids);
+    } else
+#endif
+    {
+        for (i = 0; i < nimages; i++) {
+            int result = batch_process_image(images[i], cmds, ncmds);
+
+            batch_print_result(images[i], result, cmds);
+            failed += (result != BATCH_OK);
+        }
+    }
+
+    fprintf(stderr, "%d images, %d failed, %.3f seconds\n",
+            nimages, failed, batch_time() - start);
+
+    for (i = 0; i < nimages; i++) {
+        lib_free(images[i]);
+    }
+    lib_free(images);
+    lib_free(cmds);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 /* ------------------------------------------------------------------------- */
 
 /** \brief  Program driver
@@ -4816,6 +5219,11 @@ int main(int argc, char **argv)
 #endif
     } else {
         while (i < argc) {
+            if (strcmp(argv[i], "-batch") == 0) {
+                /* Batch mode takes the rest of the command line.  */
+                retval = batch_run(argc - i, argv + i);
+                break;
+            }
             args[0] = argv[i] + 1;
             nargs = 1;
             i++;
@@ -52,6 +52,7 @@
 #include "userport.h"
 #include "vice-event.h"
 #include "vicii.h"
+#include "vsyncapi.h"
 
 #define SNAP_MAJOR 1
 #define SNAP_MINOR 1
@@ -98,6 +99,9 @@ int c64_snapshot_read(const char *name, int event_mode)
 {
     snapshot_t *s;
     uint8_t minor, major;
+    unsigned long start_time;
+
+    start_time = vsyncarch_gettime();
 
     s = snapshot_open(name, &major, &minor, machine_get_name());
     if (s == NULL) {
@@ -136,6 +140,9 @@ int c64_snapshot_read(const char *name, int event_mode)
 
     sound_snapshot_finish();
 
+    log_message(LOG_DEFAULT, "Snapshot restored in %.0f us.",
+                (double)(signed long)(vsyncarch_gettime() - start_time) * 1000000.0 / vsyncarch_frequency());
+
     return 0;
 
 fail:
@@ -87,6 +87,7 @@
 #include "machine.h"
 #include "maincpu.h"
 #include "mem.h"
+#include "memheat.h"
 #include "monitor.h"
 #include "network.h"
 #include "paperclip64.h"
@@ -640,6 +641,10 @@ int machine_resources_init(void)
         return -1;
     }
 #endif
+    if (memheat_resources_init() < 0) {
+        init_resource_fail("memheat");
+        return -1;
+    }
 #ifdef HAVE_MOUSE
     if (mouse_resources_init() < 0) {
         init_resource_fail("mouse");
@@ -742,6 +747,7 @@ void machine_resources_shutdown(void)
     joyport_bbrtc_resources_shutdown();
     tapeport_resources_shutdown();
     tapecart_exit();
+    memheat_resources_shutdown();
 }
 
 /* C64-specific command-line option initialization.  */
@@ -863,6 +869,10 @@ int machine_cmdline_options_init(void)
         return -1;
     }
 #endif
+    if (memheat_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("memheat");
+        return -1;
+    }
 #ifdef HAVE_MOUSE
     if (mouse_cmdline_options_init() < 0) {
         init_cmdline_options_fail("mouse");
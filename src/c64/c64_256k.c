@@ -79,8 +79,24 @@ static char *c64_256k_filename = NULL;
 
 uint8_t *c64_256k_ram = NULL;
 
+/* Base pointers of the segments mapped into the four 16K windows of the CPU,
+   indexed with the CPU address.  */
+uint8_t *c64_256k_cpu_base[4];
+
 /* ---------------------------------------------------------------------*/
 
+static void c64_256k_update_segments(void)
+{
+    if (c64_256k_ram == NULL) {
+        return;
+    }
+    c64_256k_cpu_base[0] = c64_256k_ram + (c64_256k_segment0 * 0x4000);
+    c64_256k_cpu_base[1] = c64_256k_ram + (c64_256k_segment1 * 0x4000) - 0x4000;
+    c64_256k_cpu_base[2] = c64_256k_ram + (c64_256k_segment2 * 0x4000) - 0x8000;
+    c64_256k_cpu_base[3] = c64_256k_ram + (c64_256k_segment3 * 0x4000) - 0xc000;
+    mem_ram_banks_changed();
+}
+
 static void pia_set_vbank(void)
 {
     video_bank_segment = ((c64_256k_PRB & 0xc0) >> 4) + cia_vbank;
@@ -129,6 +145,7 @@ void c64_256k_store(uint16_t addr, uint8_t byte)
             c64_256k_PRA = byte;
             c64_256k_segment0 = (c64_256k_PRA & 0xf);
             c64_256k_segment1 = (c64_256k_PRA & 0xf0) >> 4;
+            c64_256k_update_segments();
         }
     }
     if (addr == 0 && (c64_256k_CRA & 4) == 0) {
@@ -140,6 +157,7 @@ void c64_256k_store(uint16_t addr, uint8_t byte)
             c64_256k_PRB = byte;
             c64_256k_segment2 = (c64_256k_PRB & 0xf);
             c64_256k_segment3 = (c64_256k_PRB & 0xf0) >> 4;
+            c64_256k_update_segments();
             if ((old_prb & 0xc0) != (byte & 0xc0)) {
                 pia_set_vbank();
             }
@@ -339,6 +357,7 @@ void c64_256k_reset(void)
     c64_256k_segment1 = 0xd;
     c64_256k_segment2 = 0xe;
     c64_256k_segment3 = 0xf;
+    c64_256k_update_segments();
     if (c64_256k_enabled) {
         vicii_set_ram_base(c64_256k_ram + 0x30000);
         mem_set_vbank(0);
@@ -401,7 +420,7 @@ void c64_256k_shutdown(void)
 
 void c64_256k_ram_segment0_store(uint16_t addr, uint8_t value)
 {
-    c64_256k_ram[(c64_256k_segment0 * 0x4000) + (addr & 0x3fff)] = value;
+    c64_256k_cpu_base[0][addr] = value;
     if (addr == 0xff00) {
         reu_dma(-1);
     }
@@ -409,7 +428,7 @@ void c64_256k_ram_segment0_store(uint16_t addr, uint8_t value)
 
 void c64_256k_ram_segment1_store(uint16_t addr, uint8_t value)
 {
-    c64_256k_ram[(c64_256k_segment1 * 0x4000) + (addr & 0x3fff)] = value;
+    c64_256k_cpu_base[1][addr] = value;
     if (addr == 0xff00) {
         reu_dma(-1);
     }
@@ -417,7 +436,7 @@ void c64_256k_ram_segment1_store(uint16_t addr, uint8_t value)
 
 void c64_256k_ram_segment2_store(uint16_t addr, uint8_t value)
 {
-    c64_256k_ram[(c64_256k_segment2 * 0x4000) + (addr & 0x3fff)] = value;
+    c64_256k_cpu_base[2][addr] = value;
     if (addr == 0xff00) {
         reu_dma(-1);
     }
@@ -425,7 +444,7 @@ void c64_256k_ram_segment2_store(uint16_t addr, uint8_t value)
 
 void c64_256k_ram_segment3_store(uint16_t addr, uint8_t value)
 {
-    c64_256k_ram[(c64_256k_segment3 * 0x4000) + (addr & 0x3fff)] = value;
+    c64_256k_cpu_base[3][addr] = value;
     if (addr == 0xff00) {
         reu_dma(-1);
     }
@@ -433,22 +452,22 @@ void c64_256k_ram_segment3_store(uint16_t addr, uint8_t value)
 
 uint8_t c64_256k_ram_segment0_read(uint16_t addr)
 {
-    return c64_256k_ram[(c64_256k_segment0 * 0x4000) + (addr & 0x3fff)];
+    return c64_256k_cpu_base[0][addr];
 }
 
 uint8_t c64_256k_ram_segment1_read(uint16_t addr)
 {
-    return c64_256k_ram[(c64_256k_segment1 * 0x4000) + (addr & 0x3fff)];
+    return c64_256k_cpu_base[1][addr];
 }
 
 uint8_t c64_256k_ram_segment2_read(uint16_t addr)
 {
-    return c64_256k_ram[(c64_256k_segment2 * 0x4000) + (addr & 0x3fff)];
+    return c64_256k_cpu_base[2][addr];
 }
 
 uint8_t c64_256k_ram_segment3_read(uint16_t addr)
 {
-    return c64_256k_ram[(c64_256k_segment3 * 0x4000) + (addr & 0x3fff)];
+    return c64_256k_cpu_base[3][addr];
 }
 
 /* ------------------------------------------------------------------------- */
@@ -557,6 +576,7 @@ int c64_256k_snapshot_read(struct snapshot_s *s)
         || SMR_BA(m, c64_256k_ram, 0x40000) < 0) {
         goto fail;
     }
+    c64_256k_update_segments();
 
     return snapshot_module_close(m);
    
@@ -32,6 +32,7 @@
 
 extern int c64_256k_start;
 extern int c64_256k_enabled;
+extern uint8_t *c64_256k_cpu_base[4];
 
 extern int c64_256k_resources_init(void);
 extern void c64_256k_resources_shutdown(void);
@@ -51,6 +51,7 @@
  - DMA_FUNC
  - DMA_ON_RESET
  - CHECK_AND_RUN_ALTERNATE_CPU
+ - HAVE_MEM_BANK_BASE
 
 */
 
@@ -125,4 +126,6 @@ static void check_and_run_alternate_cpu(void)
 
 #define HAVE_Z80_REGS
 
+#define HAVE_MEM_BANK_BASE
+
 #include "../maincpu.c"
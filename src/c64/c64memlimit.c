@@ -98,24 +98,61 @@ void mem_limit_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101])
     }
 }
 
+/* Clip a fetch range to the addresses lo-hi, the base pointer of the range
+   is only valid within them.  */
+static uint32_t mem_limit_clip(uint32_t limit, unsigned int lo, unsigned int hi)
+{
+    unsigned int start = limit >> 16;
+    unsigned int end = limit & 0xffff;
+
+    if (end == 0) {
+        return 0;
+    }
+    if (start < lo) {
+        start = lo;
+    }
+    if (end > hi - 2) {
+        end = hi - 2;
+    }
+    if (end <= start) {
+        return 0;
+    }
+    return (start << 16) | end;
+}
+
+/* The +60K banks $1000-$FFFF, keep the ranges on either side of $1000 */
 void mem_limit_plus60k_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101])
 {
-    int i, j, k;
+    int i, k;
 
     for (i = 0; i < NUM_CONFIGS; i++) {
-        for (j = 0; j < NUM_SEGMENTS; j++) {
-            for (k = mstart[j]; k <= mend[j]; k++) {
-                if (k < 0x10) {
-                    mem_read_limit_tab[i][k] = 0x00020ffd;
-                } else {
-                    mem_read_limit_tab[i][k] = 0;
-                }
+        for (k = 0; k < 0x100; k++) {
+            if (k < 0x10) {
+                mem_read_limit_tab[i][k] = mem_limit_clip(mem_read_limit_tab[i][k], 0x0000, 0x0fff);
+            } else {
+                mem_read_limit_tab[i][k] = mem_limit_clip(mem_read_limit_tab[i][k], 0x1000, 0xffff);
             }
         }
         mem_read_limit_tab[i][0x100] = 0;
     }
 }
 
+/* The C64 256K banks each 16K window separately, keep the ranges within a
+   window.  */
+void mem_limit_c64_256k_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101])
+{
+    int i, k;
+    unsigned int lo;
+
+    for (i = 0; i < NUM_CONFIGS; i++) {
+        for (k = 0; k < 0x100; k++) {
+            lo = (unsigned int)(k & 0xc0) << 8;
+            mem_read_limit_tab[i][k] = mem_limit_clip(mem_read_limit_tab[i][k], lo, lo + 0x3fff);
+        }
+        mem_read_limit_tab[i][0x100] = 0;
+    }
+}
+
 void mem_limit_256k_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101])
 {
     int i, j, k;
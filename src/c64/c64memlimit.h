@@ -33,6 +33,7 @@
 
 extern void mem_limit_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101]);
 extern void mem_limit_plus60k_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101]);
+extern void mem_limit_c64_256k_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101]);
 extern void mem_limit_256k_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101]);
 extern void mem_limit_max_init(uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101]);
 
@@ -54,6 +54,7 @@
 #include "mainc64cpu.h"
 #include "maincpu.h"
 #include "mem.h"
+#include "memheat.h"
 #include "monitor.h"
 #include "plus256k.h"
 #include "plus60k.h"
@@ -108,9 +109,20 @@ static read_func_ptr_t mem_read_tab[NUM_CONFIGS][0x101];
 static uint8_t *mem_read_base_tab[NUM_CONFIGS][0x101];
 static uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101];
 
+/* Bumped whenever an internal expansion switches the RAM banks seen by the
+   CPU, a configuration whose read base table is older gets refreshed when
+   it is selected.  */
+static unsigned int mem_ram_banks = 1;
+static unsigned int mem_ram_banks_tab[NUM_CONFIGS];
+
 static store_func_ptr_t mem_write_tab_watch[0x101];
 static read_func_ptr_t mem_read_tab_watch[0x101];
 
+/* Heatmap tables: the current configuration with the recording handlers
+   patched in for the selected pages.  */
+static store_func_ptr_t mem_write_tab_heat[0x101];
+static read_func_ptr_t mem_read_tab_heat[0x101];
+
 /* Current video bank (0, 1, 2 or 3).  */
 static int vbank;
 
@@ -126,6 +138,9 @@ static int tape_motor_in = 0;
 /* Current watchpoint state. 1 = watchpoints active, 0 = no watchpoints */
 static int watchpoints_active;
 
+/* Current heatmap state. 1 = recording handlers installed, 0 = none */
+static int heatmap_active;
+
 /* ------------------------------------------------------------------------- */
 
 static uint8_t zero_read_watch(uint16_t addr)
@@ -154,16 +169,79 @@ static void store_watch(uint16_t addr, uint8_t value)
     mem_write_tab[mem_config][addr >> 8](addr, value);
 }
 
-void mem_toggle_watchpoints(int flag, void *context)
+/* The heatmap handlers record the access and then call the handler of the
+   current configuration.  An opcode fetch is the only read done at the
+   current PC, which is how execution is told apart from data reads.  */
+static uint8_t zero_read_heat(uint16_t addr)
+{
+    addr &= 0xff;
+    memheat_record(addr, (addr == reg_pc) ? MEMHEAT_EXEC : MEMHEAT_READ);
+    return mem_read_tab[mem_config][0](addr);
+}
+
+static void zero_store_heat(uint16_t addr, uint8_t value)
+{
+    addr &= 0xff;
+    memheat_record(addr, MEMHEAT_WRITE);
+    mem_write_tab[mem_config][0](addr, value);
+}
+
+static uint8_t read_heat(uint16_t addr)
+{
+    memheat_record(addr, (addr == reg_pc) ? MEMHEAT_EXEC : MEMHEAT_READ);
+    return mem_read_tab[mem_config][addr >> 8](addr);
+}
+
+static void store_heat(uint16_t addr, uint8_t value)
+{
+    memheat_record(addr, MEMHEAT_WRITE);
+    mem_write_tab[mem_config][addr >> 8](addr, value);
+}
+
+/* Rebuild the heatmap tables for the current configuration.  */
+static void mem_heatmap_tables_update(void)
+{
+    int i;
+
+    for (i = 0; i <= 0x100; i++) {
+        if (memheat_page_selected((unsigned int)i & 0xff)) {
+            mem_read_tab_heat[i] = (i & 0xff) ? read_heat : zero_read_heat;
+            mem_write_tab_heat[i] = (i & 0xff) ? store_heat : zero_store_heat;
+        } else {
+            mem_read_tab_heat[i] = mem_read_tab[mem_config][i];
+            mem_write_tab_heat[i] = mem_write_tab[mem_config][i];
+        }
+    }
+}
+
+/* Select the read/write tables to use.  Watchpoints take precedence over
+   the heatmap.  */
+static void mem_update_tab_ptrs(void)
 {
-    if (flag) {
+    if (watchpoints_active) {
         _mem_read_tab_ptr = mem_read_tab_watch;
         _mem_write_tab_ptr = mem_write_tab_watch;
+    } else if (heatmap_active) {
+        mem_heatmap_tables_update();
+        _mem_read_tab_ptr = mem_read_tab_heat;
+        _mem_write_tab_ptr = mem_write_tab_heat;
     } else {
         _mem_read_tab_ptr = mem_read_tab[mem_config];
         _mem_write_tab_ptr = mem_write_tab[mem_config];
     }
+}
+
+static void mem_heatmap_changed(void)
+{
+    heatmap_active = memheat_active();
+    mem_update_tab_ptrs();
+    maincpu_resync_limits();
+}
+
+void mem_toggle_watchpoints(int flag, void *context)
+{
     watchpoints_active = flag;
+    mem_update_tab_ptrs();
 }
 
 /* ------------------------------------------------------------------------- */
@@ -206,6 +284,10 @@ static void clk_overflow_callback(CLOCK sub, void *unused_data)
 void c64_mem_init(void)
 {
     clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
+    memheat_set_update_callback(mem_heatmap_changed);
+
+    /* The heatmap resources may have been set before the memory was set up.  */
+    heatmap_active = memheat_active();
 
     /* Initialize REU BA low interface (FIXME find a better place for this) */
     reu_ba_register(vicii_cycle_reu, vicii_steal_cycles, &maincpu_ba_low_flags, MAINCPU_BA_LOW_REU);
@@ -214,26 +296,70 @@ void c64_mem_init(void)
     cpmcart_ba_register(vicii_cycle, vicii_steal_cycles, &maincpu_ba_low_flags, MAINCPU_BA_LOW_VICII);
 }
 
+/* Return the base pointer of the expansion RAM bank that `page' reads from
+   in configuration `config', or NULL if the page is not banked.  */
+static uint8_t *mem_ram_bank_base(int config, int page)
+{
+    read_func_ptr_t f = mem_read_tab[config][page];
+
+    if (c64_256k_enabled) {
+        if (f == c64_256k_ram_segment0_read
+            || f == c64_256k_ram_segment1_read
+            || f == c64_256k_ram_segment2_read
+            || f == c64_256k_ram_segment3_read
+            || f == zero_read) {
+            return c64_256k_cpu_base[(page & 0xff) >> 6];
+        }
+    } else if (plus60k_enabled) {
+        if (f == plus60k_ram_read) {
+            return plus60k_cpu_base;
+        }
+    }
+    return NULL;
+}
+
+/* Point the opcode fetch of the banked pages at the current banks.  */
+static void mem_ram_banks_update(int config)
+{
+    uint8_t *p;
+    int j;
+
+    for (j = 0; j <= 0x100; j++) {
+        p = mem_ram_bank_base(config, j);
+        if (p != NULL) {
+            mem_read_base_tab[config][j] = p;
+        }
+    }
+    mem_ram_banks_tab[config] = mem_ram_banks;
+}
+
 void mem_pla_config_changed(void)
 {
     mem_config = (((~pport.dir | pport.data) & 0x7) | (export.exrom << 3) | (export.game << 4));
 
     c64pla_config_changed(tape_sense, tape_write_in, tape_motor_in, 1, 0x17);
 
-    if (watchpoints_active) {
-        _mem_read_tab_ptr = mem_read_tab_watch;
-        _mem_write_tab_ptr = mem_write_tab_watch;
-    } else {
-        _mem_read_tab_ptr = mem_read_tab[mem_config];
-        _mem_write_tab_ptr = mem_write_tab[mem_config];
-    }
+    mem_update_tab_ptrs();
 
+    if (mem_ram_banks_tab[mem_config] != mem_ram_banks) {
+        mem_ram_banks_update(mem_config);
+    }
     _mem_read_base_tab_ptr = mem_read_base_tab[mem_config];
     mem_read_limit_tab_ptr = mem_read_limit_tab[mem_config];
 
     maincpu_resync_limits();
 }
 
+void mem_ram_banks_changed(void)
+{
+    mem_ram_banks++;
+
+    if (_mem_read_base_tab_ptr != NULL) {
+        mem_ram_banks_update(mem_config);
+        maincpu_resync_limits();
+    }
+}
+
 uint8_t zero_read(uint16_t addr)
 {
     uint8_t retval;
@@ -506,7 +632,7 @@ static void c64_256k_init_config(void)
     int i, j;
 
     if (c64_256k_enabled) {
-        mem_limit_256k_init(mem_read_limit_tab);
+        mem_limit_c64_256k_init(mem_read_limit_tab);
         for (i = 0; i < NUM_CONFIGS; i++) {
             for (j = 1; j <= 0xff; j++) {
                 if (check_256k_ram_write(i, j) == 1) {
@@ -726,6 +852,7 @@ void mem_initialize_memory(void)
     plus60k_init_config();
     plus256k_init_config();
     c64_256k_init_config();
+    mem_ram_banks_changed();
 
     if (board == 1) {
         mem_limit_max_init(mem_read_limit_tab);
@@ -745,6 +872,10 @@ void mem_mmu_translate(unsigned int addr, uint8_t **base, int *start, int *limit
     } else {
         cartridge_mmu_translate(addr, base, start, limit);
     }
+
+    if (heatmap_active) {
+        memheat_clip_limits(addr, base, start, limit);
+    }
 }
 
 /* ------------------------------------------------------------------------- */
@@ -978,10 +1109,62 @@ static const char *banknames[] = {
     "rom",
     "io",
     "cart",
+    "reu00", "reu01", "reu02", "reu03", "reu04", "reu05", "reu06", "reu07",
+    "reu08", "reu09", "reu0a", "reu0b", "reu0c", "reu0d", "reu0e", "reu0f",
+    "reu10", "reu11", "reu12", "reu13", "reu14", "reu15", "reu16", "reu17",
+    "reu18", "reu19", "reu1a", "reu1b", "reu1c", "reu1d", "reu1e", "reu1f",
+    "reu20", "reu21", "reu22", "reu23", "reu24", "reu25", "reu26", "reu27",
+    "reu28", "reu29", "reu2a", "reu2b", "reu2c", "reu2d", "reu2e", "reu2f",
+    "reu30", "reu31", "reu32", "reu33", "reu34", "reu35", "reu36", "reu37",
+    "reu38", "reu39", "reu3a", "reu3b", "reu3c", "reu3d", "reu3e", "reu3f",
+    "reu40", "reu41", "reu42", "reu43", "reu44", "reu45", "reu46", "reu47",
+    "reu48", "reu49", "reu4a", "reu4b", "reu4c", "reu4d", "reu4e", "reu4f",
+    "reu50", "reu51", "reu52", "reu53", "reu54", "reu55", "reu56", "reu57",
+    "reu58", "reu59", "reu5a", "reu5b", "reu5c", "reu5d", "reu5e", "reu5f",
+    "reu60", "reu61", "reu62", "reu63", "reu64", "reu65", "reu66", "reu67",
+    "reu68", "reu69", "reu6a", "reu6b", "reu6c", "reu6d", "reu6e", "reu6f",
+    "reu70", "reu71", "reu72", "reu73", "reu74", "reu75", "reu76", "reu77",
+    "reu78", "reu79", "reu7a", "reu7b", "reu7c", "reu7d", "reu7e", "reu7f",
+    "reu80", "reu81", "reu82", "reu83", "reu84", "reu85", "reu86", "reu87",
+    "reu88", "reu89", "reu8a", "reu8b", "reu8c", "reu8d", "reu8e", "reu8f",
+    "reu90", "reu91", "reu92", "reu93", "reu94", "reu95", "reu96", "reu97",
+    "reu98", "reu99", "reu9a", "reu9b", "reu9c", "reu9d", "reu9e", "reu9f",
+    "reua0", "reua1", "reua2", "reua3", "reua4", "reua5", "reua6", "reua7",
+    "reua8", "reua9", "reuaa", "reuab", "reuac", "reuad", "reuae", "reuaf",
+    "reub0", "reub1", "reub2", "reub3", "reub4", "reub5", "reub6", "reub7",
+    "reub8", "reub9", "reuba", "reubb", "reubc", "reubd", "reube", "reubf",
+    "reuc0", "reuc1", "reuc2", "reuc3", "reuc4", "reuc5", "reuc6", "reuc7",
+    "reuc8", "reuc9", "reuca", "reucb", "reucc", "reucd", "reuce", "reucf",
+    "reud0", "reud1", "reud2", "reud3", "reud4", "reud5", "reud6", "reud7",
+    "reud8", "reud9", "reuda", "reudb", "reudc", "reudd", "reude", "reudf",
+    "reue0", "reue1", "reue2", "reue3", "reue4", "reue5", "reue6", "reue7",
+    "reue8", "reue9", "reuea", "reueb", "reuec", "reued", "reuee", "reuef",
+    "reuf0", "reuf1", "reuf2", "reuf3", "reuf4", "reuf5", "reuf6", "reuf7",
+    "reuf8", "reuf9", "reufa", "reufb", "reufc", "reufd", "reufe", "reuff",
     NULL
 };
 
-static const int banknums[] = { 1, 0, 1, 2, 3, 4 };
+/* reu00..reuff are the 64K banks of the REU RAM.  */
+static const int banknums[] =
+{
+    1, 0, 1, 2, 3, 4,
+    5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+    21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
+    37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52,
+    53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68,
+    69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84,
+    85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100,
+    101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116,
+    117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131, 132,
+    133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148,
+    149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159, 160, 161, 162, 163, 164,
+    165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175, 176, 177, 178, 179, 180,
+    181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191, 192, 193, 194, 195, 196,
+    197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212,
+    213, 214, 215, 216, 217, 218, 219, 220, 221, 222, 223, 224, 225, 226, 227, 228,
+    229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239, 240, 241, 242, 243, 244,
+    245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255, 256, 257, 258, 259, 260
+};
 
 const char **mem_bank_list(void)
 {
@@ -1003,6 +1186,10 @@ int mem_bank_from_name(const char *name)
 
 uint8_t mem_bank_read(int bank, uint16_t addr, void *context)
 {
+    if ((bank >= 5) && (bank <= 260)) {
+        return reu_ram_peek(((unsigned int)(bank - 5) << 16) + addr); /* reu00..ff */
+    }
+
     switch (bank) {
         case 0:                   /* current */
             return mem_read(addr);
@@ -1057,6 +1244,11 @@ uint8_t mem_bank_peek(int bank, uint16_t addr, void *context)
 
 void mem_bank_write(int bank, uint16_t addr, uint8_t byte, void *context)
 {
+    if ((bank >= 5) && (bank <= 260)) {
+        reu_ram_store(((unsigned int)(bank - 5) << 16) + addr, byte); /* reu00..ff */
+        return;
+    }
+
     switch (bank) {
         case 0:                   /* current */
             mem_store(addr, byte);
@@ -1084,6 +1276,42 @@ void mem_bank_write(int bank, uint16_t addr, uint8_t byte, void *context)
     mem_ram[addr] = byte;
 }
 
+/* Return a pointer to `addr' in `bank' if the rest of its page can be read
+   directly without side effects, or NULL to use mem_bank_peek().  */
+uint8_t *mem_bank_base(int bank, uint16_t addr, void *context)
+{
+    uint8_t *p;
+
+    if ((bank >= 5) && (bank <= 260)) {
+        return reu_ram_base(((unsigned int)(bank - 5) << 16) + addr); /* reu00..ff */
+    }
+
+    switch (bank) {
+        case 0:                   /* current */
+            /* the same pages the CPU fetches opcodes from, but not the
+               processor port */
+            p = _mem_read_base_tab_ptr[addr >> 8];
+            if (p != NULL && addr > 1) {
+                return p + addr;
+            }
+            break;
+        case 2:                   /* rom */
+            if (addr >= 0xa000 && addr <= 0xbfff) {
+                return c64memrom_basic64_rom + (addr & 0x1fff);
+            }
+            if (addr >= 0xd000 && addr <= 0xdfff) {
+                return mem_chargen_rom + (addr & 0x0fff);
+            }
+            if (addr >= 0xe000) {
+                return c64memrom_kernal64_rom + (addr & 0x1fff);
+            }
+            /* FALL THROUGH */
+        case 1:                   /* ram */
+            return mem_ram + addr;
+    }
+    return NULL;
+}
+
 static int mem_dump_io(void *context, uint16_t addr)
 {
     if ((addr >= 0xdc00) && (addr <= 0xdc3f)) {
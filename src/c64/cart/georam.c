@@ -40,6 +40,7 @@
 #include "machine.h"
 #include "mem.h"
 #include "monitor.h"
+#include "ramimage.h"
 #include "resources.h"
 #include "georam.h"
 #include "snapshot.h"
@@ -106,9 +107,8 @@
 /* GEORAM registers */
 static uint8_t georam[2];
 
-/* GEORAM image.  */
-static uint8_t *georam_ram = NULL;
-static int old_georam_ram_size = 0;
+/* GEORAM RAM, loaded from and written back to the GEORAM image.  */
+static ramimage_t georam_image;
 
 static log_t georam_log = LOG_ERR;
 
@@ -189,14 +189,14 @@ static uint8_t georam_io1_read(uint16_t addr)
 {
     uint8_t retval;
 
-    retval = georam_ram[(georam[1] * 16384) + (georam[0] * 256) + addr];
+    retval = ramimage_read(&georam_image, (georam[1] * 16384) + (georam[0] * 256) + addr);
 
     return retval;
 }
 
 static void georam_io1_store(uint16_t addr, uint8_t byte)
 {
-    georam_ram[(georam[1] * 16384) + (georam[0] * 256) + addr] = byte;
+    ramimage_store(&georam_image, (georam[1] * 16384) + (georam[0] * 256) + addr, byte);
 }
 
 static uint8_t georam_io2_peek(uint16_t addr)
@@ -237,28 +237,17 @@ static int georam_activate(void)
         return 0;
     }
 
-    georam_ram = lib_realloc((void *)georam_ram, (size_t)georam_size);
-
-    /* Clear newly allocated RAM.  */
-    if (georam_size > old_georam_ram_size) {
-        memset(georam_ram, 0, (size_t)(georam_size - old_georam_ram_size));
-    }
-
-    old_georam_ram_size = georam_size;
-
     log_message(georam_log, "%dKB unit installed.", georam_size >> 10);
 
+    /* The image is created if it does not exist, its pages are read when
+       they are first accessed.  */
+    if (ramimage_open(&georam_image, (unsigned int)georam_size, georam_filename) < 0) {
+        log_message(georam_log, "Opening GEORAM image %s failed.", georam_filename);
+        ramimage_close(&georam_image);
+        return -1;
+    }
     if (!util_check_null_string(georam_filename)) {
-        if (util_file_load(georam_filename, georam_ram, (size_t)georam_size, UTIL_FILE_LOAD_RAW) < 0) {
-            log_message(georam_log, "Reading GEORAM image %s failed.", georam_filename);
-            if (util_file_save(georam_filename, georam_ram, georam_size) < 0) {
-                log_message(georam_log, "Creating GEORAM image %s failed.", georam_filename);
-                return -1;
-            }
-            log_message(georam_log, "Creating GEORAM image %s.", georam_filename);
-            return 0;
-        }
-        log_message(georam_log, "Reading GEORAM image %s.", georam_filename);
+        log_message(georam_log, "Using GEORAM image %s.", georam_filename);
     }
 
     georam_reset();
@@ -267,7 +256,7 @@ static int georam_activate(void)
 
 static int georam_deactivate(void)
 {
-    if (georam_ram == NULL) {
+    if (georam_image.ram == NULL) {
         return 0;
     }
 
@@ -280,9 +269,7 @@ static int georam_deactivate(void)
         }
     }
 
-    lib_free(georam_ram);
-    georam_ram = NULL;
-    old_georam_ram_size = 0;
+    ramimage_close(&georam_image);
 
     return 0;
 }
@@ -541,8 +528,10 @@ int georam_disable(void)
 
 void georam_config_setup(uint8_t *rawcart)
 {
-    if (georam_size > 0) {
-        memcpy(georam_ram, rawcart, georam_size);
+    /* The RAM of an attached image is read from it directly.  */
+    if (georam_size > 0 && georam_image.fd == NULL) {
+        memcpy(georam_image.ram, rawcart, georam_size);
+        ramimage_set_all_dirty(&georam_image);
     }
 }
 
@@ -566,16 +555,14 @@ int georam_bin_attach(const char *filename, uint8_t *rawcart)
         return -1;
     }
 
-    if (util_file_load(filename, rawcart, size, UTIL_FILE_LOAD_SKIP_ADDRESS) < 0) {
-        return -1;
-    }
-
+    /* The image itself backs the GEORAM RAM, so there is no need to load it.
+       ramimage_open() skips a load address in front of it.  */
     return georam_enable();
 }
 
 int georam_bin_save(const char *filename)
 {
-    if (georam_ram == NULL) {
+    if (georam_image.ram == NULL) {
         return -1;
     }
 
@@ -583,7 +570,7 @@ int georam_bin_save(const char *filename)
         return -1;
     }
 
-    if (util_file_save(filename, georam_ram, georam_size) < 0) {
+    if (ramimage_save(&georam_image, filename) < 0) {
         return -1;
     }
 
@@ -621,11 +608,13 @@ int georam_write_snapshot_module(snapshot_t *s)
         return -1;
     }
 
+    ramimage_load_all(&georam_image);
+
     if (0
         || SMW_B(m, (uint8_t)georam_io_swap) < 0
         || SMW_DW(m, (georam_size >> 10)) < 0
         || SMW_BA(m, georam, sizeof(georam)) < 0
-        || SMW_BA(m, georam_ram, georam_size) < 0) {
+        || SMW_BA(m, georam_image.ram, georam_size) < 0) {
         snapshot_module_close(m);
         return -1;
     }
@@ -676,9 +665,10 @@ int georam_read_snapshot_module(snapshot_t *s)
         set_georam_enabled(1, NULL);
     }
 
-    if (SMR_BA(m, georam, sizeof(georam)) < 0 || SMR_BA(m, georam_ram, georam_size) < 0) {
+    if (SMR_BA(m, georam, sizeof(georam)) < 0 || SMR_BA(m, georam_image.ram, georam_size) < 0) {
         goto fail;
     }
+    ramimage_set_all_dirty(&georam_image);
 
     snapshot_module_close(m);
     georam_enabled = 1;
@@ -0,0 +1,366 @@
+/*
+ * ramimage.c - RAM expansion contents backed by an image file.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "ioutil.h"
+#include "lib.h"
+#include "log.h"
+#include "ramimage.h"
+#include "types.h"
+#include "util.h"
+
+/*
+ * Journal format:
+ *
+ * type  | name   | description
+ * ----------------------------
+ * ARRAY | magic  | 8 BYTES "VICERAMJ"
+ * DWORD | size   | size of the RAM in bytes
+ * DWORD | offset | position of the RAM in the image
+ *
+ * followed by one entry for every page to write:
+ *
+ * DWORD | page   | page number
+ * ARRAY | data   | contents of the page, up to RAMIMAGE_PAGE_SIZE BYTES
+ *
+ * and a DWORD 0xffffffff when all pages are in the journal.  A journal
+ * without the end marker was interrupted before the image was touched and
+ * is thrown away.  The journal is synced to the disk before the image is
+ * written, and the image before the journal is removed.
+ */
+
+#define RAMIMAGE_JOURNAL_EXT   ".journal"
+#define RAMIMAGE_JOURNAL_MAGIC "VICERAMJ"
+#define RAMIMAGE_JOURNAL_END   0xffffffff
+
+static unsigned int page_length(unsigned int size, unsigned int page)
+{
+    unsigned int offset = page << RAMIMAGE_PAGE_SHIFT;
+
+    return (size - offset < RAMIMAGE_PAGE_SIZE) ? size - offset : RAMIMAGE_PAGE_SIZE;
+}
+
+/* Go through the journal, writing the pages to `image' if it is not NULL.
+   Returns 1 if the journal is complete.  */
+static int journal_scan(FILE *journal, FILE *image, uint8_t *buf)
+{
+    uint8_t header[8];
+    unsigned int size, offset, page, pages;
+
+    if (fseek(journal, 0, SEEK_SET) < 0
+        || fread(header, 8, 1, journal) < 1
+        || memcmp(header, RAMIMAGE_JOURNAL_MAGIC, 8) != 0
+        || fread(header, 8, 1, journal) < 1) {
+        return 0;
+    }
+    size = util_le_buf_to_dword(header);
+    offset = util_le_buf_to_dword(header + 4);
+    pages = (size + RAMIMAGE_PAGE_SIZE - 1) >> RAMIMAGE_PAGE_SHIFT;
+
+    while (fread(header, 4, 1, journal) == 1) {
+        page = util_le_buf_to_dword(header);
+        if (page == RAMIMAGE_JOURNAL_END) {
+            return 1;
+        }
+        if (page >= pages
+            || fread(buf, page_length(size, page), 1, journal) < 1) {
+            return 0;
+        }
+        if (image != NULL
+            && util_fpwrite(image, buf, page_length(size, page), (long)(page << RAMIMAGE_PAGE_SHIFT) + offset) < 0) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/* Finish a flush of `filename' that was interrupted.  */
+static int journal_replay(const char *filename)
+{
+    char *journal_name;
+    FILE *journal, *image;
+    uint8_t *buf;
+    int result = 0;
+
+    journal_name = util_concat(filename, RAMIMAGE_JOURNAL_EXT, NULL);
+    journal = fopen(journal_name, MODE_READ);
+    if (journal == NULL) {
+        lib_free(journal_name);
+        return 0;
+    }
+
+    buf = lib_malloc(RAMIMAGE_PAGE_SIZE);
+    if (journal_scan(journal, NULL, buf)) {
+        image = fopen(filename, MODE_READ_WRITE);
+        if (image == NULL || !journal_scan(journal, image, buf)
+            || archdep_file_sync(image) < 0) {
+            result = -1;
+        }
+        if (image != NULL && fclose(image) != 0) {
+            result = -1;
+        }
+        if (result == 0) {
+            log_message(LOG_DEFAULT, "Finished interrupted write of image %s.", filename);
+        }
+    }
+    fclose(journal);
+    lib_free(buf);
+
+    if (result == 0) {
+        ioutil_remove(journal_name);
+    }
+    lib_free(journal_name);
+
+    return result;
+}
+
+static int journal_write(ramimage_t *image, const char *journal_name)
+{
+    FILE *journal;
+    uint8_t buf[8];
+    unsigned int page;
+    int result = 0;
+
+    journal = fopen(journal_name, MODE_WRITE);
+    if (journal == NULL) {
+        return -1;
+    }
+
+    util_dword_to_le_buf(buf, image->size);
+    util_dword_to_le_buf(buf + 4, image->offset);
+    if (fwrite(RAMIMAGE_JOURNAL_MAGIC, 8, 1, journal) < 1
+        || fwrite(buf, 8, 1, journal) < 1) {
+        result = -1;
+    }
+
+    for (page = 0; page < image->pages && result == 0; page++) {
+        if (image->page_state[page] & RAMIMAGE_PAGE_DIRTY) {
+            util_dword_to_le_buf(buf, page);
+            if (fwrite(buf, 4, 1, journal) < 1
+                || fwrite(image->ram + (page << RAMIMAGE_PAGE_SHIFT), page_length(image->size, page), 1, journal) < 1) {
+                result = -1;
+            }
+        }
+    }
+
+    util_dword_to_le_buf(buf, RAMIMAGE_JOURNAL_END);
+    if (result == 0 && (fwrite(buf, 4, 1, journal) < 1 || archdep_file_sync(journal) < 0)) {
+        result = -1;
+    }
+
+    if (fclose(journal) != 0) {
+        result = -1;
+    }
+
+    return result;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int ramimage_open(ramimage_t *image, unsigned int size, const char *filename)
+{
+    unsigned int page;
+    size_t length;
+
+    image->size = size;
+    image->pages = (size + RAMIMAGE_PAGE_SIZE - 1) >> RAMIMAGE_PAGE_SHIFT;
+    image->ram = lib_calloc(1, size);
+    image->page_state = lib_malloc(image->pages);
+    image->fd = NULL;
+    image->filename = NULL;
+    image->offset = 0;
+    image->read_only = 0;
+
+    /* Without an image all of the RAM is there and nothing is written back.  */
+    memset(image->page_state, RAMIMAGE_PAGE_LOADED | RAMIMAGE_PAGE_DIRTY, image->pages);
+
+    if (util_check_null_string(filename)) {
+        return 0;
+    }
+
+    if (journal_replay(filename) < 0) {
+        return -1;
+    }
+
+    image->fd = fopen(filename, MODE_READ_WRITE);
+    if (image->fd == NULL && !util_file_exists(filename)) {
+        /* Create the image with its full size.  */
+        image->fd = fopen(filename, MODE_APPEND);
+        if (image->fd != NULL
+            && (util_fpwrite(image->fd, "", 1, (long)size - 1) < 0 || fflush(image->fd) != 0)) {
+            fclose(image->fd);
+            image->fd = NULL;
+        }
+    }
+    if (image->fd == NULL) {
+        /* Still allow reading from a write protected image.  */
+        image->fd = fopen(filename, MODE_READ);
+        image->read_only = 1;
+    }
+    if (image->fd == NULL) {
+        return -1;
+    }
+
+    image->filename = lib_stralloc(filename);
+
+    /* Two more bytes than the RAM are a load address in front of it, as
+       util_file_load() skips it.  It is kept in the image.  */
+    length = util_file_length(image->fd);
+    if (length == (size_t)size + 2) {
+        image->offset = 2;
+        length = size;
+    }
+
+    /* Pages past the end of the image stay cleared.  */
+    for (page = 0; page < image->pages; page++) {
+        if (((size_t)page << RAMIMAGE_PAGE_SHIFT) < length) {
+            image->page_state[page] = 0;
+        } else {
+            image->page_state[page] = RAMIMAGE_PAGE_LOADED;
+        }
+    }
+
+    return 0;
+}
+
+void ramimage_close(ramimage_t *image)
+{
+    if (image->fd != NULL) {
+        fclose(image->fd);
+        image->fd = NULL;
+    }
+    lib_free(image->ram);
+    image->ram = NULL;
+    lib_free(image->page_state);
+    image->page_state = NULL;
+    lib_free(image->filename);
+    image->filename = NULL;
+    image->offset = 0;
+    image->read_only = 0;
+    image->size = 0;
+    image->pages = 0;
+}
+
+void ramimage_load_page(ramimage_t *image, unsigned int page)
+{
+    unsigned int offset = page << RAMIMAGE_PAGE_SHIFT;
+
+    /* A short read leaves the rest of the page cleared.  */
+    if (fseek(image->fd, (long)(offset + image->offset), SEEK_SET) == 0) {
+        if (fread(image->ram + offset, 1, page_length(image->size, page), image->fd) < page_length(image->size, page)) {
+            clearerr(image->fd);
+        }
+    }
+    image->page_state[page] |= RAMIMAGE_PAGE_LOADED;
+}
+
+void ramimage_dirty_page(ramimage_t *image, unsigned int page)
+{
+    if (!(image->page_state[page] & RAMIMAGE_PAGE_LOADED)) {
+        ramimage_load_page(image, page);
+    }
+    image->page_state[page] |= RAMIMAGE_PAGE_DIRTY;
+}
+
+void ramimage_load_all(ramimage_t *image)
+{
+    unsigned int page;
+
+    for (page = 0; page < image->pages; page++) {
+        if (!(image->page_state[page] & RAMIMAGE_PAGE_LOADED)) {
+            ramimage_load_page(image, page);
+        }
+    }
+}
+
+void ramimage_set_all_dirty(ramimage_t *image)
+{
+    memset(image->page_state, RAMIMAGE_PAGE_LOADED | RAMIMAGE_PAGE_DIRTY, image->pages);
+}
+
+int ramimage_flush(ramimage_t *image)
+{
+    char *journal_name;
+    unsigned int page;
+    int result = 0;
+
+    /* Nothing can be written, so no journal is left behind either.  */
+    if (image->fd == NULL || image->read_only) {
+        return -1;
+    }
+
+    for (page = 0; page < image->pages; page++) {
+        if (image->page_state[page] & RAMIMAGE_PAGE_DIRTY) {
+            break;
+        }
+    }
+    if (page == image->pages) {
+        return 0;
+    }
+
+    journal_name = util_concat(image->filename, RAMIMAGE_JOURNAL_EXT, NULL);
+
+    if (journal_write(image, journal_name) < 0) {
+        ioutil_remove(journal_name);
+        lib_free(journal_name);
+        return -1;
+    }
+
+    for (page = 0; page < image->pages && result == 0; page++) {
+        if (image->page_state[page] & RAMIMAGE_PAGE_DIRTY) {
+            if (util_fpwrite(image->fd, image->ram + (page << RAMIMAGE_PAGE_SHIFT), page_length(image->size, page), (long)((page << RAMIMAGE_PAGE_SHIFT) + image->offset)) < 0) {
+                result = -1;
+            }
+        }
+    }
+    if (archdep_file_sync(image->fd) < 0) {
+        result = -1;
+    }
+
+    /* On failure the journal stays to repair the image on the next open.  */
+    if (result == 0) {
+        ioutil_remove(journal_name);
+        for (page = 0; page < image->pages; page++) {
+            image->page_state[page] &= ~RAMIMAGE_PAGE_DIRTY;
+        }
+    }
+    lib_free(journal_name);
+
+    return result;
+}
+
+int ramimage_save(ramimage_t *image, const char *filename)
+{
+    if (image->fd != NULL && strcmp(filename, image->filename) == 0) {
+        return ramimage_flush(image);
+    }
+
+    ramimage_load_all(image);
+
+    return util_file_save(filename, image->ram, (int)image->size);
+}
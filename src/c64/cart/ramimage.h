@@ -0,0 +1,97 @@
+/*
+ * ramimage.h - RAM expansion contents backed by an image file.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_RAMIMAGE_H
+#define VICE_RAMIMAGE_H
+
+#include <stdio.h>
+
+#include "types.h"
+
+/*
+ * The RAM of a file backed expansion is read from the image one page at a
+ * time on the first access, and only the pages written to since are written
+ * back.  The pages are first written to a journal next to the image, so an
+ * image interrupted while flushing is repaired on the next open.
+ *
+ * Limits: the whole RAM is still allocated when the image is opened, the
+ * paging saves file I/O but no memory.  The dirty pages are only written
+ * by ramimage_flush(), which runs in the caller's thread; nothing flushes
+ * in the background.
+ */
+
+#define RAMIMAGE_PAGE_SHIFT 12
+#define RAMIMAGE_PAGE_SIZE  (1 << RAMIMAGE_PAGE_SHIFT)
+
+#define RAMIMAGE_PAGE_LOADED 0x01
+#define RAMIMAGE_PAGE_DIRTY  0x02
+
+typedef struct ramimage_s {
+    uint8_t *ram;           /* contents, valid for loaded pages only */
+    unsigned int size;      /* size of the RAM in bytes */
+    unsigned int pages;     /* number of pages */
+    uint8_t *page_state;    /* RAMIMAGE_PAGE_* flags for every page */
+    FILE *fd;               /* the backing image, NULL if none */
+    char *filename;         /* name of the backing image */
+    unsigned int offset;    /* position of the RAM in the image, 2 after a load address */
+    int read_only;          /* the image could only be opened for reading */
+} ramimage_t;
+
+/* Allocate `size' bytes of cleared RAM, backed by `filename' if not NULL.
+   A missing image is created, an image of `size' + 2 bytes starts with a
+   load address.  */
+extern int ramimage_open(ramimage_t *image, unsigned int size, const char *filename);
+extern void ramimage_close(ramimage_t *image);
+
+/* Write the dirty pages back to the backing image, fails if it is read only.  */
+extern int ramimage_flush(ramimage_t *image);
+
+/* Save the whole RAM to `filename', which may be the backing image.  */
+extern int ramimage_save(ramimage_t *image, const char *filename);
+
+/* Load all pages, for code that accesses `ram' directly.  */
+extern void ramimage_load_all(ramimage_t *image);
+
+/* The whole RAM has been overwritten through `ram'.  */
+extern void ramimage_set_all_dirty(ramimage_t *image);
+
+extern void ramimage_load_page(ramimage_t *image, unsigned int page);
+extern void ramimage_dirty_page(ramimage_t *image, unsigned int page);
+
+static inline uint8_t ramimage_read(ramimage_t *image, unsigned int addr)
+{
+    if (!(image->page_state[addr >> RAMIMAGE_PAGE_SHIFT] & RAMIMAGE_PAGE_LOADED)) {
+        ramimage_load_page(image, addr >> RAMIMAGE_PAGE_SHIFT);
+    }
+    return image->ram[addr];
+}
+
+static inline void ramimage_store(ramimage_t *image, unsigned int addr, uint8_t value)
+{
+    if (image->page_state[addr >> RAMIMAGE_PAGE_SHIFT] != (RAMIMAGE_PAGE_LOADED | RAMIMAGE_PAGE_DIRTY)) {
+        ramimage_dirty_page(image, addr >> RAMIMAGE_PAGE_SHIFT);
+    }
+    image->ram[addr] = value;
+}
+
+#endif
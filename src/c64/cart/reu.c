@@ -54,6 +54,7 @@
 #include "machine.h"
 #include "maincpu.h"
 #include "mem.h"
+#include "ramimage.h"
 #include "resources.h"
 #include "snapshot.h"
 #include "types.h"
@@ -224,11 +225,8 @@ static struct rec_options_s rec_options;
 /*! \brief flag for DMA active */
 static int reu_dma_active = 0;
 
-/*! \brief pointer to a buffer which holds the REU image.  */
-static uint8_t *reu_ram = NULL;
-/*! \brief the old ram size of reu_ram. Used to determine if and how much of the
-    buffer has to cleared when resizing the REU. */
-static unsigned int old_reu_ram_size = 0;
+/*! \brief the REU RAM, loaded from and written back to the REU image. */
+static ramimage_t reu_image;
 
 static log_t reu_log = LOG_ERR; /*!< the log output for the REU */
 
@@ -572,8 +570,10 @@ void reu_init(void)
 
 void reu_config_setup(uint8_t *rawcart)
 {
-    if (reu_size > 0) {
-        memcpy(reu_ram, rawcart, reu_size); /* FIXME */
+    /* the RAM of an attached image is read from it directly */
+    if (reu_size > 0 && reu_image.fd == NULL) {
+        memcpy(reu_image.ram, rawcart, reu_size); /* FIXME */
+        ramimage_set_all_dirty(&reu_image);
     }
 }
 
@@ -613,31 +613,17 @@ static int reu_activate(void)
         return 0;
     }
 
-    reu_ram = lib_realloc(reu_ram, reu_size);
-
-    /* Clear newly allocated RAM.  */
-    if (reu_size > old_reu_ram_size) {
-        memset(reu_ram, 0, (size_t)(reu_size - old_reu_ram_size));
-    }
-
-    old_reu_ram_size = reu_size;
-
     log_message(reu_log, "%dKB unit installed.", reu_size >> 10);
 
+    /* the image is created if it does not exist, its pages are read when
+       they are first accessed */
+    if (ramimage_open(&reu_image, reu_size, reu_filename) < 0) {
+        log_error(reu_log, "Opening REU image %s failed.", reu_filename);
+        ramimage_close(&reu_image);
+        return -1;
+    }
     if (!util_check_null_string(reu_filename)) {
-        if (util_file_load(reu_filename, reu_ram, (size_t)reu_size, UTIL_FILE_LOAD_RAW) < 0) {
-            log_error(reu_log, "Reading REU image %s failed.", reu_filename);
-            /* only create a new file if no file exists, so we dont accidently overwrite any files */
-            if (!util_file_exists(reu_filename)) {
-                if (util_file_save(reu_filename, reu_ram, reu_size) < 0) {
-                    log_error(reu_log, "Creating REU image %s failed.", reu_filename);
-                    return -1;
-                }
-                log_message(reu_log, "Creating REU image %s.", reu_filename);
-            }
-            return 0;
-        }
-        log_message(reu_log, "Reading REU image %s.", reu_filename);
+        log_message(reu_log, "Using REU image %s.", reu_filename);
     }
 
     reu_reset();
@@ -646,7 +632,7 @@ static int reu_activate(void)
 
 static int reu_deactivate(void)
 {
-    if (reu_ram == NULL) {
+    if (reu_image.ram == NULL) {
         return 0;
     }
 
@@ -659,9 +645,7 @@ static int reu_deactivate(void)
         }
     }
 
-    lib_free(reu_ram);
-    reu_ram = NULL;
-    old_reu_ram_size = 0;
+    ramimage_close(&reu_image);
 
     return 0;
 }
@@ -707,16 +691,14 @@ int reu_bin_attach(const char *filename, uint8_t *rawcart)
         return -1;
     }
 
-    if (util_file_load(filename, rawcart, size, UTIL_FILE_LOAD_SKIP_ADDRESS) < 0) {
-        return -1;
-    }
-
+    /* the image itself backs the REU RAM, so there is no need to load it;
+       ramimage_open() skips a load address in front of it */
     return reu_enable();
 }
 
 int reu_bin_save(const char *filename)
 {
-    if (reu_ram == NULL) {
+    if (reu_image.ram == NULL) {
         return -1;
     }
 
@@ -724,7 +706,7 @@ int reu_bin_save(const char *filename)
         return -1;
     }
 
-    if (util_file_save(filename, reu_ram, reu_size) < 0) {
+    if (ramimage_save(&reu_image, filename) < 0) {
         return -1;
     }
 
@@ -739,6 +721,36 @@ int reu_flush_image(void)
     return 0;
 }
 
+/* ------------------------------------------------------------------------- */
+/* monitor access, `addr' is an offset into the REU RAM */
+
+uint8_t reu_ram_peek(unsigned int addr)
+{
+    if (reu_image.ram == NULL || addr >= reu_image.size) {
+        return 0xff;
+    }
+    return ramimage_read(&reu_image, addr);
+}
+
+void reu_ram_store(unsigned int addr, uint8_t value)
+{
+    if (reu_image.ram == NULL || addr >= reu_image.size) {
+        return;
+    }
+    ramimage_store(&reu_image, addr, value);
+}
+
+/* Return a pointer to `addr', valid up to the end of its 256 byte page, or
+   NULL if there is no RAM there.  */
+uint8_t *reu_ram_base(unsigned int addr)
+{
+    if (reu_image.ram == NULL || addr >= reu_image.size) {
+        return NULL;
+    }
+    ramimage_read(&reu_image, addr);
+    return reu_image.ram + addr;
+}
+
 /* ------------------------------------------------------------------------- */
 /* helper functions */
 
@@ -1037,7 +1049,7 @@ inline static void store_to_reu(unsigned int reu_addr, uint8_t value)
     reu_addr &= rec_options.dram_wrap_around - 1;
     if (reu_addr < rec_options.not_backedup_addresses) {
         assert(reu_addr < reu_size);
-        reu_ram[reu_addr] = value;
+        ramimage_store(&reu_image, reu_addr, value);
     } else {
         DEBUG_LOG(DEBUG_LEVEL_NO_DRAM, (reu_log, "--> writing to REU address %05X, but no DRAM!", reu_addr));
     }
@@ -1067,7 +1079,7 @@ inline static uint8_t read_from_reu(unsigned int reu_addr)
     reu_addr &= rec_options.dram_wrap_around - 1;
     if (reu_addr < rec_options.not_backedup_addresses) {
         assert(reu_addr < reu_size);
-        value = reu_ram[reu_addr];
+        value = ramimage_read(&reu_image, reu_addr);
     } else {
         DEBUG_LOG(DEBUG_LEVEL_NO_DRAM, (reu_log, "--> read from REU address %05X, but no DRAM!", reu_addr));
     }
@@ -1218,7 +1230,7 @@ static void reu_dma_reu_to_host(uint16_t host_addr, unsigned int reu_addr, int h
     assert(len >= 1);
 
     while (len) {
-        DEBUG_LOG(DEBUG_LEVEL_TRANSFER_LOW_LEVEL, (reu_log, "Transferring byte: %x from ext $%05X to main $%04X.", reu_ram[reu_addr % reu_size], reu_addr, host_addr));
+        DEBUG_LOG(DEBUG_LEVEL_TRANSFER_LOW_LEVEL, (reu_log, "Transferring byte: %x from ext $%05X to main $%04X.", reu_image.ram[reu_addr % reu_size], reu_addr, host_addr));
         reu_clk_inc_pre();
         value = read_from_reu(reu_addr);
         mem_store(host_addr, value);
@@ -1518,10 +1530,12 @@ int reu_write_snapshot_module(snapshot_t *s)
         return -1;
     }
 
+    ramimage_load_all(&reu_image);
+
     if (0
         || SMW_DW(m, (reu_size >> 10)) < 0
         || SMW_BA(m, reu, sizeof(reu)) < 0
-        || SMW_BA(m, reu_ram, reu_size) < 0) {
+        || SMW_BA(m, reu_image.ram, reu_size) < 0) {
         snapshot_module_close(m);
         return -1;
     }
@@ -1574,9 +1588,10 @@ int reu_read_snapshot_module(snapshot_t *s)
         set_reu_enabled(1, NULL);
     }
 
-    if (SMR_BA(m, reu, sizeof(reu)) < 0 || SMR_BA(m, reu_ram, reu_size) < 0) {
+    if (SMR_BA(m, reu, sizeof(reu)) < 0 || SMR_BA(m, reu_image.ram, reu_size) < 0) {
         goto fail;
     }
+    ramimage_set_all_dirty(&reu_image);
 
     if (reu[REU_REG_R_STATUS] & 0x80) {
         interrupt_restore_irq(maincpu_int_status, reu_int_num, 1);
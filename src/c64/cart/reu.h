@@ -64,4 +64,8 @@ extern int reu_bin_attach(const char *filename, uint8_t *rawcart);
 extern int reu_bin_save(const char *filename);
 extern int reu_flush_image(void);
 
+extern uint8_t reu_ram_peek(unsigned int addr);
+extern void reu_ram_store(unsigned int addr, uint8_t value);
+extern uint8_t *reu_ram_base(unsigned int addr);
+
 #endif
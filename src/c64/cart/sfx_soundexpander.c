@@ -35,7 +35,6 @@
 #include "cmdline.h"
 #include "export.h"
 #include "fmopl.h"
-#include "lib.h"
 #include "machine.h"
 #include "maincpu.h"
 #include "resources.h"
@@ -360,23 +359,23 @@ static struct sfx_soundexpander_sound_s snd;
 static int sfx_soundexpander_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, int soc, int scc, int *delta_t)
 {
     int i;
-    int16_t *buffer;
-
-    buffer = lib_malloc(nr * 2);
 
+    /* render straight into our own buffer, then spread the samples over
+       the output channels */
     if (sfx_soundexpander_chip == 3812 && YM3812_chip) {
-        ym3812_update_one(YM3812_chip, buffer, nr);
+        ym3812_update_one(YM3812_chip, pbuf, nr);
     } else if (sfx_soundexpander_chip == 3526 && YM3526_chip) {
-        ym3526_update_one(YM3526_chip, buffer, nr);
+        ym3526_update_one(YM3526_chip, pbuf, nr);
+    } else {
+        return 0;
     }
 
-    for (i = 0; i < nr; i++) {
-        pbuf[i * soc] = sound_audio_mix(pbuf[i * soc], buffer[i]);
-        if (soc > 1) {
-            pbuf[(i * soc) + 1] = sound_audio_mix(pbuf[(i * soc) + 1], buffer[i]);
+    if (soc > 1) {
+        for (i = nr - 1; i >= 0; i--) {
+            pbuf[i * soc] = pbuf[i];
+            pbuf[(i * soc) + 1] = pbuf[i];
         }
     }
-    lib_free(buffer);
 
     return nr;
 }
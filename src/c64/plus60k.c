@@ -114,6 +114,20 @@ static char *plus60k_filename = NULL;
 
 static uint8_t *plus60k_ram;
 
+/* Base pointer of the RAM seen by the CPU at $1000-$FFFF, indexed with the
+   CPU address.  */
+uint8_t *plus60k_cpu_base = mem_ram;
+
+static void plus60k_update_bank(void)
+{
+    if (plus60k_reg == 1 && plus60k_ram != NULL) {
+        plus60k_cpu_base = plus60k_ram - 0x1000;
+    } else {
+        plus60k_cpu_base = mem_ram;
+    }
+    mem_ram_banks_changed();
+}
+
 static int plus60k_dump(void)
 {
     mon_out("$1000-$FFFF bank: %d\n", plus60k_reg);
@@ -132,7 +146,12 @@ static uint8_t plus60k_peek(uint16_t addr)
 
 static void plus60k_vicii_store(uint16_t addr, uint8_t value)
 {
-    plus60k_reg = (value & 0x80) >> 7;
+    uint8_t reg = (value & 0x80) >> 7;
+
+    if (reg != plus60k_reg) {
+        plus60k_reg = reg;
+        plus60k_update_bank();
+    }
 }
 
 static io_source_t vicii_d000_device = {
@@ -333,6 +352,7 @@ void plus60k_init(void)
 void plus60k_reset(void)
 {
     plus60k_reg = 0;
+    plus60k_update_bank();
 }
 
 static int plus60k_activate(void)
@@ -378,6 +398,8 @@ static int plus60k_deactivate(void)
     }
     lib_free(plus60k_ram);
     plus60k_ram = NULL;
+    plus60k_reg = 0;
+    plus60k_update_bank();
 
     if (vicii_d000_list_item != NULL) {
         io_source_unregister(vicii_d000_list_item);
@@ -468,22 +490,15 @@ void plus60k_ram_hi_store(uint16_t addr, uint8_t value)
     plus60k_mem_write_tab[plus60k_reg + 6](addr, value);
 }
 
+/* Only hooked up at $1000-$FFFF, see plus60k_init_config().  */
 uint8_t plus60k_ram_read(uint16_t addr)
 {
-    if (plus60k_enabled && addr >= 0x1000 && plus60k_reg == 1) {
-        return plus60k_ram[addr - 0x1000];
-    } else {
-        return mem_ram[addr];
-    }
+    return plus60k_cpu_base[addr];
 }
 
 void plus60k_ram_store(uint16_t addr, uint8_t value)
 {
-    if (plus60k_enabled && addr >= 0x1000 && plus60k_reg == 1) {
-        plus60k_ram[addr - 0x1000] = value;
-    } else {
-        mem_ram[addr] = value;
-    }
+    plus60k_cpu_base[addr] = value;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -553,6 +568,7 @@ int plus60k_snapshot_read(struct snapshot_s *s)
         || SMR_BA(m, plus60k_ram, 0xf000) < 0) {
         goto fail;
     }
+    plus60k_update_bank();
 
     return snapshot_module_close(m);
 
@@ -31,6 +31,7 @@
 
 extern int plus60k_enabled;
 extern int plus60k_base;
+extern uint8_t *plus60k_cpu_base;
 extern int plus60k_resources_init(void);
 extern void plus60k_resources_shutdown(void);
 extern int plus60k_cmdline_options_init(void);
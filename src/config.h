@@ -218,6 +218,9 @@
 /* Can we use the GIF or UNGIF library? */
 #undef HAVE_GIF
 
+/* Define to 1 if you have the <glob.h> header file. */
+#undef HAVE_GLOB_H
+
 /* GTK3 OpenGL support uses GLEW */
 #undef HAVE_GTK3_GLEW
 
@@ -405,7 +408,7 @@
 #undef HAVE_MMAP_DEVICE_IO
 
 /* Enable 1351 mouse support */
-#undef HAVE_MOUSE
+#define HAVE_MOUSE 1
 
 /* Define to 1 if you have the <mpg123.h> header file. */
 #undef HAVE_MPG123_H
@@ -486,7 +489,7 @@
 #undef HAVE_RAWDRIVE
 
 /* Support for CS8900A ethernet controller. */
-#undef HAVE_RAWNET
+#define HAVE_RAWNET 1
 
 /* Enable the readline library */
 #undef HAVE_READLINE
@@ -702,14 +702,12 @@ static uint16_t cs8900_receive(void)
             }
 
             if (rx_ok) {
-                int i;
-
                 /* set relevant parts of the PP area to correct values */
                 SET_PP_16(CS8900_PP_ADDR_RXLENGTH, len);
 
-                for (i = 0; i < len; i++) {
-                    SET_PP_8(CS8900_PP_ADDR_RX_FRAMELOC + i, buffer[i]);
-                }
+                /* copy the frame in one go */
+                assert(CS8900_PP_ADDR_RX_FRAMELOC + len <= MAX_PACKETPAGE_ARRAY);
+                memcpy(&cs8900_packetpage[CS8900_PP_ADDR_RX_FRAMELOC], buffer, len);
 
                 /* set rx_buffer to where start reading *
                  * According to 4.10.9 (pp. 76-77), we start with RxStatus and RxLength!
@@ -310,6 +310,9 @@ int drive_snapshot_read_module(snapshot_t *s)
     drive_t *drive;
     int dummy;
     int half_track[DRIVE_NUM];
+    unsigned int old_type[DRIVE_NUM];
+    int old_parallel_cable[DRIVE_NUM];
+    int old_idling_method[DRIVE_NUM];
 
     m = snapshot_module_open(s, snap_module_name,
                              &major_version, &minor_version);
@@ -330,7 +333,19 @@ int drive_snapshot_read_module(snapshot_t *s)
 
     /* If this module exists true emulation is enabled.  */
     /* XXX drive_true_emulation = 1 */
-    resources_set_int("DriveTrueEmulation", 1);
+    resources_get_int("DriveTrueEmulation", &drive_true_emulation);
+    if (!drive_true_emulation) {
+        resources_set_int("DriveTrueEmulation", 1);
+    }
+
+    /* Remember the current setup, so that the memory maps and traps only
+       get rebuilt for drives the snapshot actually changes.  */
+    for (i = 0; i < 2; i++) {
+        drive = drive_context[i]->drive;
+        old_type[i] = (drive_true_emulation && drive->enable) ? drive->type : DRIVE_TYPE_NONE;
+        old_parallel_cable[i] = drive->parallel_cable;
+        old_idling_method[i] = drive->idling_method;
+    }
 
     if (SMR_DW_INT(m, &sync_factor) < 0) {
         snapshot_module_close(m);
@@ -573,8 +588,13 @@ int drive_snapshot_read_module(snapshot_t *s)
         case DRIVE_TYPE_8250:
             drive->enable = 1;
             machine_drive_rom_setup_image(0);
-            drivemem_init(drive_context[0], drive->type);
-            resources_set_int("Drive8IdleMethod", drive->idling_method);
+            if (drive->type != old_type[0]
+                || drive->parallel_cable != old_parallel_cable[0]) {
+                drivemem_init(drive_context[0], drive->type);
+            }
+            if (drive->idling_method != old_idling_method[0]) {
+                resources_set_int("Drive8IdleMethod", drive->idling_method);
+            }
             driverom_initialize_traps(drive);
             drive_set_active_led_color(drive->type, 0);
             machine_bus_status_drivetype_set(8, 1);
@@ -603,8 +623,13 @@ int drive_snapshot_read_module(snapshot_t *s)
             /* drive 1 does not allow dual disk drive */
             drive->enable = 1;
             machine_drive_rom_setup_image(1);
-            drivemem_init(drive_context[1], drive->type);
-            resources_set_int("Drive9IdleMethod", drive->idling_method);
+            if (drive->type != old_type[1]
+                || drive->parallel_cable != old_parallel_cable[1]) {
+                drivemem_init(drive_context[1], drive->type);
+            }
+            if (drive->idling_method != old_idling_method[1]) {
+                resources_set_int("Drive9IdleMethod", drive->idling_method);
+            }
             driverom_initialize_traps(drive);
             drive_set_active_led_color(drive->type, 1);
             machine_bus_status_drivetype_set(9, 1);
@@ -39,7 +39,11 @@
 
 const int fdd_data_rates[4] = { 500, 300, 250, 1000 }; /* kbit/s */
 #define INDEXLEN (16)
+/* tracks 0-82 on both sides */
+#define FDD_CACHE_TRACKS (83 * 2)
 static void fdd_flush_raw(fd_drive_t *drv);
+static void fdd_flush_cache(fd_drive_t *drv);
+static void fdd_free_cache(fd_drive_t *drv);
 static uint16_t *crc1021 = NULL;
 
 struct fd_drive_s {
@@ -71,11 +75,21 @@ struct fd_drive_s {
         uint8_t *data;
         uint8_t *sync;
     } raw;
+    /* Encoded tracks of the attached image, indexed by track * 2 + head.
+       raw.data and raw.sync point into the entry of the current track.
+       Modified tracks are written back when the motor stops, the image
+       is detached or fdd_flush() is called.  */
+    struct {
+        int valid;
+        int dirty;
+        uint8_t *data;
+        uint8_t *sync;
+    } cache[FDD_CACHE_TRACKS];
 };
 
 fd_drive_t *fdd_init(int num, drive_t *drive)
 {
-    fd_drive_t *drv = lib_malloc(sizeof(fd_drive_t));
+    fd_drive_t *drv = lib_calloc(1, sizeof(fd_drive_t));
     drv->myname = lib_msprintf("FDD%d", num);
     drv->image = NULL;
     drv->number = num & 3;
@@ -89,6 +103,9 @@ fd_drive_t *fdd_init(int num, drive_t *drive)
     drv->write_protect = 1;
     drv->rate = 2;
     drv->image_sectors = 40;
+    drv->disk_rate = 2;
+    drv->raw.size = 25 * fdd_data_rates[drv->disk_rate];
+    drv->raw.track_head = -1;
     drv->drive = drive;
     return drv;
 }
@@ -118,15 +135,59 @@ void fdd_shutdown(fd_drive_t *drv)
     if (!drv) {
         return;
     }
+    fdd_free_cache(drv);
     lib_free(drv->myname);
     lib_free(drv);
 }
 
+/* Forgets all encoded tracks without writing them back.  */
+static void fdd_free_cache(fd_drive_t *drv)
+{
+    int i;
+
+    for (i = 0; i < FDD_CACHE_TRACKS; i++) {
+        lib_free(drv->cache[i].data);
+        lib_free(drv->cache[i].sync);
+        drv->cache[i].data = NULL;
+        drv->cache[i].sync = NULL;
+        drv->cache[i].valid = 0;
+        drv->cache[i].dirty = 0;
+    }
+    drv->raw.data = NULL;
+    drv->raw.sync = NULL;
+    drv->raw.track_head = -1;
+    drv->raw.dirty = 0;
+}
+
+/* Makes the cache entry of `track_head' the current raw track, returns
+   non-zero if it already holds the encoded track.  */
+static int fdd_select_cache(fd_drive_t *drv, int track_head)
+{
+    if (drv->raw.track_head >= 0) {
+        drv->cache[drv->raw.track_head].dirty = drv->raw.dirty;
+    }
+
+    if (drv->cache[track_head].data == NULL) {
+        drv->cache[track_head].data = lib_malloc((size_t)(drv->raw.size));
+        drv->cache[track_head].sync = lib_malloc((size_t)((drv->raw.size + 7) >> 3));
+        drv->cache[track_head].valid = 0;
+        drv->cache[track_head].dirty = 0;
+    }
+
+    drv->raw.track_head = track_head;
+    drv->raw.data = drv->cache[track_head].data;
+    drv->raw.sync = drv->cache[track_head].sync;
+    drv->raw.dirty = drv->cache[track_head].dirty;
+
+    return drv->cache[track_head].valid;
+}
+
 void fdd_image_attach(fd_drive_t *drv, struct disk_image_s *image)
 {
     if (!drv) {
         return;
     }
+    fdd_free_cache(drv);
     drv->image = image;
     switch (image->type) {
         case DISK_IMAGE_TYPE_D1M:
@@ -176,10 +237,6 @@ void fdd_image_attach(fd_drive_t *drv, struct disk_image_s *image)
             break;
     }
     drv->raw.size = 25 * fdd_data_rates[drv->disk_rate];
-    drv->raw.data = lib_malloc((size_t)(drv->raw.size));
-    drv->raw.sync = lib_calloc(1, (size_t)((drv->raw.size + 7) >> 3));
-    drv->raw.track_head = -1;
-    drv->raw.dirty = 0;
     drv->raw.head = 0;
 
     drv->disk_change = 1;
@@ -191,12 +248,9 @@ void fdd_image_detach(fd_drive_t *drv)
     if (!drv) {
         return;
     }
-    fdd_flush_raw(drv);
+    fdd_flush_cache(drv);
+    fdd_free_cache(drv);
     drv->image = NULL;
-    lib_free(drv->raw.data);
-    drv->raw.data = NULL;
-    lib_free(drv->raw.sync);
-    drv->raw.sync = NULL;
     drv->disk_change = 1;
 }
 
@@ -380,6 +434,25 @@ static void fdd_flush_raw(fd_drive_t *drv)
     }
 }
 
+/* Writes all modified tracks back to the image.  */
+static void fdd_flush_cache(fd_drive_t *drv)
+{
+    int i, current;
+
+    if (drv->raw.track_head < 0) {
+        return;
+    }
+    current = drv->raw.track_head;
+    fdd_flush_raw(drv);
+    for (i = 0; i < FDD_CACHE_TRACKS; i++) {
+        if (drv->cache[i].dirty && i != current) {
+            fdd_select_cache(drv, i);
+            fdd_flush_raw(drv);
+        }
+    }
+    fdd_select_cache(drv, current);
+}
+
 static void fdd_update_raw(fd_drive_t *drv)
 {
     int i, j, s, p, res;
@@ -390,10 +463,10 @@ static void fdd_update_raw(fd_drive_t *drv)
     if (drv->track * 2 + drv->head == drv->raw.track_head) {
         return;
     }
-    if (drv->raw.dirty) {
-        fdd_flush_raw(drv);
+    if (fdd_select_cache(drv, drv->track * 2 + drv->head)) {
+        return;
     }
-    drv->raw.track_head = drv->track * 2 + drv->head;
+    drv->cache[drv->raw.track_head].valid = 1;
 
     memset(drv->raw.data, 0x4e, (size_t)(drv->raw.size));
     memset(drv->raw.sync, 0, (size_t)((drv->raw.size + 7) >> 3));
@@ -570,6 +643,53 @@ uint16_t fdd_read(fd_drive_t *drv)
     return data;
 }
 
+/* Reads up to `bytes' bytes like fdd_read() does, but stops after an ID
+   address mark or when the index count reaches `index_limit'.  `sync'
+   carries the "last byte was a sync byte" state between calls, `fm'
+   accepts the single density mark as well.  Returns the number of bytes
+   read, `*found' is set if the last one was the mark.  */
+int fdd_find_id_mark(fd_drive_t *drv, int bytes, unsigned int index_limit,
+                     int fm, int *sync, int *found)
+{
+    uint16_t data;
+    int p, n;
+
+    *found = 0;
+    if (!drv || !drv->motor) {
+        /* the head does not move, only zero bytes are read */
+        *sync = 0;
+        return bytes;
+    }
+    if (drv->disk_rate == drv->rate) {
+        fdd_update_raw(drv);
+    }
+
+    p = drv->raw.head;
+    for (n = 0; n < bytes && drv->index_count < index_limit; ) {
+        if (drv->disk_rate == drv->rate) {
+            data = (uint16_t)drv->raw.data[p];
+            if (drv->raw.sync[p >> 3] & (0x80 >> (p & 7))) {
+                data |= 0x100;
+            }
+        } else {
+            data = 0;
+        }
+        n++;
+        p++;
+        if (p >= drv->raw.size) {
+            p = 0;
+            drv->index_count++;
+        }
+        if ((fm && data == 0x1fe) || (*sync && data == 0xfe)) {
+            *found = 1;
+            break;
+        }
+        *sync = (data == 0x1a1);
+    }
+    drv->raw.head = p;
+    return n;
+}
+
 int fdd_write(fd_drive_t *drv, uint16_t data)
 {
     int p;
@@ -603,7 +723,7 @@ void fdd_flush(fd_drive_t *drv)
     if (!drv) {
         return;
     }
-    fdd_flush_raw(drv);
+    fdd_flush_cache(drv);
 }
 
 void fdd_seek_pulse(fd_drive_t *drv, int dir)
@@ -639,6 +759,10 @@ void fdd_set_motor(fd_drive_t *drv, int motor)
     if (!drv) {
         return;
     }
+    /* write back modified tracks once the disk stops spinning */
+    if (drv->motor && !(motor & 1)) {
+        fdd_flush_cache(drv);
+    }
     drv->motor = motor & 1;
 }
 
@@ -650,12 +774,19 @@ void fdd_set_rate(fd_drive_t *drv, int rate)
     drv->rate = rate & 3;
 }
 
+/* 1.1: the modified tracks that are not yet written back follow the
+   current track.  */
 #define FDD_SNAP_MAJOR 1
-#define FDD_SNAP_MINOR 0
+#define FDD_SNAP_MINOR 1
 
 int fdd_snapshot_write_module(fd_drive_t *drv, struct snapshot_s *s)
 {
     snapshot_module_t *m;
+    int i, dirty_tracks = 0;
+
+    if (drv->raw.data == NULL) {
+        fdd_update_raw(drv);
+    }
 
     m = snapshot_module_create(s, drv->myname, FDD_SNAP_MAJOR, FDD_SNAP_MINOR);
 
@@ -690,6 +821,28 @@ int fdd_snapshot_write_module(fd_drive_t *drv, struct snapshot_s *s)
         return -1;
     }
 
+    /* the image is left alone, so the modified tracks go into the snapshot */
+    for (i = 0; i < FDD_CACHE_TRACKS; i++) {
+        if (drv->cache[i].dirty && i != drv->raw.track_head) {
+            dirty_tracks++;
+        }
+    }
+    if (SMW_B(m, (uint8_t)dirty_tracks) < 0) {
+        snapshot_module_close(m);
+        return -1;
+    }
+    for (i = 0; i < FDD_CACHE_TRACKS; i++) {
+        if (drv->cache[i].dirty && i != drv->raw.track_head) {
+            if (0
+                || SMW_B(m, (uint8_t)i) < 0
+                || SMW_BA(m, drv->cache[i].data, (unsigned int)drv->raw.size) < 0
+                || SMW_BA(m, drv->cache[i].sync, (unsigned int)((drv->raw.size + 7) >> 3)) < 0) {
+                snapshot_module_close(m);
+                return -1;
+            }
+        }
+    }
+
     /* TODO: Disk image save */
 
     return snapshot_module_close(m);
@@ -699,12 +852,16 @@ int fdd_snapshot_read_module(fd_drive_t *drv, struct snapshot_s *s)
 {
     uint8_t vmajor, vminor;
     snapshot_module_t *m;
+    int i, track_head, dirty, valid, dirty_tracks;
 
     m = snapshot_module_open(s, drv->myname, &vmajor, &vminor);
     if (m == NULL) {
         return -1;
     }
 
+    /* the tracks modified so far belong to the image, not to the snapshot */
+    fdd_flush_cache(drv);
+
     /* Do not accept versions higher than current */
     if (vmajor > FDD_SNAP_MAJOR || vminor > FDD_SNAP_MINOR) {
         snapshot_set_error(SNAPSHOT_MODULE_HIGHER_VERSION);
@@ -755,20 +912,62 @@ int fdd_snapshot_read_module(fd_drive_t *drv, struct snapshot_s *s)
     drv->sector_size &= 3;
     drv->disk_rate &= 3;
 
+    track_head = drv->raw.track_head;
+    dirty = drv->raw.dirty;
+
+    /* the saved track replaces everything encoded so far */
+    fdd_free_cache(drv);
     drv->raw.size = 25 * fdd_data_rates[drv->disk_rate];
     drv->raw.head %= drv->raw.size;
 
-    lib_free(drv->raw.data);
-    drv->raw.data = lib_malloc((size_t)drv->raw.size);
-    lib_free(drv->raw.sync);
-    drv->raw.sync = lib_malloc((size_t)((drv->raw.size + 7) >> 3));
+    valid = (track_head >= 0 && track_head < FDD_CACHE_TRACKS);
+    fdd_select_cache(drv, valid ? track_head : 0);
 
     if (0
         || SMR_BA(m, drv->raw.data, (unsigned int)drv->raw.size) < 0
         || SMR_BA(m, drv->raw.sync, (unsigned int)((drv->raw.size + 7) >> 3)) < 0) {
+        fdd_free_cache(drv);
         snapshot_module_close(m);
         return -1;
     }
 
+    if (valid) {
+        drv->cache[track_head].valid = 1;
+        drv->raw.dirty = dirty;
+    }
+
+    if (vminor >= 1) {
+        if (SMR_B_INT(m, &dirty_tracks) < 0) {
+            fdd_free_cache(drv);
+            snapshot_module_close(m);
+            return -1;
+        }
+        while (dirty_tracks-- > 0) {
+            if (SMR_B_INT(m, &i) < 0
+                || i >= FDD_CACHE_TRACKS
+                || (valid && i == track_head)) {
+                fdd_free_cache(drv);
+                snapshot_module_close(m);
+                return -1;
+            }
+            fdd_select_cache(drv, i);
+            if (0
+                || SMR_BA(m, drv->raw.data, (unsigned int)drv->raw.size) < 0
+                || SMR_BA(m, drv->raw.sync, (unsigned int)((drv->raw.size + 7) >> 3)) < 0) {
+                fdd_free_cache(drv);
+                snapshot_module_close(m);
+                return -1;
+            }
+            drv->cache[i].valid = 1;
+            drv->raw.dirty = 1;
+        }
+        fdd_select_cache(drv, valid ? track_head : 0);
+    }
+
+    if (!valid) {
+        /* no track was selected when the snapshot was taken */
+        drv->raw.track_head = -1;
+    }
+
     return snapshot_module_close(m);
 }
@@ -42,6 +42,8 @@ extern void fdd_image_attach(fd_drive_t *drv, struct disk_image_s *image);
 extern void fdd_image_detach(fd_drive_t *drv);
 extern uint16_t fdd_read(fd_drive_t *drv);
 extern int fdd_write(fd_drive_t *drv, uint16_t data);
+extern int fdd_find_id_mark(fd_drive_t *drv, int bytes, unsigned int index_limit,
+                            int fm, int *sync, int *found);
 extern void fdd_flush(fd_drive_t *drv);
 extern void fdd_seek_pulse(fd_drive_t *drv, int dir);
 extern void fdd_select_head(fd_drive_t *drv, int head);
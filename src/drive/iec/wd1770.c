@@ -205,10 +205,36 @@ void wd1770_shutdown(wd1770_t *drv)
     lib_free(drv);
 }
 
+/* Searches for an ID address mark.  Nothing is visible from outside while
+   the search runs, so all bytes that passed up to the current CPU clock
+   are scanned at once instead of one per loop.  Returns 1 if the mark was
+   found, -1 if the index count reached `index_limit' and 0 if more time
+   has to pass.  */
+static int wd1770_find_id(wd1770_t *drv, unsigned int index_limit)
+{
+    int bytes, found;
+
+    for (;; ) {
+        if (fdd_index_count(drv->fdd) >= index_limit) {
+            return -1;
+        }
+        if (*drv->cpu_clk_ptr < drv->clk + BYTE_RATE) {
+            return 0;
+        }
+        bytes = (int)((*drv->cpu_clk_ptr - drv->clk) / BYTE_RATE);
+        bytes = fdd_find_id_mark(drv->fdd, bytes, index_limit, drv->dden, &drv->sync, &found);
+        drv->clk += bytes * BYTE_RATE;
+        if (found) {
+            return 1;
+        }
+    }
+}
+
 /* Execute microcode */
 static void wd1770_execute(wd1770_t *drv)
 {
     unsigned int res;
+    int found;
 
     for (;; ) {
         switch (drv->type) {
@@ -330,22 +356,15 @@ static void wd1770_execute(wd1770_t *drv)
                         drv->step++;
                         /* fall through */
                     case 10:
-                        if (fdd_index_count(drv->fdd) >= 6) {
+                        found = wd1770_find_id(drv, 6);
+                        if (found < 0) {
                             drv->status |= WD_SE;
                             drv->type = -1;
                             break;
                         }
-                        if (*drv->cpu_clk_ptr < drv->clk + BYTE_RATE) {
+                        if (!found) {
                             return;
                         }
-                        drv->clk += BYTE_RATE;
-                        res = fdd_read(drv->fdd);
-                        if (!drv->dden || res != 0x1fe) {
-                            if (!drv->sync || res != 0xfe) {
-                                drv->sync = (res == 0x1a1);
-                                continue;
-                            }
-                        }
                         drv->sync = 0;
                         drv->crc = 0xb230;
                         drv->byte_count = 6;
@@ -428,22 +447,15 @@ static void wd1770_execute(wd1770_t *drv)
                         drv->step++;
                         /* fall through */
                     case 6:
-                        if (fdd_index_count(drv->fdd) >= 5) {
+                        found = wd1770_find_id(drv, 5);
+                        if (found < 0) {
                             drv->status |= WD_RNF;
                             drv->type = 0;
                             break;
                         }
-                        if (*drv->cpu_clk_ptr < drv->clk + BYTE_RATE) {
+                        if (!found) {
                             return;
                         }
-                        drv->clk += BYTE_RATE;
-                        res = fdd_read(drv->fdd);
-                        if (!drv->dden || res != 0x1fe) {
-                            if (!drv->sync || res != 0xfe) {
-                                drv->sync = (res == 0x1a1);
-                                continue;
-                            }
-                        }
                         drv->sync = 0;
                         drv->crc = 0xb230;
                         drv->byte_count = 6;
@@ -677,22 +689,15 @@ static void wd1770_execute(wd1770_t *drv)
                         drv->status |= (drv->status & WD_DRQ) ? WD_LD : WD_DRQ;
                         continue;
                     case 7:
-                        if (fdd_index_count(drv->fdd) >= 6) {
+                        found = wd1770_find_id(drv, 6);
+                        if (found < 0) {
                             drv->status |= WD_RNF;
                             drv->type = 0;
                             break;
                         }
-                        if (*drv->cpu_clk_ptr < drv->clk + BYTE_RATE) {
+                        if (!found) {
                             return;
                         }
-                        drv->clk += BYTE_RATE;
-                        res = fdd_read(drv->fdd);
-                        if (!drv->dden || res != 0x1fe) {
-                            if (!drv->sync || res != 0xfe) {
-                                drv->sync = (res == 0x1a1);
-                                continue;
-                            }
-                        }
                         drv->crc = 0xb230;
                         drv->byte_count = 6;
                         drv->step++;
@@ -44,11 +44,16 @@
 #define BMP_HDR_OFFSET (14 + 40 + 4 * screenshot->palette->num_entries)
 #define BMP_HDR_OFFSET24 (14 + 40)
 
+/* Number of converted rows collected before they are written out.  */
+#define BMP_BUFFER_ROWS 64
+
 typedef struct gfxoutputdrv_data_s {
     FILE *fd;
     char *ext_filename;
     uint8_t *data;
     uint8_t *bmp_data;
+    long bmp_offset;
+    unsigned int bmp_rows;
     int line;
     unsigned int bpp;
 } gfxoutputdrv_data_t;
@@ -204,7 +209,35 @@ static int bmpdrv_open(screenshot_t *screenshot, const char *filename)
         sdata->data = lib_malloc(screenshot->width);
     }
 
-    sdata->bmp_data = lib_malloc(bmpdrv_bytes_per_row(screenshot) * screenshot->height);
+    /* BMP rows are stored bottom-up.  Converted rows are collected from the
+       end of the buffer backwards, so a full buffer is one block of the
+       file and the whole page is never kept in memory.  */
+    sdata->bmp_data = lib_malloc(bmpdrv_bytes_per_row(screenshot) * BMP_BUFFER_ROWS);
+    sdata->bmp_offset = ftell(sdata->fd);
+    sdata->bmp_rows = 0;
+
+    return 0;
+}
+
+/* Write the buffered rows to their place in the file.  */
+static int bmpdrv_write_rows(screenshot_t *screenshot)
+{
+    gfxoutputdrv_data_t *sdata = screenshot->gfxoutputdrv_data;
+    int bmp_width = bmpdrv_bytes_per_row(screenshot);
+    unsigned int rows = sdata->bmp_rows;
+    long offset;
+
+    if (rows == 0) {
+        return 0;
+    }
+
+    offset = sdata->bmp_offset + (long)(screenshot->height - sdata->line) * bmp_width;
+    sdata->bmp_rows = 0;
+
+    if (fseek(sdata->fd, offset, SEEK_SET) != 0
+        || fwrite(sdata->bmp_data + (BMP_BUFFER_ROWS - rows) * bmp_width, bmp_width * rows, 1, sdata->fd) != 1) {
+        return -1;
+    }
 
     return 0;
 }
@@ -214,8 +247,10 @@ static int bmpdrv_write(screenshot_t *screenshot)
     unsigned int row;
     gfxoutputdrv_data_t *sdata;
     int bmp_width = bmpdrv_bytes_per_row(screenshot);
+    uint8_t *bmp_row;
 
     sdata = screenshot->gfxoutputdrv_data;
+    bmp_row = sdata->bmp_data + (BMP_BUFFER_ROWS - 1 - sdata->bmp_rows) * bmp_width;
 
     if (sdata->bpp == 24) {
         (screenshot->convert_line)(screenshot, sdata->data, sdata->line, SCREENSHOT_MODE_RGB24);
@@ -227,8 +262,7 @@ static int bmpdrv_write(screenshot_t *screenshot)
         case 1:
             {
                 int i, j;
-                memset(sdata->bmp_data + (screenshot->height - 1 - sdata->line)
-                       * bmp_width, 0, bmp_width);
+                memset(bmp_row, 0, bmp_width);
 
                 for (i = 0; i < (int)screenshot->width / 8; i++)
                 {
@@ -236,46 +270,47 @@ static int bmpdrv_write(screenshot_t *screenshot)
                     for (j = 0; j < 8; j++) {
                         b |= sdata->data[i * 8 + j] ? (1 << (7 - j)) : 0;
                     }
-                    sdata->bmp_data[((screenshot->height - 1 - sdata->line)
-                                     * bmp_width) + i] = b;
+                    bmp_row[i] = b;
                 }
             }
             break;
         case 4:
+            memset(bmp_row, 0, bmp_width);
             for (row = 0; row < screenshot->width / 2; row++) {
-                sdata->bmp_data[((screenshot->height - 1 - sdata->line)
-                                 * bmp_width) + row]
+                bmp_row[row]
                     = ((sdata->data[row * 2] & 0xf) << 4)
                       | (sdata->data[row * 2 + 1] & 0xf);
             }
             break;
         case 8:
-            memcpy(sdata->bmp_data + (screenshot->height - 1 - sdata->line)
-                   * bmp_width, sdata->data, screenshot->width);
+            memset(bmp_row, 0, bmp_width);
+            memcpy(bmp_row, sdata->data, screenshot->width);
             break;
         case 24:
-            memcpy(sdata->bmp_data + (screenshot->height - 1 - sdata->line)
-                   * bmp_width, sdata->data, screenshot->width * 3);
+            memset(bmp_row, 0, bmp_width);
+            memcpy(bmp_row, sdata->data, screenshot->width * 3);
             break;
     }
 
     sdata->line++;
+    sdata->bmp_rows++;
+
+    if (sdata->bmp_rows == BMP_BUFFER_ROWS || sdata->line == (int)screenshot->height) {
+        return bmpdrv_write_rows(screenshot);
+    }
 
     return 0;
 }
 
 static int bmpdrv_close(screenshot_t *screenshot)
 {
-    int res = -1;
-    size_t len = bmpdrv_bytes_per_row(screenshot) * screenshot->height;
-
-    if (fwrite(screenshot->gfxoutputdrv_data->bmp_data, len, 1, screenshot->gfxoutputdrv_data->fd) == 1) {
-        res = 0;
-    }
+    int res = bmpdrv_write_rows(screenshot);
 
     lib_free(screenshot->gfxoutputdrv_data->data);
     lib_free(screenshot->gfxoutputdrv_data->bmp_data);
-    fclose(screenshot->gfxoutputdrv_data->fd);
+    if (fclose(screenshot->gfxoutputdrv_data->fd) != 0) {
+        res = -1;
+    }
     lib_free(screenshot->gfxoutputdrv_data->ext_filename);
     lib_free(screenshot->gfxoutputdrv_data);
     return res;
@@ -291,9 +326,7 @@ static int bmpdrv_save(screenshot_t *screenshot, const char *filename)
 
     for (i = 0; i < screenshot->height; i++) {
         if (bmpdrv_write(screenshot) < 0) {
-            fclose(screenshot->gfxoutputdrv_data->fd);
-            lib_free(screenshot->gfxoutputdrv_data->ext_filename);
-            lib_free(screenshot->gfxoutputdrv_data);
+            bmpdrv_close(screenshot);
             return -1;
         }
     }
@@ -99,6 +99,55 @@ static int circular_check(unsigned int track, unsigned int sector)
     return 0;
 }
 
+/* Append the directory entries of one directory sector to the file list of
+   `contents'.  `lp' is the last entry of the list (or NULL), the new last
+   entry is returned.  */
+image_contents_file_list_t *diskcontents_block_add_entries(image_contents_t *contents,
+                                                           image_contents_file_list_t *lp,
+                                                           const uint8_t *buffer)
+{
+    const uint8_t *p;
+    int j;
+
+    for (p = buffer, j = 0; j < 8; j++, p += 32) {
+        if (p[SLOT_TYPE_OFFSET] != 0) {
+            image_contents_file_list_t *new_list;
+            int i;
+
+            new_list = lib_malloc(sizeof(image_contents_file_list_t));
+            new_list->size = ((int)p[SLOT_NR_BLOCKS]
+                              + ((int)p[SLOT_NR_BLOCKS + 1] << 8));
+
+            for (i = 0; i < IMAGE_CONTENTS_FILE_NAME_LEN; i++) {
+                new_list->name[i] = p[SLOT_NAME_OFFSET + i];
+            }
+
+            new_list->name[IMAGE_CONTENTS_FILE_NAME_LEN] = 0;
+
+            new_list->name[i] = 0;
+
+            sprintf((char *)new_list->type, "%c%s%c",
+                    (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_CLOSED ? ' ' : '*'),
+                    cbmdos_filetype_get(p[SLOT_TYPE_OFFSET] & 0x07),
+                    (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_LOCKED ? '<' : ' '));
+
+            new_list->next = NULL;
+
+            if (lp == NULL) {
+                new_list->prev = NULL;
+                contents->file_list = new_list;
+                lp = contents->file_list;
+            } else {
+                new_list->prev = lp;
+                lp->next = new_list;
+                lp = new_list;
+            }
+        }
+    }
+
+    return lp;
+}
+
 image_contents_t *diskcontents_block_read(vdrive_t *vdrive)
 {
     image_contents_t *contents;
@@ -140,9 +189,6 @@ image_contents_t *diskcontents_block_read(vdrive_t *vdrive)
     circular_check_init();
 
     while (1) {
-        uint8_t *p;
-        int j;
-
         retval = vdrive_read_sector(vdrive, buffer, curr_track, curr_sector);
 
         if (retval != 0
@@ -153,41 +199,7 @@ image_contents_t *diskcontents_block_read(vdrive_t *vdrive)
             return contents /*NULL*/;
         }
 
-        for (p = buffer, j = 0; j < 8; j++, p += 32) {
-            if (p[SLOT_TYPE_OFFSET] != 0) {
-                image_contents_file_list_t *new_list;
-                int i;
-
-                new_list = lib_malloc(sizeof(image_contents_file_list_t));
-                new_list->size = ((int)p[SLOT_NR_BLOCKS]
-                                  + ((int)p[SLOT_NR_BLOCKS + 1] << 8));
-
-                for (i = 0; i < IMAGE_CONTENTS_FILE_NAME_LEN; i++) {
-                    new_list->name[i] = p[SLOT_NAME_OFFSET + i];
-                }
-
-                new_list->name[IMAGE_CONTENTS_FILE_NAME_LEN] = 0;
-
-                new_list->name[i] = 0;
-
-                sprintf((char *)new_list->type, "%c%s%c",
-                        (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_CLOSED ? ' ' : '*'),
-                        cbmdos_filetype_get(p[SLOT_TYPE_OFFSET] & 0x07),
-                        (p[SLOT_TYPE_OFFSET] & CBMDOS_FT_LOCKED ? '<' : ' '));
-
-                new_list->next = NULL;
-
-                if (lp == NULL) {
-                    new_list->prev = NULL;
-                    contents->file_list = new_list;
-                    lp = contents->file_list;
-                } else {
-                    new_list->prev = lp;
-                    lp->next = new_list;
-                    lp = new_list;
-                }
-            }
-        }
+        lp = diskcontents_block_add_entries(contents, lp, buffer);
 
         if (buffer[0] == 0) {
             break;
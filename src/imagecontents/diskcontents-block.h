@@ -27,9 +27,15 @@
 #ifndef VICE_DISKCONTENTS_BLOCK_H
 #define VICE_DISKCONTENTS_BLOCK_H
 
+#include "types.h"
+
 struct image_contents_s;
+struct image_contents_file_list_s;
 struct vdrive_s;
 
 extern struct image_contents_s *diskcontents_block_read(struct vdrive_s *vdrive);
+extern struct image_contents_file_list_s *diskcontents_block_add_entries(struct image_contents_s *contents,
+                                                                         struct image_contents_file_list_s *lp,
+                                                                         const uint8_t *buffer);
 
 #endif
@@ -0,0 +1,485 @@
+/*
+ * diskcontents-direct.c - Read directory straight from a disk image file.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Listing a directory through `diskcontents_block_read()' means probing the
+   whole image, attaching it to a vdrive and, for G64 images, reading and
+   converting every track.  For previews only the header, the BAM and the
+   directory sectors are needed, so this reader fetches just those blocks
+   from the image file.  Anything it does not handle
+   exactly like the vdrive code is refused, and the caller falls back to the
+   block device reader.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "cbmdos.h"
+#include "diskconstants.h"
+#include "diskcontents-block.h"
+#include "diskcontents-direct.h"
+#include "diskimage.h"
+#include "gcr.h"
+#include "imagecontents.h"
+#include "lib.h"
+#include "types.h"
+#include "util.h"
+#include "vdrive-bam.h"
+#include "zfile.h"
+
+/* Largest supported image in blocks (D82).  */
+#define DIRECT_MAX_BLOCKS   NUM_BLOCKS_8250
+
+/* Largest BAM (D80/D82, 5 blocks).  */
+#define DIRECT_BAM_SIZE     0x500
+
+#define DIRECT_SECTOR_OK            0
+#define DIRECT_SECTOR_ERROR         -1
+#define DIRECT_SECTOR_UNSUPPORTED   -2
+
+typedef struct direct_image_s {
+    FILE *fd;
+
+    unsigned int type;
+    unsigned int tracks;
+
+    /* Offset of the error info block, 0 if the image has none.  */
+    long error_info;
+
+    /* G64 only: raw GCR data of the directory track.  */
+    disk_track_t dir_track;
+} direct_image_t;
+
+/* ------------------------------------------------------------------------- */
+
+static int direct_read_raw(const direct_image_t *image, uint8_t *buf,
+                           size_t num, long offset)
+{
+    return util_fpread(image->fd, buf, num, offset);
+}
+
+static int direct_probe_gcr(direct_image_t *image, uint8_t *header)
+{
+    uint8_t buf[4];
+    unsigned int max_track_length, track_len;
+    long offset;
+
+    if (memcmp(header, "GCR-1541", 8) != 0 || header[8] != 0
+        || header[9] < (DIR_TRACK_1541 * 2) - 1) {
+        return -1;
+    }
+
+    image->type = DISK_IMAGE_TYPE_G64;
+    image->tracks = header[9] / 2;
+    if (image->tracks > MAX_TRACKS_1541) {
+        image->tracks = MAX_TRACKS_1541;
+    }
+    max_track_length = util_le_buf_to_word(&header[10]);
+
+    /* Only the directory track is decoded.  An unformatted track is left
+       to the vdrive code.  */
+    if (direct_read_raw(image, buf, 4, 12 + ((DIR_TRACK_1541 * 2) - 2) * 4) < 0) {
+        return -1;
+    }
+    offset = (long)util_le_buf_to_dword(buf);
+    if (offset == 0) {
+        return -1;
+    }
+
+    if (direct_read_raw(image, buf, 2, offset) < 0) {
+        return -1;
+    }
+    track_len = util_le_buf_to_word(buf);
+    if (track_len < 1 || track_len > max_track_length) {
+        return -1;
+    }
+
+    image->dir_track.data = lib_malloc(track_len);
+    image->dir_track.size = (int)track_len;
+
+    return direct_read_raw(image, image->dir_track.data, track_len, offset + 2);
+}
+
+/* Detect the image type the same way `disk_image_probe()' does, by file
+   size (or header, for G64).  */
+static int direct_probe(direct_image_t *image, const char *file_name)
+{
+    uint8_t header[12];
+    size_t len, blocks;
+    unsigned int tracks;
+    char *ext;
+
+    len = util_file_length(image->fd);
+
+    image->error_info = 0;
+    image->dir_track.data = NULL;
+    image->dir_track.size = 0;
+
+    /* D64, 35 to 42 tracks */
+    for (tracks = NUM_TRACKS_1541, blocks = NUM_BLOCKS_1541;
+         tracks <= MAX_TRACKS_1541; tracks++, blocks += 17) {
+        if (len == blocks * 256 || len == blocks * 257) {
+            image->type = DISK_IMAGE_TYPE_D64;
+            image->tracks = tracks;
+            if (len == blocks * 257) {
+                image->error_info = (long)(blocks * 256);
+            }
+            return 0;
+        }
+    }
+
+    if (len == D71_FILE_SIZE || len == D71_FILE_SIZE_E) {
+        image->type = DISK_IMAGE_TYPE_D71;
+        image->tracks = NUM_TRACKS_1571;
+        if (len == D71_FILE_SIZE_E) {
+            image->error_info = NUM_BLOCKS_1571 * 256;
+        }
+        return 0;
+    }
+
+    /* D81, 80 to 83 tracks */
+    for (tracks = NUM_TRACKS_1581; tracks <= MAX_TRACKS_1581; tracks++) {
+        blocks = tracks * NUM_SECTORS_1581;
+        if (len == blocks * 256 || len == blocks * 257) {
+            /* .d1m images share the same sizes with .d81 */
+            ext = util_get_extension((char *)file_name);
+            if (ext && ext[0] && (ext[1] == '1') && ext[2]) {
+                return -1;
+            }
+            image->type = DISK_IMAGE_TYPE_D81;
+            image->tracks = tracks;
+            if (len == blocks * 257) {
+                image->error_info = (long)(blocks * 256);
+            }
+            return 0;
+        }
+    }
+
+    if (len == D80_FILE_SIZE) {
+        image->type = DISK_IMAGE_TYPE_D80;
+        image->tracks = NUM_TRACKS_8050;
+        return 0;
+    }
+
+    if (len == D82_FILE_SIZE) {
+        image->type = DISK_IMAGE_TYPE_D82;
+        image->tracks = NUM_TRACKS_8250;
+        return 0;
+    }
+
+    if (direct_read_raw(image, header, sizeof(header), 0) < 0) {
+        return -1;
+    }
+    return direct_probe_gcr(image, header);
+}
+
+/* Return the block number of `track'/`sector' in the image, or -1.  */
+static int direct_sector_index(const direct_image_t *image, unsigned int track,
+                               unsigned int sector)
+{
+    unsigned int format, index = 0, i;
+
+    if (track < 1 || track > image->tracks) {
+        return -1;
+    }
+
+    switch (image->type) {
+        case DISK_IMAGE_TYPE_D81:
+            if (sector >= NUM_SECTORS_1581) {
+                return -1;
+            }
+            return (int)((track - 1) * NUM_SECTORS_1581 + sector);
+        case DISK_IMAGE_TYPE_D71:
+            if (track > NUM_TRACKS_1541) {      /* The second side */
+                track -= NUM_TRACKS_1541;
+                index = NUM_BLOCKS_1541;
+            }
+            format = DISK_IMAGE_TYPE_D64;
+            break;
+        case DISK_IMAGE_TYPE_D82:
+            if (track > NUM_TRACKS_8050) {      /* The second side */
+                track -= NUM_TRACKS_8050;
+                index = NUM_BLOCKS_8050;
+            }
+            format = DISK_IMAGE_TYPE_D80;
+            break;
+        case DISK_IMAGE_TYPE_D80:
+            format = DISK_IMAGE_TYPE_D80;
+            break;
+        default:
+            format = DISK_IMAGE_TYPE_D64;
+            break;
+    }
+
+    if (sector >= disk_image_sector_per_track(format, track)) {
+        return -1;
+    }
+    for (i = 1; i < track; i++) {
+        index += disk_image_sector_per_track(format, i);
+    }
+    return (int)(index + sector);
+}
+
+/* Map an FDC result to ok/error like `fsimage_dxx_read_sector()' does.  */
+static int direct_fdc_result(int rf)
+{
+    switch (rf) {
+        case CBMDOS_FDC_ERR_HEADER:
+        case CBMDOS_FDC_ERR_SYNC:
+        case CBMDOS_FDC_ERR_NOBLOCK:
+        case CBMDOS_FDC_ERR_DCHECK:
+        case CBMDOS_FDC_ERR_VERIFY:
+        case CBMDOS_FDC_ERR_WPROT:
+        case CBMDOS_FDC_ERR_HCHECK:
+        case CBMDOS_FDC_ERR_BLENGTH:
+        case CBMDOS_FDC_ERR_ID:
+        case CBMDOS_FDC_ERR_DRIVE:
+        case CBMDOS_FDC_ERR_DECODE:
+            return DIRECT_SECTOR_ERROR;
+        default:
+            return DIRECT_SECTOR_OK;
+    }
+}
+
+static int direct_read_sector(const direct_image_t *image, uint8_t *buf,
+                              unsigned int track, unsigned int sector)
+{
+    int index;
+    uint8_t rf;
+
+    index = direct_sector_index(image, track, sector);
+    if (index < 0) {
+        return DIRECT_SECTOR_ERROR;
+    }
+
+    if (image->type == DISK_IMAGE_TYPE_G64) {
+        if (track != DIR_TRACK_1541) {
+            return DIRECT_SECTOR_UNSUPPORTED;
+        }
+        return direct_fdc_result(gcr_read_sector(&image->dir_track, buf,
+                                                 (uint8_t)sector));
+    }
+
+    if (direct_read_raw(image, buf, 256, (long)index * 256) < 0) {
+        return DIRECT_SECTOR_ERROR;
+    }
+
+    if (image->error_info != 0) {
+        if (direct_read_raw(image, &rf, 1, image->error_info + index) < 0) {
+            return DIRECT_SECTOR_ERROR;
+        }
+        return direct_fdc_result(rf);
+    }
+    return DIRECT_SECTOR_OK;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Read the BAM blocks, in the layout `vdrive_bam_read_bam()' uses.  */
+static int direct_read_bam(const direct_image_t *image, uint8_t *bam)
+{
+    switch (image->type) {
+        case DISK_IMAGE_TYPE_D64:
+        case DISK_IMAGE_TYPE_G64:
+            return direct_read_sector(image, bam, BAM_TRACK_1541, BAM_SECTOR_1541);
+        case DISK_IMAGE_TYPE_D71:
+            if (direct_read_sector(image, bam, BAM_TRACK_1571, BAM_SECTOR_1571) != 0) {
+                return DIRECT_SECTOR_ERROR;
+            }
+            return direct_read_sector(image, bam + 256, BAM_TRACK_1571 + 35, BAM_SECTOR_1571);
+        case DISK_IMAGE_TYPE_D81:
+            if (direct_read_sector(image, bam, BAM_TRACK_1581, BAM_SECTOR_1581) != 0
+                || direct_read_sector(image, bam + 256, BAM_TRACK_1581, BAM_SECTOR_1581 + 1) != 0) {
+                return DIRECT_SECTOR_ERROR;
+            }
+            return direct_read_sector(image, bam + 512, BAM_TRACK_1581, BAM_SECTOR_1581 + 2);
+        case DISK_IMAGE_TYPE_D80:
+        case DISK_IMAGE_TYPE_D82:
+            if (direct_read_sector(image, bam, BAM_TRACK_8050, BAM_SECTOR_8050) != 0
+                || direct_read_sector(image, bam + 256, BAM_TRACK_8050 - 1, BAM_SECTOR_8050) != 0
+                || direct_read_sector(image, bam + 512, BAM_TRACK_8050 - 1, BAM_SECTOR_8050 + 3) != 0) {
+                return DIRECT_SECTOR_ERROR;
+            }
+            if (image->type == DISK_IMAGE_TYPE_D80) {
+                return DIRECT_SECTOR_OK;
+            }
+            if (direct_read_sector(image, bam + 768, BAM_TRACK_8050 - 1, BAM_SECTOR_8050 + 6) != 0) {
+                return DIRECT_SECTOR_ERROR;
+            }
+            return direct_read_sector(image, bam + 1024, BAM_TRACK_8050 - 1, BAM_SECTOR_8050 + 9);
+        default:
+            return DIRECT_SECTOR_ERROR;
+    }
+}
+
+/* Same count as `vdrive_bam_free_block_count()'.  */
+static int direct_free_block_count(const direct_image_t *image, const uint8_t *bam)
+{
+    unsigned int blocks = 0, i, j, parts;
+
+    for (i = 1; i <= image->tracks; i++) {
+        switch (image->type) {
+            case DISK_IMAGE_TYPE_D64:
+            case DISK_IMAGE_TYPE_G64:
+                if (i != DIR_TRACK_1541) {
+                    blocks += (i <= NUM_TRACKS_1541) ?
+                              bam[BAM_BIT_MAP + 4 * (i - 1)] :
+                              bam[BAM_EXT_BIT_MAP_1541 + 4 * (i - NUM_TRACKS_1541 - 1)];
+                }
+                break;
+            case DISK_IMAGE_TYPE_D71:
+                if (i != DIR_TRACK_1571 && i != DIR_TRACK_1571 + 35) {
+                    blocks += (i <= NUM_TRACKS_1571 / 2) ?
+                              bam[BAM_BIT_MAP + 4 * (i - 1)] :
+                              bam[BAM_EXT_BIT_MAP_1571 + i - 1 - NUM_TRACKS_1571 / 2];
+                }
+                break;
+            case DISK_IMAGE_TYPE_D81:
+                if (i != DIR_TRACK_1581) {
+                    blocks += (i <= NUM_TRACKS_1581 / 2) ?
+                              bam[BAM_BIT_MAP_1581 + 256 + 6 * (i - 1)] :
+                              bam[BAM_BIT_MAP_1581 + 512 + 6 * (i - 1 - NUM_TRACKS_1581 / 2)];
+                }
+                break;
+            case DISK_IMAGE_TYPE_D80:
+            case DISK_IMAGE_TYPE_D82:
+                parts = (image->type == DISK_IMAGE_TYPE_D80) ? 3 : 5;
+                if (i != DIR_TRACK_8050) {
+                    for (j = 1; j < parts; j++) {
+                        if (i >= bam[(j * 0x100) + 4] && i < bam[(j * 0x100) + 5]) {
+                            blocks += bam[(j * 0x100) + BAM_BIT_MAP_8050 + 5 * (i - bam[(j * 0x100) + 4])];
+                            break;
+                        }
+                    }
+                }
+                break;
+        }
+    }
+    return (int)blocks;
+}
+
+static image_contents_t *direct_read(direct_image_t *image)
+{
+    image_contents_t *contents;
+    image_contents_file_list_t *lp;
+    uint8_t bam[DIRECT_BAM_SIZE];
+    uint8_t buffer[256];
+    uint8_t visited[(DIRECT_MAX_BLOCKS + 7) / 8];
+    unsigned int bam_name, bam_id, curr_track, curr_sector;
+    int index, retval;
+
+    memset(bam, 0, sizeof(bam));
+
+    if (direct_read_bam(image, bam) != DIRECT_SECTOR_OK) {
+        return NULL;
+    }
+
+    switch (image->type) {
+        case DISK_IMAGE_TYPE_D81:
+            bam_name = BAM_NAME_1581;
+            bam_id = BAM_ID_1581;
+            curr_track = DIR_TRACK_1581;
+            curr_sector = DIR_SECTOR_1581;
+            break;
+        case DISK_IMAGE_TYPE_D80:
+        case DISK_IMAGE_TYPE_D82:
+            bam_name = BAM_NAME_8050;
+            bam_id = BAM_ID_8050;
+            curr_track = DIR_TRACK_8050;
+            curr_sector = DIR_SECTOR_8050;
+            break;
+        default:
+            bam_name = BAM_NAME_1541;
+            bam_id = BAM_ID_1541;
+            curr_track = DIR_TRACK_1541;
+            curr_sector = DIR_SECTOR_1541;
+            break;
+    }
+
+    contents = image_contents_new();
+
+    memcpy(contents->name, bam + bam_name, IMAGE_CONTENTS_NAME_LEN);
+    contents->name[IMAGE_CONTENTS_NAME_LEN] = 0;
+
+    memcpy(contents->id, bam + bam_id, IMAGE_CONTENTS_ID_LEN);
+    contents->id[IMAGE_CONTENTS_ID_LEN] = 0;
+
+    contents->blocks_free = direct_free_block_count(image, bam);
+
+    lp = NULL;
+    contents->file_list = NULL;
+
+    memset(visited, 0, sizeof(visited));
+
+    while (1) {
+        retval = direct_read_sector(image, buffer, curr_track, curr_sector);
+
+        if (retval == DIRECT_SECTOR_UNSUPPORTED) {
+            image_contents_destroy(contents);
+            return NULL;
+        }
+
+        /* stop on read errors and circular directories */
+        index = direct_sector_index(image, curr_track, curr_sector);
+        if (retval != DIRECT_SECTOR_OK || index < 0 || index >= DIRECT_MAX_BLOCKS
+            || (visited[index >> 3] & (1 << (index & 7)))) {
+            break;
+        }
+        visited[index >> 3] |= (uint8_t)(1 << (index & 7));
+
+        lp = diskcontents_block_add_entries(contents, lp, buffer);
+
+        if (buffer[0] == 0) {
+            break;
+        }
+
+        curr_track = (unsigned int)buffer[0];
+        curr_sector = (unsigned int)buffer[1];
+    }
+
+    return contents;
+}
+
+/* ------------------------------------------------------------------------- */
+
+image_contents_t *diskcontents_direct_read(const char *file_name)
+{
+    direct_image_t image;
+    image_contents_t *contents = NULL;
+
+    memset(&image, 0, sizeof(image));
+
+    image.fd = zfile_fopen(file_name, MODE_READ);
+    if (image.fd == NULL) {
+        return NULL;
+    }
+
+    if (direct_probe(&image, file_name) == 0) {
+        contents = direct_read(&image);
+    }
+
+    lib_free(image.dir_track.data);
+    zfile_fclose(image.fd);
+    return contents;
+}
@@ -0,0 +1,34 @@
+/*
+ * diskcontents-direct.h - Read directory straight from a disk image file.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_DISKCONTENTS_DIRECT_H
+#define VICE_DISKCONTENTS_DIRECT_H
+
+struct image_contents_s;
+
+/* Returns NULL if the image is not a D64, D71, D81, D80, D82 or G64 image
+   the direct reader can handle; the caller should then fall back to
+   `diskcontents_block_read()'.  */
+extern struct image_contents_s *diskcontents_direct_read(const char *file_name);
+
+#endif
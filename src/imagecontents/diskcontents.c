@@ -31,6 +31,7 @@
 #include <stdio.h>
 
 #include "diskcontents-block.h"
+#include "diskcontents-direct.h"
 #include "diskcontents-iec.h"
 #include "diskcontents.h"
 #include "imagecontents.h"
@@ -56,6 +57,14 @@ image_contents_t *diskcontents_read(const char *file_name, unsigned int unit)
 
 image_contents_t *diskcontents_filesystem_read(const char *file_name)
 {
+    image_contents_t *contents;
+
+    /* Try the direct reader first, it does not need to attach the image. */
+    contents = diskcontents_direct_read(file_name);
+    if (contents != NULL) {
+        return contents;
+    }
+
     return diskcontents_block_read(vdrive_internal_open_fsimage(file_name, 1));
 }
 
@@ -48,6 +48,7 @@
 #include "tape.h"
 #include "util.h"
 #include "vicefeatures.h"
+#include "vsyncapi.h"
 
 #ifdef DEBUG_CMDLINE
 #define DBG(x)  printf x
@@ -137,6 +138,44 @@ static int cmdline_limitcycles(const char *param, void *extra_param)
     return 0;
 }
 
+/* Compare reading an integer resource by name with reading it through a
+   handle, and log the time per access.  */
+static int cmdline_resourcesbenchmark(const char *param, void *extra_param)
+{
+    const int iterations = 1000000;
+    resource_handle_t handle;
+    unsigned long start, by_name, by_handle;
+    double freq;
+    int value, sum = 0, i;
+
+    handle = resources_get_handle(param);
+    if (handle == RESOURCE_HANDLE_NONE || resources_handle_get_int(handle, &value) < 0) {
+        return -1;
+    }
+
+    start = vsyncarch_gettime();
+    for (i = 0; i < iterations; i++) {
+        resources_get_int(param, &value);
+        sum += value;
+    }
+    by_name = vsyncarch_gettime() - start;
+
+    start = vsyncarch_gettime();
+    for (i = 0; i < iterations; i++) {
+        resources_handle_get_int(handle, &value);
+        sum += value;
+    }
+    by_handle = vsyncarch_gettime() - start;
+
+    freq = (double)vsyncarch_frequency();
+    log_message(LOG_DEFAULT, "Resource `%s': %.1f ns per read by name, %.1f ns by handle (checksum %d).",
+                param,
+                (double)by_name * 1000000000.0 / freq / iterations,
+                (double)by_handle * 1000000000.0 / freq / iterations,
+                sum);
+    return 0;
+}
+
 static int cmdline_autostart(const char *param, void *extra_param)
 {
     cmdline_free_autostart_string();
@@ -218,6 +257,9 @@ static const cmdline_option_t common_cmdline_options[] =
     { "-console", CALL_FUNCTION, CMDLINE_ATTRIB_NONE,
       cmdline_console, NULL, NULL, NULL,
       NULL, "Console mode (for music playback)" },
+    { "-resourcesbenchmark", CALL_FUNCTION, CMDLINE_ATTRIB_NEED_ARGS,
+      cmdline_resourcesbenchmark, NULL, NULL, NULL,
+      "<name>", "Log the time needed to read integer resource <name> by name and by handle" },
     { "-core", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
       NULL, NULL, "DoCoreDump", (resource_value_t)1,
       NULL, "Allow production of core dumps" },
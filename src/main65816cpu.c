@@ -44,6 +44,7 @@
 #include "snapshot.h"
 #include "traps.h"
 #include "types.h"
+#include "vsync.h"
 #include "wdc65816.h"
 
 #ifndef EXIT_FAILURE
@@ -162,6 +163,7 @@ monitor_interface_t *maincpu_monitor_interface_get(void)
     maincpu_monitor_interface->mem_bank_read = mem_bank_read;
     maincpu_monitor_interface->mem_bank_peek = mem_bank_peek;
     maincpu_monitor_interface->mem_bank_write = mem_bank_write;
+    maincpu_monitor_interface->mem_bank_base = mem_bank_base;
 
     maincpu_monitor_interface->mem_ioreg_list_get = mem_ioreg_list_get;
 
@@ -345,6 +347,9 @@ void maincpu_mainloop(void)
 
         if (maincpu_clk_limit && (maincpu_clk > maincpu_clk_limit)) {
             log_error(LOG_DEFAULT, "cycle limit reached.");
+            /* The 65816 runs at 20 MHz in turbo mode.  */
+            log_message(LOG_DEFAULT, "Benchmark: %.2f MHz of 65816 time in turbo mode.",
+                        vsync_log_benchmark() * 20.0);
             archdep_vice_exit(EXIT_FAILURE);
         }
 #if 0
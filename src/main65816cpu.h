@@ -39,6 +39,9 @@ extern struct WDC65816_regs_s maincpu_regs;
 
 extern CLOCK maincpu_clk;
 
+/* Program counter within the program bank, used by the memory heatmap.  */
+extern unsigned int reg_pc;
+
 /* ------------------------------------------------------------------------- */
 
 struct alarm_context_s;
@@ -51,6 +51,7 @@
 #include "snapshot.h"
 #include "traps.h"
 #include "types.h"
+#include "vsync.h"
 
 #ifndef EXIT_FAILURE
 #define EXIT_FAILURE 1
@@ -420,6 +421,7 @@ monitor_interface_t *maincpu_monitor_interface_get(void)
     maincpu_monitor_interface->mem_bank_read = mem_bank_read;
     maincpu_monitor_interface->mem_bank_peek = mem_bank_peek;
     maincpu_monitor_interface->mem_bank_write = mem_bank_write;
+    maincpu_monitor_interface->mem_bank_base = mem_bank_base;
 
     maincpu_monitor_interface->mem_ioreg_list_get = mem_ioreg_list_get;
 
@@ -629,6 +631,7 @@ void maincpu_mainloop(void)
 
         if (maincpu_clk_limit && (maincpu_clk > maincpu_clk_limit)) {
             log_error(LOG_DEFAULT, "cycle limit reached.");
+            vsync_log_benchmark();
             archdep_vice_exit(EXIT_FAILURE);
         }
 #if 0
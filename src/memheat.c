@@ -0,0 +1,401 @@
+/*
+ * memheat.c - Per-page memory access heatmap.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Unlike the CPU memory history (FEATURE_CPUMEMHISTORY), which hooks every
+   single memory access of the CPU core, the heatmap is recorded by handlers
+   that the machine memory code only installs in the read/write tables for
+   the pages selected by the user.  All other pages keep their normal
+   handlers and bank base pointers, and with the heatmap disabled nothing is
+   installed at all.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "cmdline.h"
+#include "lib.h"
+#include "log.h"
+#include "memheat.h"
+#include "resources.h"
+#include "util.h"
+
+#define MEMHEAT_SIZE    0x10000
+#define MEMHEAT_PAGES   0x100
+
+/* One bit per address and access type.  */
+static uint8_t memheat_bits[3][MEMHEAT_SIZE >> 3];
+
+/* Access counters, only allocated for selected pages.  */
+static uint32_t *memheat_counts[MEMHEAT_PAGES];
+
+/* One bit per selected page.  */
+static uint8_t memheat_selection[MEMHEAT_PAGES >> 3];
+
+static int memheat_enabled = 0;
+static char *memheat_pages = NULL;
+
+static void (*memheat_update_callback)(void) = NULL;
+
+/* ------------------------------------------------------------------------- */
+
+/* Parse a page list like "00-0f,c0,d0-df" (hex page numbers) into the
+   selection bitmap.  */
+static int memheat_parse_pages(const char *list, uint8_t *selection)
+{
+    const char *p = list;
+    char *end;
+    unsigned long first, last, i;
+
+    memset(selection, 0, MEMHEAT_PAGES >> 3);
+
+    if (p == NULL) {
+        return 0;
+    }
+
+    while (*p != 0) {
+        while (*p == ' ' || *p == ',') {
+            p++;
+        }
+        if (*p == 0) {
+            break;
+        }
+        first = strtoul(p, &end, 16);
+        if (end == p || first >= MEMHEAT_PAGES) {
+            return -1;
+        }
+        p = end;
+        last = first;
+        if (*p == '-') {
+            p++;
+            last = strtoul(p, &end, 16);
+            if (end == p || last >= MEMHEAT_PAGES || last < first) {
+                return -1;
+            }
+            p = end;
+        }
+        if (*p != 0 && *p != ',' && *p != ' ') {
+            return -1;
+        }
+        for (i = first; i <= last; i++) {
+            selection[i >> 3] |= (uint8_t)(1 << (i & 7));
+        }
+    }
+    return 0;
+}
+
+static void memheat_alloc_counts(void)
+{
+    unsigned int page;
+
+    for (page = 0; page < MEMHEAT_PAGES; page++) {
+        if (memheat_page_selected(page) && memheat_counts[page] == NULL) {
+            memheat_counts[page] = lib_calloc(0x100, sizeof(uint32_t));
+        }
+    }
+}
+
+static void memheat_update(void)
+{
+    if (memheat_enabled) {
+        memheat_alloc_counts();
+    }
+    if (memheat_update_callback != NULL) {
+        memheat_update_callback();
+    }
+}
+
+static int set_memheat_enabled(int val, void *param)
+{
+    memheat_enabled = val ? 1 : 0;
+    memheat_update();
+    return 0;
+}
+
+static int set_memheat_pages(const char *val, void *param)
+{
+    uint8_t selection[MEMHEAT_PAGES >> 3];
+
+    if (memheat_parse_pages(val, selection) < 0) {
+        return -1;
+    }
+
+    util_string_set(&memheat_pages, val);
+    memcpy(memheat_selection, selection, sizeof(selection));
+    memheat_update();
+    return 0;
+}
+
+static const resource_string_t resources_string[] = {
+    { "MemHeatmapPages", "", RES_EVENT_NO, NULL,
+      &memheat_pages, set_memheat_pages, NULL },
+    RESOURCE_STRING_LIST_END
+};
+
+static const resource_int_t resources_int[] = {
+    { "MemHeatmap", 0, RES_EVENT_NO, NULL,
+      &memheat_enabled, set_memheat_enabled, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+int memheat_resources_init(void)
+{
+    if (resources_register_string(resources_string) < 0) {
+        return -1;
+    }
+    return resources_register_int(resources_int);
+}
+
+void memheat_resources_shutdown(void)
+{
+    unsigned int page;
+
+    for (page = 0; page < MEMHEAT_PAGES; page++) {
+        lib_free(memheat_counts[page]);
+        memheat_counts[page] = NULL;
+    }
+    lib_free(memheat_pages);
+    memheat_pages = NULL;
+}
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-memheatmap", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "MemHeatmap", (resource_value_t)1,
+      NULL, "Enable the memory access heatmap" },
+    { "+memheatmap", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "MemHeatmap", (resource_value_t)0,
+      NULL, "Disable the memory access heatmap" },
+    { "-memheatmappages", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "MemHeatmapPages", NULL,
+      "<pages>", "Pages to record in the memory access heatmap (e.g. \"00-0f,c0-cf\")" },
+    CMDLINE_LIST_END
+};
+
+int memheat_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void memheat_set_update_callback(void (*callback)(void))
+{
+    memheat_update_callback = callback;
+}
+
+int memheat_active(void)
+{
+    return memheat_enabled;
+}
+
+int memheat_page_selected(unsigned int page)
+{
+    return (memheat_selection[(page >> 3) & 0x1f] >> (page & 7)) & 1;
+}
+
+void memheat_record(unsigned int addr, unsigned int type)
+{
+    uint32_t *counts;
+    uint8_t mask;
+
+    addr &= 0xffff;
+    mask = (uint8_t)(1 << (addr & 7));
+
+    if (type & MEMHEAT_EXEC) {
+        memheat_bits[2][addr >> 3] |= mask;
+    } else if (type & MEMHEAT_WRITE) {
+        memheat_bits[1][addr >> 3] |= mask;
+    } else {
+        memheat_bits[0][addr >> 3] |= mask;
+    }
+
+    counts = memheat_counts[addr >> 8];
+    if (counts != NULL && counts[addr & 0xff] != 0xffffffff) {
+        counts[addr & 0xff]++;
+    }
+}
+
+/* Opcodes on selected pages must be fetched through the read handlers, so
+   keep the fast opcode fetch off those pages and out of ranges that run
+   into them.  */
+void memheat_clip_limits(unsigned int addr, uint8_t **base, int *start, int *limit)
+{
+    unsigned int page = (addr >> 8) & 0xff;
+    unsigned int lo, hi;
+
+    if (memheat_page_selected(page)) {
+        *base = NULL;
+        *start = 0;
+        *limit = 0;
+        return;
+    }
+
+    for (lo = page; lo > 0 && !memheat_page_selected(lo - 1); lo--) {
+    }
+    for (hi = page + 1; hi < 0x100 && !memheat_page_selected(hi); hi++) {
+    }
+
+    if (*start < (int)(lo << 8)) {
+        *start = (int)(lo << 8);
+    }
+    if (hi < 0x100 && *limit > (int)(hi << 8) - 3) {
+        *limit = (int)(hi << 8) - 3;
+    }
+    if (*limit <= *start) {
+        *base = NULL;
+        *start = 0;
+        *limit = 0;
+    }
+}
+
+unsigned int memheat_get_flags(unsigned int addr)
+{
+    unsigned int flags = 0;
+    uint8_t mask;
+
+    addr &= 0xffff;
+    mask = (uint8_t)(1 << (addr & 7));
+
+    if (memheat_bits[0][addr >> 3] & mask) {
+        flags |= MEMHEAT_READ;
+    }
+    if (memheat_bits[1][addr >> 3] & mask) {
+        flags |= MEMHEAT_WRITE;
+    }
+    if (memheat_bits[2][addr >> 3] & mask) {
+        flags |= MEMHEAT_EXEC;
+    }
+    return flags;
+}
+
+uint32_t memheat_get_count(unsigned int addr)
+{
+    uint32_t *counts;
+
+    addr &= 0xffff;
+    counts = memheat_counts[addr >> 8];
+
+    return counts != NULL ? counts[addr & 0xff] : 0;
+}
+
+void memheat_clear(void)
+{
+    unsigned int page;
+
+    memset(memheat_bits, 0, sizeof(memheat_bits));
+    for (page = 0; page < MEMHEAT_PAGES; page++) {
+        if (memheat_counts[page] != NULL) {
+            memset(memheat_counts[page], 0, 0x100 * sizeof(uint32_t));
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Map an access count to a brightness, logarithmically so that a few hot
+   loops do not wash out everything else.  */
+static uint8_t memheat_intensity(uint32_t count)
+{
+    unsigned int level = 0;
+
+    if (count == 0) {
+        return 0x40;
+    }
+    while (count > 1 && level < 31) {
+        count >>= 1;
+        level++;
+    }
+    return (uint8_t)(0x60 + level * 6);
+}
+
+/* Write a 256x256 image, one pixel per address and one row per page: red
+   for writes, green for execution, blue for reads.  */
+static int memheat_save_ppm(FILE *fd)
+{
+    uint8_t line[0x100 * 3];
+    unsigned int addr, flags, x;
+    uint8_t level;
+
+    fprintf(fd, "P6\n256 256\n255\n");
+
+    for (addr = 0; addr < MEMHEAT_SIZE; addr += 0x100) {
+        for (x = 0; x < 0x100; x++) {
+            flags = memheat_get_flags(addr + x);
+            level = flags ? memheat_intensity(memheat_get_count(addr + x)) : 0;
+            line[x * 3 + 0] = (flags & MEMHEAT_WRITE) ? level : 0;
+            line[x * 3 + 1] = (flags & MEMHEAT_EXEC) ? level : 0;
+            line[x * 3 + 2] = (flags & MEMHEAT_READ) ? level : 0;
+        }
+        if (fwrite(line, 1, sizeof(line), fd) != sizeof(line)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Write one line per accessed address: address, flags and count.  */
+static int memheat_save_csv(FILE *fd)
+{
+    unsigned int addr, flags;
+
+    fprintf(fd, "addr,r,w,x,count\n");
+
+    for (addr = 0; addr < MEMHEAT_SIZE; addr++) {
+        flags = memheat_get_flags(addr);
+        if (flags == 0) {
+            continue;
+        }
+        if (fprintf(fd, "%04x,%d,%d,%d,%u\n", addr,
+                    (flags & MEMHEAT_READ) ? 1 : 0,
+                    (flags & MEMHEAT_WRITE) ? 1 : 0,
+                    (flags & MEMHEAT_EXEC) ? 1 : 0,
+                    (unsigned int)memheat_get_count(addr)) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int memheat_save(const char *filename, int format)
+{
+    FILE *fd;
+    int result;
+
+    fd = fopen(filename, MODE_WRITE);
+    if (fd == NULL) {
+        log_error(LOG_DEFAULT, "memheat: cannot open `%s' for writing.", filename);
+        return -1;
+    }
+
+    if (format == MEMHEAT_FORMAT_CSV) {
+        result = memheat_save_csv(fd);
+    } else {
+        result = memheat_save_ppm(fd);
+    }
+
+    fclose(fd);
+    return result;
+}
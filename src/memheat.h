@@ -0,0 +1,61 @@
+/*
+ * memheat.h - Per-page memory access heatmap.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_MEMHEAT_H
+#define VICE_MEMHEAT_H
+
+#include "types.h"
+
+/* Access types, as passed to `memheat_record()'.  */
+#define MEMHEAT_READ    0x01
+#define MEMHEAT_WRITE   0x02
+#define MEMHEAT_EXEC    0x04
+
+/* Export formats for `memheat_save()', also the format numbers of the
+   monitor's memmapsave command.  */
+#define MEMHEAT_FORMAT_PPM  0
+#define MEMHEAT_FORMAT_CSV  1
+
+extern int memheat_resources_init(void);
+extern void memheat_resources_shutdown(void);
+extern int memheat_cmdline_options_init(void);
+
+/* The machine memory code registers a callback that (un)installs the
+   recording handlers whenever the enable state or page selection changes.  */
+extern void memheat_set_update_callback(void (*callback)(void));
+
+extern int memheat_active(void);
+extern int memheat_page_selected(unsigned int page);
+
+extern void memheat_record(unsigned int addr, unsigned int type);
+
+/* Narrow the fast opcode fetch range returned by `mem_mmu_translate()' so
+   that it stays off the selected pages.  */
+extern void memheat_clip_limits(unsigned int addr, uint8_t **base, int *start, int *limit);
+
+extern unsigned int memheat_get_flags(unsigned int addr);
+extern uint32_t memheat_get_count(unsigned int addr);
+extern void memheat_clear(void);
+extern int memheat_save(const char *filename, int format);
+
+#endif
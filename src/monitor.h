@@ -116,6 +116,10 @@ struct monitor_interface_s {
     uint8_t (*mem_bank_peek)(int bank, uint16_t addr, void *context);
     void (*mem_bank_write)(int bank, uint16_t addr, uint8_t byte, void *context);
 
+    /* Pointer to `addr' in `bank' if the rest of its page can be read
+       directly, NULL otherwise.  Optional, speeds up block reads.  */
+    uint8_t *(*mem_bank_base)(int bank, uint16_t addr, void *context);
+
     struct mem_ioreg_list_s *(*mem_ioreg_list_get)(void *context);
 
     /* Pointer to a function to disable/enable watchpoint checking.  */
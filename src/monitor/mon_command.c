@@ -324,8 +324,13 @@ static const mon_cmds_t mon_cmd_array[] = {
 
     { "memmapsave", "mmsave",
       "\"<filename>\" <Format>",
+#ifdef FEATURE_CPUMEMHISTORY
       "Save the memmap as a picture. Format is:\n"
       "0 = BMP, 1 = PCX, 2 = PNG, 3 = GIF, 4 = IFF.",
+#else
+      "Save the memory access heatmap. Format is:\n"
+      "0 = PPM picture, 1 = CSV listing.",
+#endif
       FILENAME_ARG
     },
 
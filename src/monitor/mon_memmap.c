@@ -37,6 +37,7 @@
 
 #include "lib.h"
 #include "machine.h"
+#include "memheat.h"
 #include "mon_disassemble.h"
 #include "mon_memmap.h"
 #include "monitor.h"
@@ -310,12 +311,26 @@ void mon_memmap_shutdown(void)
 
 #else /* !FEATURE_CPUMEMHISTORY */
 
+/* Without the CPU memory history the memory map commands fall back to the
+   heatmap (see memheat.c), which only records the selected pages.  */
+
+#define BAD_ADDR (new_addr(e_invalid_space, 0))
+
 /* stubs */
 static void mon_memmap_stub(void)
 {
     mon_out("Disabled. configure with --enable-cpuhistory and recompile.\n");
 }
 
+static int mon_memmap_heat_check(void)
+{
+    if (!memheat_active()) {
+        mon_out("Disabled. Set MemHeatmap and MemHeatmapPages to record the selected pages.\n");
+        return -1;
+    }
+    return 0;
+}
+
 void mon_cpuhistory(int count)
 {
     mon_memmap_stub();
@@ -323,17 +338,67 @@ void mon_cpuhistory(int count)
 
 void mon_memmap_zap(void)
 {
-    mon_memmap_stub();
+    memheat_clear();
 }
 
 void mon_memmap_show(int mask, MON_ADDR start_addr, MON_ADDR end_addr)
 {
-    mon_memmap_stub();
+    unsigned int addr, start, end, flags, type = 0;
+
+    if (mon_memmap_heat_check() < 0) {
+        return;
+    }
+
+    start = (start_addr == BAD_ADDR) ? 0 : addr_location(start_addr);
+    end = (end_addr == BAD_ADDR) ? 0xffff : addr_location(end_addr);
+
+    if (start > end) {
+        start = end;
+    }
+
+    if (mask & (MEMMAP_I_O_R | MEMMAP_ROM_R | MEMMAP_RAM_R)) {
+        type |= MEMHEAT_READ;
+    }
+    if (mask & (MEMMAP_I_O_W | MEMMAP_ROM_W | MEMMAP_RAM_W)) {
+        type |= MEMHEAT_WRITE;
+    }
+    if (mask & (MEMMAP_I_O_X | MEMMAP_ROM_X | MEMMAP_RAM_X)) {
+        type |= MEMHEAT_EXEC;
+    }
+
+    mon_out("addr: rwx count\n");
+
+    for (addr = start; addr <= end; ++addr) {
+        flags = memheat_get_flags(addr);
+
+        if ((flags & type) == 0) {
+            continue;
+        }
+
+        mon_out("%04x: %c%c%c %u\n", addr,
+                (flags & MEMHEAT_READ) ? 'r' : '-',
+                (flags & MEMHEAT_WRITE) ? 'w' : '-',
+                (flags & MEMHEAT_EXEC) ? 'x' : '-',
+                (unsigned int)memheat_get_count(addr));
+    }
 }
 
+/* The heatmap is written as a PPM image or as a CSV listing, the picture
+   formats of the CPU history are not available.  */
 void mon_memmap_save(const char* filename, int format)
 {
-    mon_memmap_stub();
+    if (mon_memmap_heat_check() < 0) {
+        return;
+    }
+
+    if (format != MEMHEAT_FORMAT_PPM && format != MEMHEAT_FORMAT_CSV) {
+        mon_out("Unsupported format %d, use 0 (PPM) or 1 (CSV).\n", format);
+        return;
+    }
+
+    if (memheat_save(filename, format) < 0) {
+        mon_out("Failed.\n");
+    }
 }
 
 void mon_memmap_init(void)
@@ -46,9 +46,8 @@
 
 void mon_memory_move(MON_ADDR start_addr, MON_ADDR end_addr, MON_ADDR dest)
 {
-    unsigned int i, dst;
+    unsigned int start, dst;
     int len;
-    uint16_t start;
     MEMSPACE src_mem, dest_mem;
     uint8_t *buf;
 
@@ -66,23 +65,17 @@ void mon_memory_move(MON_ADDR start_addr, MON_ADDR end_addr, MON_ADDR dest)
 
     buf = lib_malloc(sizeof(uint8_t) *len);
 
-    for (i = 0; (int)i < len; i++) {
-        buf[i] = mon_get_mem_val(src_mem, (uint16_t)ADDR_LIMIT(start + i));
-    }
-
-    for (i = 0; (int)i < len; i++) {
-        mon_set_mem_val(dest_mem, (uint16_t)ADDR_LIMIT(dst + i), buf[i]);
-    }
+    mon_get_mem_block(src_mem, start, (unsigned int)len, buf);
+    mon_set_mem_block(dest_mem, dst, (unsigned int)len, buf);
 
     lib_free(buf);
 }
 
 void mon_memory_compare(MON_ADDR start_addr, MON_ADDR end_addr, MON_ADDR dest)
 {
-    uint16_t start;
     MEMSPACE src_mem, dest_mem;
-    uint8_t byte1, byte2;
-    unsigned int i, dst;
+    uint8_t *buf1, *buf2;
+    unsigned int i, start, dst;
     int len;
 
     len = mon_evaluate_address_range(&start_addr, &end_addr, TRUE, -1);
@@ -90,6 +83,9 @@ void mon_memory_compare(MON_ADDR start_addr, MON_ADDR end_addr, MON_ADDR dest)
         mon_out("Invalid range.\n");
         return;
     }
+    if (len == 0) {
+        return;
+    }
     src_mem = addr_memspace(start_addr);
     start = addr_location(start_addr);
 
@@ -97,23 +93,29 @@ void mon_memory_compare(MON_ADDR start_addr, MON_ADDR end_addr, MON_ADDR dest)
     dst = addr_location(dest);
     dest_mem = addr_memspace(dest);
 
-    for (i = 0; (int)i < len; i++) {
-        byte1 = mon_get_mem_val(src_mem, (uint16_t)ADDR_LIMIT(start + i));
-        byte2 = mon_get_mem_val(dest_mem, (uint16_t)ADDR_LIMIT(dst + i));
+    buf1 = lib_malloc(len);
+    buf2 = lib_malloc(len);
+
+    mon_get_mem_block(src_mem, start, (unsigned int)len, buf1);
+    mon_get_mem_block(dest_mem, dst, (unsigned int)len, buf2);
 
-        if (byte1 != byte2) {
+    for (i = 0; (int)i < len; i++) {
+        if (buf1[i] != buf2[i]) {
             mon_out("$%04x $%04x: %02x %02x\n",
-                    ADDR_LIMIT(start + i), ADDR_LIMIT(dst + i), byte1, byte2);
+                    addr_mask(start + i), addr_mask(dst + i), buf1[i], buf2[i]);
         }
     }
+
+    lib_free(buf1);
+    lib_free(buf2);
 }
 
 void mon_memory_fill(MON_ADDR start_addr, MON_ADDR end_addr,
                      unsigned char *data)
 {
-    uint16_t start;
     MEMSPACE dest_mem;
-    unsigned int i, mon_index;
+    uint8_t *buf;
+    unsigned int i, start;
     int len;
 
     len = mon_evaluate_address_range(&start_addr, &end_addr, FALSE,
@@ -131,28 +133,85 @@ void mon_memory_fill(MON_ADDR start_addr, MON_ADDR end_addr,
 
     dest_mem = addr_memspace(start_addr);
 
-    i = 0;
-    mon_index = 0;
-    while ((int)i < len) {
-        mon_set_mem_val(dest_mem, (uint16_t)ADDR_LIMIT(start + i),
-                        data_buf[mon_index++]);
-        if (mon_index >= data_buf_len) {
-            mon_index = 0;
+    if (len > 0 && data_buf_len > 0) {
+        /* Expand the pattern once and write it out as a block, doubling the
+           copied part each round.  */
+        buf = lib_malloc(len);
+        i = (data_buf_len < (unsigned int)len) ? data_buf_len : (unsigned int)len;
+        memcpy(buf, data_buf, i);
+        while ((int)i < len) {
+            unsigned int n = ((int)(i * 2) <= len) ? i : (unsigned int)len - i;
+            memcpy(buf + i, buf, n);
+            i += n;
         }
-        i++;
+        mon_set_mem_block(dest_mem, start, (unsigned int)len, buf);
+        lib_free(buf);
     }
 
     mon_clear_buffer();
 }
 
+/* Return the offset of the first match of the `data_buf_len' bytes long
+   pattern in `data_buf' (under `data_mask_buf') within `buf', or -1.  An
+   unmasked byte of the pattern is used as anchor for memchr(), which is
+   vectorised in the C library, so only real candidates are compared.  */
+static long memory_find(const uint8_t *buf, long len, int anchor, int exact)
+{
+    const uint8_t *p, *end;
+    unsigned int j;
+
+    if (len < (long)data_buf_len) {
+        return -1;
+    }
+
+    if (anchor < 0) {
+        /* Wildcards only.  */
+        for (p = buf; p <= buf + len - data_buf_len; p++) {
+            for (j = 0; j < data_buf_len; j++) {
+                if ((p[j] & data_mask_buf[j]) != data_buf[j]) {
+                    break;
+                }
+            }
+            if (j == data_buf_len) {
+                return (long)(p - buf);
+            }
+        }
+        return -1;
+    }
+
+    p = buf + anchor;
+    end = buf + len - data_buf_len + anchor + 1;
+
+    while (p < end && (p = memchr(p, data_buf[anchor], (size_t)(end - p))) != NULL) {
+        const uint8_t *c = p - anchor;
+
+        if (exact) {
+            if (memcmp(c, data_buf, data_buf_len) == 0) {
+                return (long)(c - buf);
+            }
+        } else {
+            for (j = 0; j < data_buf_len; j++) {
+                if ((c[j] & data_mask_buf[j]) != data_buf[j]) {
+                    break;
+                }
+            }
+            if (j == data_buf_len) {
+                return (long)(c - buf);
+            }
+        }
+        p++;
+    }
+    return -1;
+}
+
 void mon_memory_hunt(MON_ADDR start_addr, MON_ADDR end_addr,
                      unsigned char *data)
 {
     uint8_t *buf;
-    uint16_t start, next_read;
     MEMSPACE mem;
-    unsigned int i;
-    int len;
+    unsigned int j, start;
+    int len, anchor = -1, exact = 1;
+    long pos, found;
 
     len = mon_evaluate_address_range(&start_addr, &end_addr, TRUE, -1);
     if (len < 0 || len < (int)(data_buf_len)) {
@@ -162,37 +221,28 @@ void mon_memory_hunt(MON_ADDR start_addr, MON_ADDR end_addr,
     mem = addr_memspace(start_addr);
     start = addr_location(start_addr);
 
-    buf = lib_malloc(sizeof(uint8_t) * data_buf_len);
-
-    /* Fill buffer */
-    for (i = 0; i < data_buf_len; i++) {
-        buf[i] = mon_get_mem_val(mem, (uint16_t)ADDR_LIMIT(start + i));
+    for (j = 0; j < data_buf_len; j++) {
+        if (data_mask_buf[j] == 0xff) {
+            if (anchor < 0) {
+                anchor = (int)j;
+            }
+        } else {
+            exact = 0;
+        }
     }
 
-    /* Do compares */
-    next_read = start + (uint16_t)data_buf_len;
+    if (data_buf_len > 0) {
+        buf = lib_malloc(len);
+        mon_get_mem_block(mem, start, (unsigned int)len, buf);
 
-    for (i = 0; i <= (len - data_buf_len); i++, next_read++) {
-        int not_found = 0;
-        unsigned int j;
-        for (j = 0; j < data_buf_len; j++) {
-            if ((buf[j] & data_mask_buf[j]) != data_buf[j]) {
-                not_found = 1;
-                break;
-            }
-        }
-        if (!not_found) {
-            mon_out("%04x\n", ADDR_LIMIT(start + i));
+        for (pos = 0; (found = memory_find(buf + pos, len - pos, anchor, exact)) >= 0; pos += found + 1) {
+            mon_out("%04x\n", addr_mask(start + (unsigned int)(pos + found)));
         }
 
-        if (data_buf_len > 1) {
-            memmove(&(buf[0]), &(buf[1]), data_buf_len - 1);
-        }
-        buf[data_buf_len - 1] = mon_get_mem_val(mem, next_read);
+        lib_free(buf);
     }
 
     mon_clear_buffer();
-    lib_free(buf);
 }
 
 static const int radix_chars_per_byte[] = {
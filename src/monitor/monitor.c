@@ -80,6 +80,7 @@
 #include "monitor.h"
 #include "monitor_network.h"
 #include "montypes.h"
+#include "mos6510.h"
 #include "resources.h"
 #include "screenshot.h"
 #include "sysfile.h"
@@ -431,7 +432,7 @@ static bool is_valid_addr_range(MON_ADDR start_addr, MON_ADDR end_addr)
 
 static unsigned get_range_len(MON_ADDR addr1, MON_ADDR addr2)
 {
-    uint16_t start, end;
+    unsigned start, end;
     unsigned len = 0;
 
     start = addr_location(addr1);
@@ -440,7 +441,7 @@ static unsigned get_range_len(MON_ADDR addr1, MON_ADDR addr2)
     if (start <= end) {
         len = end - start + 1;
     } else {
-        len = (0xffff - start) + end + 1;
+        len = (addr_mask(0xffffffff) - start) + end + 1;
     }
 
     return len;
@@ -657,17 +658,63 @@ uint8_t mon_get_mem_val(MEMSPACE mem, uint16_t mem_addr)
     return mon_get_mem_val_ex(mem, mon_interfaces[mem]->current_bank, mem_addr);
 }
 
-void mon_get_mem_block_ex(MEMSPACE mem, int bank, uint16_t start, uint16_t end, uint8_t *data)
+/*
+    block versions of the above, reading `len' bytes from `start' on into
+    `data'. Addresses wrap around at the end of the monitor address space;
+    with 24 bit addresses the bits above the lower 16 select the following
+    banks, which is how ram00..ramff and reu00..reuff are numbered. Pages
+    the bank can hand out a pointer to are copied directly, the others go
+    through the peek or read handler, which is chosen once per block.
+*/
+void mon_get_mem_block_ex(MEMSPACE mem, int bank, unsigned int start, unsigned int len, uint8_t *data)
 {
-    int i;
-    for (i = 0; i <= end; i++) {
-        data[i] = mon_get_mem_val_ex(mem, bank, (uint16_t)(start + i));
+    monitor_interface_t *mi = mon_interfaces[mem];
+    uint8_t (*get)(int bank, uint16_t addr, void *context);
+    uint8_t *p;
+    unsigned int addr, i, n;
+    int b;
+
+    if (monitor_diskspace_dnr(mem) >= 0) {
+        if (!check_drive_emu_level_ok(monitor_diskspace_dnr(mem) + 8)) {
+            memset(data, 0, len);
+            return;
+        }
+    }
+
+    if ((sidefx == 0) && (mi->mem_bank_peek != NULL)) {
+        get = mi->mem_bank_peek;
+    } else {
+        get = mi->mem_bank_read;
+    }
+
+    while (len > 0) {
+        addr = addr_mask(start);
+        b = bank + (int)(addr >> 16);
+
+        /* up to the end of the page */
+        n = 0x100 - (addr & 0xff);
+        if (n > len) {
+            n = len;
+        }
+
+        p = (mi->mem_bank_base != NULL) ? mi->mem_bank_base(b, (uint16_t)addr, mi->context) : NULL;
+        if (p != NULL) {
+            memcpy(data, p, n);
+        } else {
+            for (i = 0; i < n; i++) {
+                data[i] = get(b, (uint16_t)(addr + i), mi->context);
+            }
+        }
+
+        data += n;
+        start += n;
+        len -= n;
     }
 }
 
-void mon_get_mem_block(MEMSPACE mem, uint16_t start, uint16_t end, uint8_t *data)
+void mon_get_mem_block(MEMSPACE mem, unsigned int start, unsigned int len, uint8_t *data)
 {
-    mon_get_mem_block_ex(mem, mon_interfaces[mem]->current_bank, start, end, data);
+    mon_get_mem_block_ex(mem, mon_interfaces[mem]->current_bank, start, len, data);
 }
 
 void mon_set_mem_val(MEMSPACE mem, uint16_t mem_addr, uint8_t val)
@@ -686,6 +733,27 @@ void mon_set_mem_val(MEMSPACE mem, uint16_t mem_addr, uint8_t val)
                                         mon_interfaces[mem]->context);
 }
 
+void mon_set_mem_block(MEMSPACE mem, unsigned int start, unsigned int len, const uint8_t *data)
+{
+    void (*set)(int bank, uint16_t addr, uint8_t byte, void *context);
+    void *context = mon_interfaces[mem]->context;
+    int bank = mon_interfaces[mem]->current_bank;
+    unsigned int addr, i;
+
+    if (monitor_diskspace_dnr(mem) >= 0) {
+        if (!check_drive_emu_level_ok(monitor_diskspace_dnr(mem) + 8)) {
+            return;
+        }
+    }
+
+    set = mon_interfaces[mem]->mem_bank_write;
+
+    for (i = 0; i < len; i++) {
+        addr = addr_mask(start + i);
+        set(bank + (int)(addr >> 16), (uint16_t)addr, data[i], context);
+    }
+}
+
 /* exit monitor  */
 void mon_jump(MON_ADDR addr)
 {
@@ -1943,6 +2011,293 @@ int mon_evaluate_conditional(cond_node_t *cnode)
 }
 
 
+/*
+    Conditions of checkpoints are compiled into a flat program for a small
+    stack machine when they are set, so a checkpoint hit in a hot loop does
+    not need to walk the tree. Registers of a 6502 compatible CPU are read
+    straight from its register struct and memory through the peek function
+    of the computer memspace. && and || short-circuit, which gives the same
+    results since none of the operands have side effects.
+*/
+
+enum cond_op_e {
+    COND_OP_CONST,      /* push value */
+    COND_OP_REG,        /* push register `value' of memspace `mem' */
+    COND_OP_REG8,       /* push 8 bit register at `ptr' */
+    COND_OP_REGPC,      /* push program counter at `ptr' */
+    COND_OP_MEM,        /* push byte at `addr' in bank `value' */
+    COND_OP_EQU,
+    COND_OP_NEQ,
+    COND_OP_GT,
+    COND_OP_LT,
+    COND_OP_GTE,
+    COND_OP_LTE,
+    COND_OP_JZ,         /* if top is 0 jump to `value', else pop */
+    COND_OP_JNZ,        /* if top is not 0 set it to 1 and jump, else pop */
+    COND_OP_BOOL        /* top = (top != 0) */
+};
+
+struct cond_insn_s {
+    int op;
+    int value;
+    uint16_t addr;
+    MEMSPACE mem;
+    const void *ptr;
+    monitor_cpu_type_t *cpu;    /* CPU `ptr' was resolved for */
+};
+typedef struct cond_insn_s cond_insn_t;
+
+struct cond_prog_s {
+    cond_insn_t *insn;
+    unsigned int len;
+    unsigned int size;
+    int *stack;
+    uint8_t (*peek)(int bank, uint16_t addr, void *context);
+    void *context;
+};
+
+static cond_insn_t *cond_prog_emit(cond_prog_t *prog, int op)
+{
+    cond_insn_t *insn;
+
+    if (prog->len == prog->size) {
+        prog->size = prog->size ? prog->size * 2 : 16;
+        prog->insn = lib_realloc(prog->insn, prog->size * sizeof(cond_insn_t));
+    }
+    insn = &prog->insn[prog->len++];
+    memset(insn, 0, sizeof(cond_insn_t));
+    insn->op = op;
+
+    return insn;
+}
+
+static void cond_prog_emit_reg(cond_prog_t *prog, MON_REG reg_num)
+{
+    MEMSPACE mem = reg_memspace(reg_num);
+    int reg_id = reg_regid(reg_num);
+    monitor_cpu_type_t *cpu = monitor_cpu_for_memspace[mem];
+    mos6510_regs_t *regs = mon_interfaces[mem]->cpu_regs;
+    cond_insn_t *insn;
+    const void *ptr = NULL;
+
+    /* Drive registers must go through the register interface, which checks
+       whether the drive CPU is emulated at all.  */
+    if (mem == e_comp_space && cpu->cpu_type == CPU_6502 && regs != NULL) {
+        switch (reg_id) {
+            case e_A:
+                ptr = &regs->a;
+                break;
+            case e_X:
+                ptr = &regs->x;
+                break;
+            case e_Y:
+                ptr = &regs->y;
+                break;
+            case e_SP:
+                ptr = &regs->sp;
+                break;
+            case e_PC:
+                ptr = &regs->pc;
+                break;
+        }
+    }
+
+    if (ptr == NULL) {
+        insn = cond_prog_emit(prog, COND_OP_REG);
+    } else {
+        insn = cond_prog_emit(prog, (reg_id == e_PC) ? COND_OP_REGPC : COND_OP_REG8);
+    }
+    insn->value = reg_id;
+    insn->mem = mem;
+    insn->ptr = ptr;
+    insn->cpu = cpu;
+}
+
+/* Emit code for `cnode', return the stack depth it needs or -1.  */
+static int cond_prog_compile(cond_prog_t *prog, cond_node_t *cnode)
+{
+    int depth1, depth2;
+    unsigned int jump = 0;
+
+    if (cnode->operation == e_INV) {
+        if (cnode->is_reg) {
+            cond_prog_emit_reg(prog, cnode->reg_num);
+        } else if (cnode->banknum >= 0) {
+            cond_insn_t *insn = cond_prog_emit(prog, COND_OP_MEM);
+            insn->value = cnode->banknum;
+            insn->addr = addr_location(cnode->value);
+        } else {
+            cond_prog_emit(prog, COND_OP_CONST)->value = cnode->value;
+        }
+        return 1;
+    }
+
+    if (!(cnode->child1 && cnode->child2)) {
+        return -1;
+    }
+
+    depth1 = cond_prog_compile(prog, cnode->child1);
+    if (depth1 < 0) {
+        return -1;
+    }
+
+    if (cnode->operation == e_AND || cnode->operation == e_OR) {
+        jump = prog->len;
+        cond_prog_emit(prog, (cnode->operation == e_AND) ? COND_OP_JZ : COND_OP_JNZ);
+    }
+
+    depth2 = cond_prog_compile(prog, cnode->child2);
+    if (depth2 < 0) {
+        return -1;
+    }
+
+    switch (cnode->operation) {
+        case e_EQU:
+            cond_prog_emit(prog, COND_OP_EQU);
+            break;
+        case e_NEQ:
+            cond_prog_emit(prog, COND_OP_NEQ);
+            break;
+        case e_GT:
+            cond_prog_emit(prog, COND_OP_GT);
+            break;
+        case e_LT:
+            cond_prog_emit(prog, COND_OP_LT);
+            break;
+        case e_GTE:
+            cond_prog_emit(prog, COND_OP_GTE);
+            break;
+        case e_LTE:
+            cond_prog_emit(prog, COND_OP_LTE);
+            break;
+        case e_AND:
+        case e_OR:
+            cond_prog_emit(prog, COND_OP_BOOL);
+            prog->insn[jump].value = (int)prog->len;
+            /* the second operand replaces the first on the stack */
+            return (depth1 > depth2) ? depth1 : depth2;
+        default:
+            log_error(LOG_ERR, "Unexpected conditional operator: %d\n",
+                      cnode->operation);
+            return -1;
+    }
+
+    return (depth1 > depth2 + 1) ? depth1 : depth2 + 1;
+}
+
+cond_prog_t *mon_compile_conditional(cond_node_t *cnode)
+{
+    cond_prog_t *prog;
+    int depth;
+
+    prog = lib_calloc(1, sizeof(cond_prog_t));
+    prog->peek = mon_interfaces[e_comp_space]->mem_bank_peek;
+    if (prog->peek == NULL) {
+        prog->peek = mon_interfaces[e_comp_space]->mem_bank_read;
+    }
+    prog->context = mon_interfaces[e_comp_space]->context;
+
+    depth = cond_prog_compile(prog, cnode);
+    if (depth < 0) {
+        mon_delete_compiled_conditional(prog);
+        return NULL;
+    }
+    prog->stack = lib_malloc(depth * sizeof(int));
+
+    return prog;
+}
+
+int mon_evaluate_compiled_conditional(cond_prog_t *prog)
+{
+    const cond_insn_t *insn = prog->insn;
+    const cond_insn_t *end = insn + prog->len;
+    int *sp = prog->stack;
+
+    while (insn < end) {
+        switch (insn->op) {
+            case COND_OP_CONST:
+                *sp++ = insn->value;
+                break;
+            case COND_OP_REG8:
+                if (monitor_cpu_for_memspace[insn->mem] == insn->cpu) {
+                    *sp++ = *(const uint8_t *)insn->ptr;
+                    break;
+                }
+                *sp++ = (monitor_cpu_for_memspace[insn->mem]->mon_register_get_val)(insn->mem, insn->value);
+                break;
+            case COND_OP_REGPC:
+                if (monitor_cpu_for_memspace[insn->mem] == insn->cpu) {
+                    *sp++ = (int)*(const unsigned int *)insn->ptr;
+                    break;
+                }
+                *sp++ = (monitor_cpu_for_memspace[insn->mem]->mon_register_get_val)(insn->mem, insn->value);
+                break;
+            case COND_OP_REG:
+                *sp++ = (monitor_cpu_for_memspace[insn->mem]->mon_register_get_val)(insn->mem, insn->value);
+                break;
+            case COND_OP_MEM:
+                *sp++ = prog->peek(insn->value, insn->addr, prog->context);
+                break;
+            case COND_OP_EQU:
+                sp--;
+                sp[-1] = (sp[-1] == sp[0]);
+                break;
+            case COND_OP_NEQ:
+                sp--;
+                sp[-1] = (sp[-1] != sp[0]);
+                break;
+            case COND_OP_GT:
+                sp--;
+                sp[-1] = (sp[-1] > sp[0]);
+                break;
+            case COND_OP_LT:
+                sp--;
+                sp[-1] = (sp[-1] < sp[0]);
+                break;
+            case COND_OP_GTE:
+                sp--;
+                sp[-1] = (sp[-1] >= sp[0]);
+                break;
+            case COND_OP_LTE:
+                sp--;
+                sp[-1] = (sp[-1] <= sp[0]);
+                break;
+            case COND_OP_JZ:
+                if (sp[-1] == 0) {
+                    insn = prog->insn + insn->value;
+                    continue;
+                }
+                sp--;
+                break;
+            case COND_OP_JNZ:
+                if (sp[-1] != 0) {
+                    sp[-1] = 1;
+                    insn = prog->insn + insn->value;
+                    continue;
+                }
+                sp--;
+                break;
+            case COND_OP_BOOL:
+                sp[-1] = (sp[-1] != 0);
+                break;
+        }
+        insn++;
+    }
+
+    return prog->stack[0];
+}
+
+void mon_delete_compiled_conditional(cond_prog_t *prog)
+{
+    if (!prog) {
+        return;
+    }
+
+    lib_free(prog->insn);
+    lib_free(prog->stack);
+    lib_free(prog);
+}
+
 void mon_delete_conditional(cond_node_t *cnode)
 {
     if (!cnode) {
@@ -155,6 +155,9 @@ struct cond_node_s {
 };
 typedef struct cond_node_s cond_node_t;
 
+/* Compiled form of a condition tree, see mon_compile_conditional().  */
+typedef struct cond_prog_s cond_prog_t;
+
 typedef void monitor_toggle_func_t(int value);
 
 /* Defines */
@@ -263,6 +266,7 @@ extern int mon_banknum_from_bank(MEMSPACE mem, const char *bankname);
 extern void mon_display_io_regs(MON_ADDR addr);
 extern void mon_evaluate_default_addr(MON_ADDR *a);
 extern void mon_set_mem_val(MEMSPACE mem, uint16_t mem_addr, uint8_t val);
+extern void mon_set_mem_block(MEMSPACE mem, unsigned int start, unsigned int len, const uint8_t *data);
 extern bool mon_inc_addr_location(MON_ADDR *a, unsigned inc);
 extern void mon_start_assemble_mode(MON_ADDR addr, char *asm_line);
 extern long mon_evaluate_address_range(MON_ADDR *start_addr, MON_ADDR *end_addr,
@@ -272,14 +276,17 @@ extern bool check_drive_emu_level_ok(int drive_num);
 extern void mon_print_conditional(cond_node_t *cnode);
 extern void mon_delete_conditional(cond_node_t *cnode);
 extern int mon_evaluate_conditional(cond_node_t *cnode);
+extern cond_prog_t *mon_compile_conditional(cond_node_t *cnode);
+extern int mon_evaluate_compiled_conditional(cond_prog_t *prog);
+extern void mon_delete_compiled_conditional(cond_prog_t *prog);
 extern bool mon_is_valid_addr(MON_ADDR a);
 extern bool mon_is_in_range(MON_ADDR start_addr, MON_ADDR end_addr,
                             unsigned loc);
 extern void mon_print_bin(int val, char on, char off);
 extern uint8_t mon_get_mem_val(MEMSPACE mem, uint16_t mem_addr);
 extern uint8_t mon_get_mem_val_ex(MEMSPACE mem, int bank, uint16_t mem_addr);
-extern void mon_get_mem_block(MEMSPACE mem, uint16_t mem_start, uint16_t mem_end, uint8_t *data);
-extern void mon_get_mem_block_ex(MEMSPACE mem, int bank, uint16_t mem_start, uint16_t mem_end, uint8_t *data);
+extern void mon_get_mem_block(MEMSPACE mem, unsigned int start, unsigned int len, uint8_t *data);
+extern void mon_get_mem_block_ex(MEMSPACE mem, int bank, unsigned int start, unsigned int len, uint8_t *data);
 extern void mon_jump(MON_ADDR addr);
 extern void mon_go(void);
 extern void mon_exit(void);
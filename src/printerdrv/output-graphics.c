@@ -41,7 +41,34 @@
 #include "resources.h"
 #include "screenshot.h"
 #include "types.h"
+#include "vsyncapi.h"
 
+/*
+ * Printed lines are collected in bands.  A complete band is handed to the
+ * encoder, which converts the lines and writes them through the gfxoutput
+ * driver.  With SDL available the encoder runs on its own thread, so the
+ * emulation does not stall while a long printout is written; otherwise
+ * bands are encoded right away.  At most OUTPUT_GFX_BANDS bands exist, the
+ * emulation waits for the encoder when all of them are in use.
+ */
+#if defined(USE_SDL_AUDIO) || defined(USE_SDLUI) || defined(USE_SDLUI2)
+#define OUTPUT_GFX_THREAD
+#include "vice_sdl.h"
+#endif
+
+#define OUTPUT_GFX_BAND_LINES 32
+#define OUTPUT_GFX_BANDS 8
+
+struct output_band_s {
+    unsigned int prnr;
+    char *open_filename;    /* start a new page with this name first */
+    int close;              /* finish the page after these lines */
+    unsigned int lines;
+    unsigned int size;
+    uint8_t *pixels;
+    struct output_band_s *next;
+};
+typedef struct output_band_s output_band_t;
 
 struct output_gfx_s {
     gfxoutputdrv_t *gfxoutputdrv;
@@ -51,12 +78,37 @@ struct output_gfx_s {
     unsigned int isopen;
     unsigned int line_pos;
     unsigned int line_no;
+    output_band_t *band;
+
+    /* used by the encoder only */
+    int page_open;
+    unsigned int page_lines;
+
+    /* statistics */
+    unsigned int pages;
+    unsigned long encode_time;
+    unsigned long max_wait;
 };
 typedef struct output_gfx_s output_gfx_t;
 
 static output_gfx_t output_gfx[NUM_OUTPUT_SELECT];
 
-static unsigned int current_prnr;
+static output_band_t output_bands[OUTPUT_GFX_BANDS];
+static output_band_t *free_bands = NULL;
+static output_band_t *queued_head = NULL;
+static output_band_t *queued_tail = NULL;
+
+/* line currently converted by the encoder */
+static const uint8_t *convert_line_base;
+
+#ifdef OUTPUT_GFX_THREAD
+static SDL_Thread *encoder_thread = NULL;
+static SDL_mutex *encoder_lock = NULL;
+static SDL_cond *band_queued = NULL;
+static SDL_cond *band_freed = NULL;
+static int encoder_busy = 0;
+static int encoder_quit = 0;
+#endif
 
 /* ------------------------------------------------------------------------- */
 
@@ -85,10 +137,10 @@ static void output_graphics_line_data(screenshot_t *screenshot, uint8_t *data,
                                       unsigned int line, unsigned int mode)
 {
     unsigned int i;
-    uint8_t *line_base;
+    const uint8_t *line_base;
     unsigned int color;
 
-    line_base = output_gfx[current_prnr].line;
+    line_base = convert_line_base;
 
     switch (mode) {
         case SCREENSHOT_MODE_PALETTE:
@@ -110,6 +162,283 @@ static void output_graphics_line_data(screenshot_t *screenshot, uint8_t *data,
     }
 }
 
+/* ------------------------------------------------------------------------- */
+/*    encoder                                                                */
+
+static void output_graphics_write_line(output_gfx_t *o, const uint8_t *line)
+{
+    convert_line_base = line;
+    if ((o->gfxoutputdrv->write)(&o->screenshot) < 0) {
+        o->gfxoutputdrv->close(&o->screenshot);
+        o->page_open = 0;
+    }
+    o->page_lines++;
+}
+
+static void output_graphics_encode(output_band_t *band)
+{
+    output_gfx_t *o = &(output_gfx[band->prnr]);
+    unsigned int width = o->screenshot.width;
+    unsigned long start = vsyncarch_gettime();
+    unsigned int i;
+
+    if (band->open_filename != NULL) {
+        o->page_open = o->gfxoutputdrv->open(&o->screenshot, band->open_filename) >= 0;
+        o->page_lines = 0;
+        o->pages++;
+        lib_free(band->open_filename);
+        band->open_filename = NULL;
+    }
+
+    for (i = 0; i < band->lines && o->page_open; i++) {
+        output_graphics_write_line(o, band->pixels + i * width);
+    }
+
+    if (band->close && o->page_open) {
+        /* fill rest of page with blank lines */
+        memset(band->pixels, OUTPUT_PIXEL_WHITE, width);
+        while (o->page_lines < o->screenshot.height && o->page_open) {
+            output_graphics_write_line(o, band->pixels);
+        }
+
+        /* close output */
+        if (o->page_open) {
+            o->gfxoutputdrv->close(&o->screenshot);
+            o->page_open = 0;
+        }
+    }
+
+    o->encode_time += vsyncarch_gettime() - start;
+}
+
+#ifdef OUTPUT_GFX_THREAD
+static int output_graphics_encoder(void *unused)
+{
+    output_band_t *band;
+
+    SDL_LockMutex(encoder_lock);
+    while (1) {
+        while (queued_head == NULL && !encoder_quit) {
+            SDL_CondWait(band_queued, encoder_lock);
+        }
+        if (queued_head == NULL) {
+            break;
+        }
+
+        band = queued_head;
+        queued_head = band->next;
+        if (queued_head == NULL) {
+            queued_tail = NULL;
+        }
+        encoder_busy = 1;
+        SDL_UnlockMutex(encoder_lock);
+
+        output_graphics_encode(band);
+
+        SDL_LockMutex(encoder_lock);
+        band->next = free_bands;
+        free_bands = band;
+        encoder_busy = 0;
+        SDL_CondBroadcast(band_freed);
+    }
+    SDL_UnlockMutex(encoder_lock);
+
+    return 0;
+}
+
+static int output_graphics_encoder_start(void)
+{
+    if (encoder_thread != NULL) {
+        return 0;
+    }
+
+    encoder_lock = SDL_CreateMutex();
+    band_queued = SDL_CreateCond();
+    band_freed = SDL_CreateCond();
+    encoder_quit = 0;
+    if (encoder_lock != NULL && band_queued != NULL && band_freed != NULL) {
+        encoder_thread = SDL_CreateThread(output_graphics_encoder, "printer", NULL);
+    }
+
+    if (encoder_thread == NULL) {
+        log_error(LOG_DEFAULT, "Cannot start the printer output thread, encoding synchronously.");
+        if (encoder_lock != NULL) {
+            SDL_DestroyMutex(encoder_lock);
+            encoder_lock = NULL;
+        }
+        if (band_queued != NULL) {
+            SDL_DestroyCond(band_queued);
+            band_queued = NULL;
+        }
+        if (band_freed != NULL) {
+            SDL_DestroyCond(band_freed);
+            band_freed = NULL;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+static void output_graphics_encoder_stop(void)
+{
+    if (encoder_thread == NULL) {
+        return;
+    }
+
+    SDL_LockMutex(encoder_lock);
+    encoder_quit = 1;
+    SDL_CondSignal(band_queued);
+    SDL_UnlockMutex(encoder_lock);
+
+    SDL_WaitThread(encoder_thread, NULL);
+    encoder_thread = NULL;
+
+    SDL_DestroyMutex(encoder_lock);
+    SDL_DestroyCond(band_queued);
+    SDL_DestroyCond(band_freed);
+    encoder_lock = NULL;
+    band_queued = NULL;
+    band_freed = NULL;
+}
+#endif
+
+/* Waits until all queued bands are encoded.  */
+static void output_graphics_drain(void)
+{
+#ifdef OUTPUT_GFX_THREAD
+    if (encoder_thread != NULL) {
+        SDL_LockMutex(encoder_lock);
+        while (queued_head != NULL || encoder_busy) {
+            SDL_CondWait(band_freed, encoder_lock);
+        }
+        SDL_UnlockMutex(encoder_lock);
+    }
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/*    bands                                                                  */
+
+/* Gets an empty band for the printer, waiting for the encoder if all bands
+   are in use.  */
+static void output_graphics_band_get(unsigned int prnr)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+    output_band_t *band;
+    unsigned int size = OUTPUT_GFX_BAND_LINES * o->screenshot.width;
+
+#ifdef OUTPUT_GFX_THREAD
+    if (encoder_thread == NULL) {
+        output_graphics_encoder_start();
+    }
+    if (encoder_thread != NULL) {
+        unsigned long start = vsyncarch_gettime();
+        unsigned long wait;
+
+        SDL_LockMutex(encoder_lock);
+        while (free_bands == NULL) {
+            SDL_CondWait(band_freed, encoder_lock);
+        }
+        band = free_bands;
+        free_bands = band->next;
+        SDL_UnlockMutex(encoder_lock);
+
+        wait = vsyncarch_gettime() - start;
+        if (wait > o->max_wait) {
+            o->max_wait = wait;
+        }
+    } else
+#endif
+    {
+        band = free_bands;
+        free_bands = band->next;
+    }
+
+    if (band->size < size) {
+        band->pixels = lib_realloc(band->pixels, size);
+        band->size = size;
+    }
+    band->prnr = prnr;
+    band->open_filename = NULL;
+    band->close = 0;
+    band->lines = 0;
+    band->next = NULL;
+
+    o->band = band;
+    o->line = band->pixels;
+    memset(o->line, OUTPUT_PIXEL_WHITE, o->screenshot.width);
+}
+
+/* Hands the band of the printer to the encoder.  */
+static void output_graphics_band_submit(unsigned int prnr)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+    output_band_t *band = o->band;
+
+    o->band = NULL;
+    o->line = NULL;
+
+#ifdef OUTPUT_GFX_THREAD
+    if (encoder_thread != NULL) {
+        SDL_LockMutex(encoder_lock);
+        if (queued_tail != NULL) {
+            queued_tail->next = band;
+        } else {
+            queued_head = band;
+        }
+        queued_tail = band;
+        SDL_CondSignal(band_queued);
+        SDL_UnlockMutex(encoder_lock);
+        return;
+    }
+#endif
+
+    output_graphics_encode(band);
+    band->next = free_bands;
+    free_bands = band;
+}
+
+/* Returns the unused band of the printer.  */
+static void output_graphics_band_release(unsigned int prnr)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+
+    if (o->band != NULL) {
+#ifdef OUTPUT_GFX_THREAD
+        if (encoder_thread != NULL) {
+            SDL_LockMutex(encoder_lock);
+        }
+#endif
+        o->band->next = free_bands;
+        free_bands = o->band;
+#ifdef OUTPUT_GFX_THREAD
+        if (encoder_thread != NULL) {
+            SDL_CondBroadcast(band_freed);
+            SDL_UnlockMutex(encoder_lock);
+        }
+#endif
+        o->band = NULL;
+        o->line = NULL;
+    }
+}
+
+static void output_graphics_log_stats(unsigned int prnr)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+    unsigned long freq = vsyncarch_frequency();
+
+    if (o->pages > 0) {
+        log_message(LOG_DEFAULT,
+                    "Printer graphics output: %u page(s) encoded in %lu ms, emulation waited at most %lu us.",
+                    o->pages,
+                    (unsigned long)((double)o->encode_time * 1000 / freq),
+                    (unsigned long)((double)o->max_wait * 1000000 / freq));
+    }
+    o->pages = 0;
+    o->encode_time = 0;
+    o->max_wait = 0;
+}
+
 /* ------------------------------------------------------------------------- */
 
 static int output_graphics_open(unsigned int prnr,
@@ -117,6 +446,12 @@ static int output_graphics_open(unsigned int prnr,
 {
     const char *filename;
     int device = 0;
+
+    /* the previous page may still be encoded */
+    output_graphics_drain();
+    output_graphics_band_release(prnr);
+    output_graphics_log_stats(prnr);
+
     output_gfx[prnr].gfxoutputdrv = gfxoutput_get_driver("BMP");
 
     if (output_gfx[prnr].gfxoutputdrv == NULL) {
@@ -141,6 +476,7 @@ static int output_graphics_open(unsigned int prnr,
         filename = "prngfx";
     }
 
+    lib_free(output_gfx[prnr].filename);
     output_gfx[prnr].filename = lib_malloc(strlen(filename) + 3);
     sprintf(output_gfx[prnr].filename, "%s00", filename);
 
@@ -151,10 +487,6 @@ static int output_graphics_open(unsigned int prnr,
     output_gfx[prnr].screenshot.y_offset = 0;
     output_gfx[prnr].screenshot.palette = output_parameter->palette;
 
-    lib_free(output_gfx[prnr].line);
-    output_gfx[prnr].line = lib_malloc(output_parameter->maxcol);
-    memset(output_gfx[prnr].line, OUTPUT_PIXEL_WHITE, output_parameter->maxcol);
-
     output_gfx[prnr].line_pos = 0;
     output_gfx[prnr].line_no = 0;
 
@@ -170,21 +502,14 @@ static void output_graphics_close(unsigned int prnr)
 
     /* only do this if something has actually been printed on this page */
     if (o->isopen) {
-        unsigned int i;
-
-        /* output current line */
-        current_prnr = prnr;
-        (o->gfxoutputdrv->write)(&o->screenshot);
-        o->line_no++;
-
-        /* fill rest of page with blank lines */
-        memset(o->line, OUTPUT_PIXEL_WHITE, o->screenshot.width);
-        for (i = o->line_no; i < o->screenshot.height; i++) {
-            (o->gfxoutputdrv->write)(&o->screenshot);
+        /* the last band may just have been submitted with a full band */
+        if (o->band == NULL) {
+            output_graphics_band_get(prnr);
         }
-
-        /* close output */
-        o->gfxoutputdrv->close(&o->screenshot);
+        /* output current line, the encoder fills the rest of the page */
+        o->band->lines++;
+        o->band->close = 1;
+        output_graphics_band_submit(prnr);
         o->isopen = 0;
     }
 }
@@ -193,6 +518,10 @@ static int output_graphics_putc(unsigned int prnr, uint8_t b)
 {
     output_gfx_t *o = &(output_gfx[prnr]);
 
+    if (o->band == NULL) {
+        output_graphics_band_get(prnr);
+    }
+
     if (b == OUTPUT_NEWLINE) {
         /* if output is not open yet, open it now */
         if (!o->isopen) {
@@ -207,23 +536,27 @@ static int output_graphics_putc(unsigned int prnr, uint8_t b)
             }
 
             /* open output file */
-            o->gfxoutputdrv->open(&o->screenshot, o->filename);
+            o->band->open_filename = lib_stralloc(o->filename);
             o->isopen = 1;
             o->line_pos = 0;
             o->line_no = 0;
         }
 
-        /* write buffered line to output and clear buffer */
-        current_prnr = prnr;
-        (o->gfxoutputdrv->write)(&o->screenshot);
-        memset(o->line, OUTPUT_PIXEL_WHITE, o->screenshot.width);
+        /* add buffered line to the band and start a new one */
+        o->band->lines++;
         o->line_pos = 0;
 
         /* check for bottom of page.  If so, close output file */
         o->line_no++;
         if (o->line_no == o->screenshot.height) {
-            o->gfxoutputdrv->close(&o->screenshot);
+            o->band->close = 1;
             o->isopen = 0;
+            output_graphics_band_submit(prnr);
+        } else if (o->band->lines == OUTPUT_GFX_BAND_LINES) {
+            output_graphics_band_submit(prnr);
+        } else {
+            o->line = o->band->pixels + o->band->lines * o->screenshot.width;
+            memset(o->line, OUTPUT_PIXEL_WHITE, o->screenshot.width);
         }
     } else {
         /* store pixel in buffer */
@@ -258,6 +591,15 @@ void output_graphics_init(void)
         output_gfx[i].filename = NULL;
         output_gfx[i].line = NULL;
         output_gfx[i].line_pos = 0;
+        output_gfx[i].band = NULL;
+    }
+
+    free_bands = NULL;
+    for (i = 0; i < OUTPUT_GFX_BANDS; i++) {
+        output_bands[i].pixels = NULL;
+        output_bands[i].size = 0;
+        output_bands[i].next = free_bands;
+        free_bands = &output_bands[i];
     }
 }
 
@@ -265,9 +607,23 @@ void output_graphics_shutdown(void)
 {
     unsigned int i;
 
+    output_graphics_drain();
+#ifdef OUTPUT_GFX_THREAD
+    output_graphics_encoder_stop();
+#endif
+
     for (i = 0; i < 3; i++) {
+        output_graphics_log_stats(i);
         lib_free(output_gfx[i].filename);
-        lib_free(output_gfx[i].line);
+        output_gfx[i].filename = NULL;
+        output_gfx[i].band = NULL;
+        output_gfx[i].line = NULL;
+    }
+
+    for (i = 0; i < OUTPUT_GFX_BANDS; i++) {
+        lib_free(output_bands[i].pixels);
+        output_bands[i].pixels = NULL;
+        output_bands[i].size = 0;
     }
 }
 
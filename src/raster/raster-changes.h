@@ -60,16 +60,18 @@ union raster_changes_action_value_s {
 };
 typedef union raster_changes_action_value_s raster_changes_action_value_t;
 
+/* Keep this small: a line with dense raster effects walks hundreds of these.
+   The value comes first so that `where' and `type' pack into one word.  */
 struct raster_changes_action_s {
+    /* Pointer to where the value is stored and new value to assign.  */
+    raster_changes_action_value_t value;
+
     /* "Where" the change happens (eg. character position for foreground
        changes, pixel position for other changes).  */
-    int where;
+    int16_t where;
 
-    /* Data type for changed value.  */
-    raster_changes_type_t type;
-
-    /* Pointer to where the value is stored and new value to assign.  */
-    raster_changes_action_value_t value;
+    /* Data type for changed value (`raster_changes_type_t').  */
+    uint8_t type;
 };
 typedef struct raster_changes_action_s raster_changes_action_t;
 
@@ -106,7 +108,7 @@ inline static void raster_changes_apply(raster_changes_t *changes,
 
     action = changes->actions + idx;
 
-    switch (changes->actions[idx].type) {
+    switch (action->type) {
         case RASTER_CHANGES_TYPE_INT:
             *action->value.integer.oldp = action->value.integer.newone;
             break;
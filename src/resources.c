@@ -94,6 +94,9 @@ typedef struct resource_ram_s {
     /* callback function vector chain */
     struct resource_callback_desc_s *callback;
 
+    /* subscribers, only called when the value actually changed */
+    struct resource_callback_desc_s *subscribers;
+
     /* number of next entry in hash collision list */
     int hash_next;
 } resource_ram_t;
@@ -105,6 +108,11 @@ typedef struct resource_callback_desc_s {
     struct resource_callback_desc_s *next;
 } resource_callback_desc_t;
 
+/* value of a resource with subscribers before it is set */
+typedef struct resource_old_value_s {
+    int int_value;
+    char *string_value;
+} resource_old_value_t;
 
 static unsigned int num_resources, num_allocated_resources;
 static resource_ram_t *resources;
@@ -188,6 +196,58 @@ static void resources_issue_callback(resource_ram_t *res, int global_callback)
     }
 }
 
+/* remember the value of a resource before setting it, if anyone subscribed
+   to its changes */
+static void resources_remember_value(resource_ram_t *res,
+                                     resource_old_value_t *old)
+{
+    const char *value;
+
+    old->int_value = 0;
+    old->string_value = NULL;
+
+    if (res->subscribers == NULL) {
+        return;
+    }
+
+    switch (res->type) {
+        case RES_INTEGER:
+            old->int_value = *(int *)res->value_ptr;
+            break;
+        case RES_STRING:
+            value = *(const char **)res->value_ptr;
+            old->string_value = lib_stralloc(value != NULL ? value : "");
+            break;
+    }
+}
+
+/* notify the subscribers of a resource if its value differs from `old' */
+static void resources_notify_subscribers(resource_ram_t *res,
+                                         resource_old_value_t *old)
+{
+    const char *value;
+    int changed = 0;
+
+    if (res->subscribers != NULL) {
+        switch (res->type) {
+            case RES_INTEGER:
+                changed = (*(int *)res->value_ptr != old->int_value);
+                break;
+            case RES_STRING:
+                value = *(const char **)res->value_ptr;
+                changed = (old->string_value == NULL
+                           || strcmp(value != NULL ? value : "", old->string_value) != 0);
+                break;
+        }
+        if (changed) {
+            resources_exec_callback_chain(res->subscribers, res->name);
+        }
+    }
+
+    lib_free(old->string_value);
+    old->string_value = NULL;
+}
+
 
 #if 0
 /* for debugging (hash collisions, hash chains, ...) */
@@ -277,6 +337,7 @@ int resources_register_int(const resource_int_t *r)
         dp->set_func_int = sp->set_func;
         dp->param = sp->param;
         dp->callback = NULL;
+        dp->subscribers = NULL;
 
         hashkey = resources_calc_hash_key(sp->name);
         dp->hash_next = hashTable[hashkey];
@@ -329,6 +390,7 @@ int resources_register_string(const resource_string_t *r)
         dp->set_func_string = sp->set_func;
         dp->param = sp->param;
         dp->callback = NULL;
+        dp->subscribers = NULL;
 
         hashkey = resources_calc_hash_key(sp->name);
         dp->hash_next = hashTable[hashkey];
@@ -400,6 +462,38 @@ char *resources_write_item_to_string(const char *name, const char *delim)
     return NULL;
 }
 
+/* Return a string with the current values of all resources that affect the
+   emulation, i.e. all that are not registered with RES_EVENT_NO.  The string
+   must be freed with `lib_free()'.  */
+char *resources_write_event_relevant_to_string(const char *delim)
+{
+    unsigned int i;
+    size_t len = 0, size = 1024;
+    char *string, *line;
+
+    string = lib_malloc(size);
+    string[0] = '\0';
+
+    for (i = 0; i < num_resources; i++) {
+        if (resources[i].event_relevant == RES_EVENT_NO) {
+            continue;
+        }
+        line = string_resource_item((int)i, delim);
+        if (line == NULL) {
+            continue;
+        }
+        while (len + strlen(line) + 1 > size) {
+            size *= 2;
+            string = lib_realloc(string, size);
+        }
+        strcpy(string + len, line);
+        len += strlen(line);
+        lib_free(line);
+    }
+
+    return string;
+}
+
 static void resource_create_event_data(char **event_data, int *data_size,
                                        resource_ram_t *r,
                                        resource_value_t value)
@@ -464,6 +558,9 @@ static int resources_set_value_internal(resource_ram_t *r,
                                         resource_value_t value)
 {
     int status = 0;
+    resource_old_value_t old;
+
+    resources_remember_value(r, &old);
 
     switch (r->type) {
         case RES_INTEGER:
@@ -474,6 +571,8 @@ static int resources_set_value_internal(resource_ram_t *r,
             break;
     }
 
+    resources_notify_subscribers(r, &old);
+
     if (status != 0) {
         resources_issue_callback(r, 1);
     }
@@ -508,10 +607,13 @@ int resources_set_value(const char *name, resource_value_t value)
 static int resources_set_internal_int(resource_ram_t *r, int value)
 {
     int status = 0;
+    resource_old_value_t old;
 
     switch (r->type) {
         case RES_INTEGER:
+            resources_remember_value(r, &old);
             status = (*r->set_func_int)(value, r->param);
+            resources_notify_subscribers(r, &old);
             break;
         default:
             return -1;
@@ -528,10 +630,13 @@ static int resources_set_internal_string(resource_ram_t *r,
                                          const char *value)
 {
     int status = 0;
+    resource_old_value_t old;
 
     switch (r->type) {
         case RES_STRING:
+            resources_remember_value(r, &old);
             status = (*r->set_func_string)(value, r->param);
+            resources_notify_subscribers(r, &old);
             break;
         default:
             return -1;
@@ -642,6 +747,7 @@ int resources_set_value_string(const char *name, const char *value)
 {
     resource_ram_t *r = lookup(name);
     int status;
+    resource_old_value_t old;
 
     if (r == NULL) {
         log_warning(LOG_DEFAULT,
@@ -650,6 +756,8 @@ int resources_set_value_string(const char *name, const char *value)
         return -1;
     }
 
+    resources_remember_value(r, &old);
+
     switch (r->type) {
         case RES_INTEGER:
             {
@@ -674,6 +782,8 @@ int resources_set_value_string(const char *name, const char *value)
             break;
     }
 
+    resources_notify_subscribers(r, &old);
+
     if (status != 0) {
         resources_issue_callback(r, 1);
     }
@@ -847,25 +957,30 @@ int resources_get_default_value(const char *name, void *value_return)
 int resources_set_defaults(void)
 {
     unsigned int i;
+    int status = 0;
+    resource_old_value_t old;
 
     for (i = 0; i < num_resources; i++) {
+        resources_remember_value(resources + i, &old);
+
         switch (resources[i].type) {
             case RES_INTEGER:
-                if ((*resources[i].set_func_int)(vice_ptr_to_int(resources[i].factory_value),
-                                                 resources[i].param) < 0) {
-                    log_verbose("Cannot set resource %s", resources[i].name);
-                    return -1;
-                }
+                status = (*resources[i].set_func_int)(vice_ptr_to_int(resources[i].factory_value),
+                                                      resources[i].param);
                 break;
             case RES_STRING:
-                if ((*resources[i].set_func_string)((const char *)(resources[i].factory_value),
-                                                    resources[i].param) < 0) {
-                    log_verbose("Cannot set resource %s", resources[i].name);
-                    return -1;
-                }
+                status = (*resources[i].set_func_string)((const char *)(resources[i].factory_value),
+                                                         resources[i].param);
                 break;
         }
 
+        resources_notify_subscribers(resources + i, &old);
+
+        if (status < 0) {
+            log_verbose("Cannot set resource %s", resources[i].name);
+            return -1;
+        }
+
         resources_issue_callback(resources + i, 0);
     }
 
@@ -879,25 +994,27 @@ int resources_set_defaults(void)
 int resources_set_event_safe(void)
 {
     unsigned int i;
+    int status;
+    resource_old_value_t old;
 
     for (i = 0; i < num_resources; i++) {
-        switch (resources[i].type) {
-            case RES_INTEGER:
-                if (resources[i].event_relevant == RES_EVENT_STRICT) {
-                    if ((*resources[i].set_func_int)(vice_ptr_to_int(resources[i].event_strict_value),
-                                                     resources[i].param) < 0) {
-                        return -1;
-                    }
-                }
-                break;
-            case RES_STRING:
-                if (resources[i].event_relevant == RES_EVENT_STRICT) {
-                    if ((*resources[i].set_func_string)((const char *)(resources[i].event_strict_value),
-                                                        resources[i].param) < 0) {
-                        return -1;
-                    }
-                }
-                break;
+        if (resources[i].event_relevant == RES_EVENT_STRICT) {
+            resources_remember_value(resources + i, &old);
+            status = 0;
+            switch (resources[i].type) {
+                case RES_INTEGER:
+                    status = (*resources[i].set_func_int)(vice_ptr_to_int(resources[i].event_strict_value),
+                                                          resources[i].param);
+                    break;
+                case RES_STRING:
+                    status = (*resources[i].set_func_string)((const char *)(resources[i].event_strict_value),
+                                                             resources[i].param);
+                    break;
+            }
+            resources_notify_subscribers(resources + i, &old);
+            if (status < 0) {
+                return -1;
+            }
         }
         resources_issue_callback(resources + i, 0);
     }
@@ -1051,6 +1168,7 @@ int resources_read_item_from_file(FILE *f)
 
     {
         int result;
+        resource_old_value_t old;
 
         r = lookup(buf);
         if (r == NULL) {
@@ -1058,6 +1176,8 @@ int resources_read_item_from_file(FILE *f)
             return RESERR_UNKNOWN_RESOURCE;
         }
 
+        resources_remember_value(r, &old);
+
         switch (r->type) {
             case RES_INTEGER:
                 result = (*r->set_func_int)(atoi(arg_ptr), r->param);
@@ -1072,6 +1192,8 @@ int resources_read_item_from_file(FILE *f)
                 break;
         }
 
+        resources_notify_subscribers(r, &old);
+
         if (result < 0) {
             switch (r->type) {
                 case RES_INTEGER:
@@ -1414,3 +1536,139 @@ int resources_register_callback(const char *name,
     }
     return -1;
 }
+
+/* ------------------------------------------------------------------------- */
+
+/* Handles are the index of the resource plus one, so that zero-initialized
+   handles are unresolved.  */
+static resource_ram_t *handle_to_resource(resource_handle_t handle)
+{
+    if (handle <= 0 || (unsigned int)handle > num_resources) {
+        log_warning(LOG_DEFAULT, "Invalid resource handle %d.", handle);
+        return NULL;
+    }
+    return resources + handle - 1;
+}
+
+resource_handle_t resources_get_handle(const char *name)
+{
+    resource_ram_t *r = lookup(name);
+
+    if (r == NULL) {
+        log_warning(LOG_DEFAULT,
+                    "Trying to get handle of unknown resource `%s'.", name);
+        return RESOURCE_HANDLE_NONE;
+    }
+
+    return (resource_handle_t)(r - resources) + 1;
+}
+
+resource_handle_t resources_resolve_handle(resource_handle_t *handle, const char *name)
+{
+    if (*handle == RESOURCE_HANDLE_NONE) {
+        *handle = resources_get_handle(name);
+    }
+    return *handle;
+}
+
+int resources_handle_get_int(resource_handle_t handle, int *value_return)
+{
+    resource_ram_t *r = handle_to_resource(handle);
+
+    if (r == NULL || r->type != RES_INTEGER) {
+        return -1;
+    }
+
+    *value_return = *(int *)r->value_ptr;
+    return 0;
+}
+
+int resources_handle_get_string(resource_handle_t handle, const char **value_return)
+{
+    resource_ram_t *r = handle_to_resource(handle);
+
+    if (r == NULL || r->type != RES_STRING) {
+        return -1;
+    }
+
+    *value_return = *(const char **)r->value_ptr;
+    return 0;
+}
+
+int resources_handle_set_int(resource_handle_t handle, int value)
+{
+    resource_ram_t *r = handle_to_resource(handle);
+
+    if (r == NULL) {
+        return -1;
+    }
+
+    if (r->event_relevant == RES_EVENT_STRICT && network_get_mode() != NETWORK_IDLE) {
+        return -2;
+    }
+
+    if (r->event_relevant == RES_EVENT_SAME && network_connected()) {
+        resource_record_event(r, uint_to_void_ptr(value));
+        return 0;
+    }
+
+    return resources_set_internal_int(r, value);
+}
+
+int resources_handle_set_string(resource_handle_t handle, const char *value)
+{
+    resource_ram_t *r = handle_to_resource(handle);
+
+    if (r == NULL) {
+        return -1;
+    }
+
+    if (r->event_relevant == RES_EVENT_STRICT && network_get_mode() != NETWORK_IDLE) {
+        return -2;
+    }
+
+    if (r->event_relevant == RES_EVENT_SAME && network_connected()) {
+        resource_record_event(r, (resource_value_t)value);
+        return 0;
+    }
+
+    return resources_set_internal_string(r, value);
+}
+
+int resources_subscribe(resource_handle_t handle,
+                        resource_callback_func_t *callback,
+                        void *callback_param)
+{
+    resource_ram_t *r = handle_to_resource(handle);
+
+    if (r == NULL) {
+        return -1;
+    }
+
+    resources_add_callback(&(r->subscribers), callback, callback_param);
+    return 0;
+}
+
+void resources_unsubscribe(resource_handle_t handle,
+                           resource_callback_func_t *callback,
+                           void *callback_param)
+{
+    resource_ram_t *r = handle_to_resource(handle);
+    resource_callback_desc_t **cbd;
+    resource_callback_desc_t *next;
+
+    if (r == NULL) {
+        return;
+    }
+
+    cbd = &(r->subscribers);
+    while (*cbd != NULL) {
+        if ((*cbd)->func == callback && (*cbd)->param == callback_param) {
+            next = (*cbd)->next;
+            lib_free(*cbd);
+            *cbd = next;
+        } else {
+            cbd = &((*cbd)->next);
+        }
+    }
+}
@@ -158,6 +158,7 @@ extern int resources_dump(const char *fname);
 extern int resources_write_item_to_file(FILE *fp, const char *name);
 extern int resources_read_item_from_file(FILE *fp);
 extern char *resources_write_item_to_string(const char *name, const char *delim);
+extern char *resources_write_event_relevant_to_string(const char *delim);
 
 extern int resources_set_defaults(void);
 extern int resources_set_default_int(const char *name, int value);
@@ -172,4 +173,27 @@ extern void resources_get_event_safe_list(struct event_list_state_s *list);
 extern int resources_register_callback(const char *name, resource_callback_func_t *callback,
                                        void *callback_param);
 
+/* Handles resolve the name of a resource once; access through a handle skips
+   the name lookup.  Handles stay valid until `resources_shutdown()'.  A
+   zero-initialized handle is unresolved, `resources_resolve_handle()'
+   resolves it on first use.  */
+typedef int resource_handle_t;
+
+#define RESOURCE_HANDLE_NONE 0
+
+extern resource_handle_t resources_get_handle(const char *name);
+extern resource_handle_t resources_resolve_handle(resource_handle_t *handle, const char *name);
+extern int resources_handle_get_int(resource_handle_t handle, int *value_return);
+extern int resources_handle_get_string(resource_handle_t handle, const char **value_return);
+extern int resources_handle_set_int(resource_handle_t handle, int value);
+extern int resources_handle_set_string(resource_handle_t handle, const char *value);
+
+/* Subscribers are called with the resource name after the value of the
+   resource was set and differs from the previous value; unlike the callbacks
+   above they are not called when a value is set to what it already was.  */
+extern int resources_subscribe(resource_handle_t handle, resource_callback_func_t *callback,
+                               void *callback_param);
+extern void resources_unsubscribe(resource_handle_t handle, resource_callback_func_t *callback,
+                                  void *callback_param);
+
 #endif /* _RESOURCES_H */
@@ -29,8 +29,9 @@
  * available (currently ACIA 6551, std C64 and Daniel Dallmanns fast RS232
  * with 9600 Baud).
  *
- * I/O is done to a socket.  If the socket isnt connected, no data
- * is read and written data is discarded.
+ * I/O is done to a socket, a physical device or an in-process peer
+ * (rs232local.c).  If the socket isnt connected, no data is read and
+ * written data is discarded.
  */
 
 #undef        DEBUG
@@ -38,8 +39,6 @@
 
 #include "vice.h"
 
-#if defined(HAVE_RS232DEV) || defined(HAVE_RS232NET)
-
 #include <assert.h>
 #include <errno.h>
 #include <string.h>
@@ -51,6 +50,7 @@
 #include "log.h"
 #include "rs232.h"
 #include "rs232dev.h"
+#include "rs232local.h"
 #include "rs232net.h"
 #include "types.h"
 #include "util.h"
@@ -65,6 +65,7 @@
 /* ------------------------------------------------------------------------- */
 
 enum {
+    RS232_IS_LOCAL_DEVICE = 0x2000,
     RS232_IS_PHYSICAL_DEVICE = 0x4000
 };
 
@@ -112,6 +113,8 @@ int rs232_cmdline_options_init(void)
 /* initializes all RS232 stuff */
 void rs232_init(void)
 {
+    rs232local_init();
+
 #ifdef HAVE_RS232DEV
     rs232dev_init();
 #endif
@@ -124,6 +127,8 @@ void rs232_init(void)
 /* reset RS232 stuff */
 void rs232_reset(void)
 {
+    rs232local_reset();
+
 #ifdef HAVE_RS232DEV
     rs232dev_reset();
 #endif
@@ -162,7 +167,12 @@ int rs232_open(int device)
 
     assert(device < RS232_NUM_DEVICES);
 
-    if (rs232_is_physical_device(device)) {
+    if (rs232local_is_local(rs232_devfile[device])) {
+        ret = rs232local_open(device);
+        if (ret >= 0) {
+            ret |= RS232_IS_LOCAL_DEVICE;
+        }
+    } else if (rs232_is_physical_device(device)) {
 #ifdef HAVE_RS232DEV
         ret = rs232dev_open(device);
         if (ret >= 0) {
@@ -180,7 +190,9 @@ int rs232_open(int device)
 /* closes the rs232 window again */
 void rs232_close(int fd)
 {
-    if (fd & RS232_IS_PHYSICAL_DEVICE) {
+    if (fd & RS232_IS_LOCAL_DEVICE) {
+        rs232local_close(fd & ~RS232_IS_LOCAL_DEVICE);
+    } else if (fd & RS232_IS_PHYSICAL_DEVICE) {
 #ifdef HAVE_RS232DEV
         rs232dev_close(fd & ~RS232_IS_PHYSICAL_DEVICE);
 #endif
@@ -195,6 +207,9 @@ void rs232_close(int fd)
 /* sends a byte to the RS232 line */
 int rs232_putc(int fd, uint8_t b)
 {
+    if (fd & RS232_IS_LOCAL_DEVICE) {
+        return rs232local_putc(fd & ~RS232_IS_LOCAL_DEVICE, b);
+    }
     if (fd & RS232_IS_PHYSICAL_DEVICE) {
 #ifdef HAVE_RS232DEV
         return rs232dev_putc(fd & ~RS232_IS_PHYSICAL_DEVICE, b);
@@ -211,6 +226,9 @@ int rs232_putc(int fd, uint8_t b)
 /* gets a byte to the RS232 line, returns !=0 if byte received, byte in *b. */
 int rs232_getc(int fd, uint8_t * b)
 {
+    if (fd & RS232_IS_LOCAL_DEVICE) {
+        return rs232local_getc(fd & ~RS232_IS_LOCAL_DEVICE, b);
+    }
     if (fd & RS232_IS_PHYSICAL_DEVICE) {
 #ifdef HAVE_RS232DEV
         return rs232dev_getc(fd & ~RS232_IS_PHYSICAL_DEVICE, b);
@@ -227,6 +245,9 @@ int rs232_getc(int fd, uint8_t * b)
 /* set the status lines of the RS232 device */
 int rs232_set_status(int fd, enum rs232handshake_out status)
 {
+    if (fd & RS232_IS_LOCAL_DEVICE) {
+        return rs232local_set_status(fd & ~RS232_IS_LOCAL_DEVICE, status);
+    }
     if (fd & RS232_IS_PHYSICAL_DEVICE) {
 #ifdef HAVE_RS232DEV
         return rs232dev_set_status(fd & ~RS232_IS_PHYSICAL_DEVICE, status);
@@ -243,6 +264,9 @@ int rs232_set_status(int fd, enum rs232handshake_out status)
 /* get the status lines of the RS232 device */
 enum rs232handshake_in rs232_get_status(int fd)
 {
+    if (fd & RS232_IS_LOCAL_DEVICE) {
+        return rs232local_get_status(fd & ~RS232_IS_LOCAL_DEVICE);
+    }
     if (fd & RS232_IS_PHYSICAL_DEVICE) {
 #ifdef HAVE_RS232DEV
         return rs232dev_get_status(fd & ~RS232_IS_PHYSICAL_DEVICE);
@@ -259,10 +283,11 @@ enum rs232handshake_in rs232_get_status(int fd)
 /* set the bps rate of the physical device */
 void rs232_set_bps(int fd, unsigned int bps)
 {
-    if (fd & RS232_IS_PHYSICAL_DEVICE) {
+    if (fd & RS232_IS_LOCAL_DEVICE) {
+        rs232local_set_bps(fd & ~RS232_IS_LOCAL_DEVICE, bps);
+    } else if (fd & RS232_IS_PHYSICAL_DEVICE) {
 #ifdef HAVE_RS232DEV
         rs232dev_set_bps(fd & ~RS232_IS_PHYSICAL_DEVICE, bps);
 #endif
     }
 }
-#endif
@@ -35,8 +35,6 @@
 #include "types.h"
 #include "util.h"
 
-#if defined(HAVE_RS232DEV) || defined(HAVE_RS232NET)
-
 char *rs232_devfile[RS232_NUM_DEVICES] = { NULL };
 
 static int set_devfile(const char *val, void *param)
@@ -152,62 +150,3 @@ void rs232drv_set_bps(int fd, unsigned int bps)
 {
     rs232_set_bps(fd, bps);
 }
-
-#else
-
-void rs232drv_init(void)
-{
-}
-
-void rs232drv_reset(void)
-{
-}
-
-int rs232drv_open(int device)
-{
-    return -1;
-}
-
-void rs232drv_close(int fd)
-{
-}
-
-int rs232drv_putc(int fd, uint8_t b)
-{
-    return -1;
-}
-
-int rs232drv_getc(int fd, uint8_t *b)
-{
-    return -1;
-}
-
-int rs232drv_set_status(int fd, enum rs232handshake_out status)
-{
-    return -1;
-}
-
-enum rs232handshake_in rs232drv_get_status(int fd)
-{
-    return 0;
-}
-
-void rs232drv_set_bps(int fd, unsigned int bps)
-{
-}
-
-int rs232drv_resources_init(void)
-{
-    return 0;
-}
-
-void rs232drv_resources_shutdown(void)
-{
-}
-
-int rs232drv_cmdline_options_init(void)
-{
-    return 0;
-}
-
-#endif
@@ -0,0 +1,463 @@
+/*
+ * rs232local.c - RS232 emulation with an in-process peer.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/*
+ * The local peer talks to the RS232 interfaces without any serial hardware
+ * or network.  The device name selects the peer:
+ *
+ * "local:echo"         every byte sent is received back.
+ * "local:file:<name>"  the contents of <name> are received, bytes sent are
+ *                      discarded.
+ * "local:bbs"          a minimal test BBS: it echoes the input and knows the
+ *                      commands HELP, STREAM <bytes> and BYE.  STREAM sends
+ *                      a known pattern to measure throughput and byte loss.
+ *
+ * The peer fills a ring buffer in chunks and the chip emulations take one
+ * byte per character time out of it, so no host call is made per byte.
+ * Transfer statistics are logged when the device is closed.
+ */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "maincpu.h"
+#include "rs232.h"
+#include "rs232local.h"
+#include "types.h"
+#include "util.h"
+
+/* ------------------------------------------------------------------------- */
+
+/* Size of the receive ring, must be a power of 2.  */
+#define RS232LOCAL_RING_SIZE    0x4000
+#define RS232LOCAL_RING_MASK    (RS232LOCAL_RING_SIZE - 1)
+
+/* Maximum number of bytes produced by the peer at once.  */
+#define RS232LOCAL_CHUNK_SIZE   0x400
+
+/* Length of a BBS input line.  */
+#define RS232LOCAL_LINE_SIZE    80
+
+/* Bytes per line of the BBS stream pattern, including the CR.  */
+#define RS232LOCAL_STREAM_LINE  64
+
+enum {
+    RS232LOCAL_PEER_ECHO = 0,
+    RS232LOCAL_PEER_FILE,
+    RS232LOCAL_PEER_BBS
+};
+
+typedef struct rs232local_s {
+    int peer;
+
+    /* Data sent by the peer, waiting to be received.  */
+    uint8_t ring[RS232LOCAL_RING_SIZE];
+    unsigned int head;
+    unsigned int tail;
+
+    /* File peer.  */
+    FILE *file;
+
+    /* BBS peer.  */
+    char line[RS232LOCAL_LINE_SIZE];
+    unsigned int line_len;
+    unsigned long stream_left;
+    unsigned long stream_pos;
+    int carrier;
+
+    /* Statistics.  */
+    unsigned int bps;
+    CLOCK open_clk;
+    unsigned long bytes_received;
+    unsigned long bytes_sent;
+    unsigned long bytes_dropped;
+} rs232local_t;
+
+static rs232local_t *fds[RS232_NUM_DEVICES];
+
+static log_t rs232local_log = LOG_ERR;
+
+static const char rs232local_banner[] =
+    "\r\nVICE LOCAL TEST BBS\r\n"
+    "COMMANDS: HELP, STREAM <BYTES>, BYE\r\n";
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned int ring_used(const rs232local_t *l)
+{
+    return (l->head - l->tail) & RS232LOCAL_RING_MASK;
+}
+
+static unsigned int ring_free(const rs232local_t *l)
+{
+    return RS232LOCAL_RING_MASK - ring_used(l);
+}
+
+/* Queue bytes for reception, counting what does not fit as dropped.  */
+static void ring_put(rs232local_t *l, const uint8_t *data, unsigned int len)
+{
+    unsigned int n = ring_free(l);
+
+    if (len > n) {
+        l->bytes_dropped += len - n;
+        len = n;
+    }
+    while (len--) {
+        l->ring[l->head] = *data++;
+        l->head = (l->head + 1) & RS232LOCAL_RING_MASK;
+    }
+}
+
+static void ring_puts(rs232local_t *l, const char *s)
+{
+    ring_put(l, (const uint8_t *)s, (unsigned int)strlen(s));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bbs_prompt(rs232local_t *l)
+{
+    ring_puts(l, "> ");
+}
+
+static void bbs_command(rs232local_t *l)
+{
+    char *cmd = l->line;
+    unsigned int i;
+
+    l->line[l->line_len] = 0;
+    l->line_len = 0;
+
+    for (i = 0; cmd[i] != 0; i++) {
+        cmd[i] = util_toupper(cmd[i]);
+    }
+    while (*cmd == ' ') {
+        cmd++;
+    }
+
+    ring_puts(l, "\r\n");
+
+    if (strncmp(cmd, "STREAM", 6) == 0) {
+        long count = strtol(cmd + 6, NULL, 10);
+
+        if (count > 0) {
+            l->stream_left = (unsigned long)count;
+            l->stream_pos = 0;
+            /* The pattern and the prompt follow from the refill.  */
+            return;
+        }
+        ring_puts(l, "USAGE: STREAM <BYTES>\r\n");
+    } else if (strcmp(cmd, "BYE") == 0) {
+        ring_puts(l, "NO CARRIER\r\n");
+        l->carrier = 0;
+        return;
+    } else if (strcmp(cmd, "HELP") == 0) {
+        ring_puts(l, rs232local_banner);
+    } else if (*cmd != 0) {
+        ring_puts(l, "?UNKNOWN COMMAND\r\n");
+    }
+    bbs_prompt(l);
+}
+
+static void bbs_input(rs232local_t *l, uint8_t b)
+{
+    switch (b) {
+        case 0x0d:
+            bbs_command(l);
+            break;
+        case 0x08:      /* ASCII backspace */
+        case 0x14:      /* PETSCII delete */
+        case 0x7f:
+            if (l->line_len > 0) {
+                l->line_len--;
+                ring_put(l, &b, 1);
+            }
+            break;
+        default:
+            if (b >= 0x20 && l->line_len < RS232LOCAL_LINE_SIZE - 1) {
+                l->line[l->line_len++] = (char)b;
+                ring_put(l, &b, 1);
+            }
+            break;
+    }
+}
+
+/* The stream pattern is printable in ASCII and PETSCII: lines of 63
+   characters counting up from space, followed by a CR.  */
+static uint8_t bbs_stream_byte(unsigned long pos)
+{
+    unsigned long col = pos % RS232LOCAL_STREAM_LINE;
+
+    if (col == RS232LOCAL_STREAM_LINE - 1) {
+        return 0x0d;
+    }
+    return (uint8_t)(0x20 + (pos / RS232LOCAL_STREAM_LINE + col) % 0x3f);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Let the peer produce more data once the ring runs low.  */
+static void rs232local_refill(rs232local_t *l)
+{
+    uint8_t chunk[RS232LOCAL_CHUNK_SIZE];
+    unsigned int n;
+
+    if (ring_used(l) >= RS232LOCAL_CHUNK_SIZE) {
+        return;
+    }
+
+    n = ring_free(l);
+    if (n > RS232LOCAL_CHUNK_SIZE) {
+        n = RS232LOCAL_CHUNK_SIZE;
+    }
+
+    switch (l->peer) {
+        case RS232LOCAL_PEER_FILE:
+            if (l->file != NULL) {
+                n = (unsigned int)fread(chunk, 1, n, l->file);
+                if (n == 0) {
+                    fclose(l->file);
+                    l->file = NULL;
+                }
+                ring_put(l, chunk, n);
+            }
+            break;
+        case RS232LOCAL_PEER_BBS:
+            if (l->stream_left > 0) {
+                unsigned int i;
+
+                if (n > l->stream_left) {
+                    n = (unsigned int)l->stream_left;
+                }
+                for (i = 0; i < n; i++) {
+                    chunk[i] = bbs_stream_byte(l->stream_pos++);
+                }
+                l->stream_left -= n;
+                ring_put(l, chunk, n);
+                if (l->stream_left == 0) {
+                    ring_puts(l, "\r\n");
+                    bbs_prompt(l);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+int rs232local_is_local(const char *name)
+{
+    return name != NULL
+           && strncmp(name, RS232LOCAL_PREFIX, strlen(RS232LOCAL_PREFIX)) == 0;
+}
+
+/* initializes all RS232 stuff */
+void rs232local_init(void)
+{
+    rs232local_log = log_open("RS232LOCAL");
+}
+
+/* reset RS232 stuff */
+void rs232local_reset(void)
+{
+    int i;
+
+    for (i = 0; i < RS232_NUM_DEVICES; i++) {
+        if (fds[i] != NULL) {
+            rs232local_close(i);
+        }
+    }
+}
+
+/* opens a rs232 window, returns handle to give to functions below. */
+int rs232local_open(int device)
+{
+    const char *name = rs232_devfile[device] + strlen(RS232LOCAL_PREFIX);
+    rs232local_t *l;
+    int i;
+
+    for (i = 0; i < RS232_NUM_DEVICES; i++) {
+        if (fds[i] == NULL) {
+            break;
+        }
+    }
+
+    if (i >= RS232_NUM_DEVICES) {
+        log_error(rs232local_log, "No more devices available.");
+        return -1;
+    }
+
+    l = lib_calloc(1, sizeof(rs232local_t));
+
+    if (strcmp(name, "echo") == 0) {
+        l->peer = RS232LOCAL_PEER_ECHO;
+    } else if (strcmp(name, "bbs") == 0) {
+        l->peer = RS232LOCAL_PEER_BBS;
+        l->carrier = 1;
+        ring_puts(l, rs232local_banner);
+        bbs_prompt(l);
+    } else if (strncmp(name, "file:", 5) == 0) {
+        l->peer = RS232LOCAL_PEER_FILE;
+        l->file = fopen(name + 5, MODE_READ);
+        if (l->file == NULL) {
+            log_error(rs232local_log, "Cannot open `%s'.", name + 5);
+            lib_free(l);
+            return -1;
+        }
+    } else {
+        log_error(rs232local_log, "Unknown peer `%s', use echo, bbs or file:<name>.", name);
+        lib_free(l);
+        return -1;
+    }
+
+    l->open_clk = maincpu_clk;
+    fds[i] = l;
+
+    return i;
+}
+
+/* closes the rs232 window again */
+void rs232local_close(int fd)
+{
+    rs232local_t *l;
+    double seconds;
+
+    if (fd < 0 || fd >= RS232_NUM_DEVICES || fds[fd] == NULL) {
+        log_error(rs232local_log, "Attempt to close invalid fd %d.", fd);
+        return;
+    }
+
+    l = fds[fd];
+
+    seconds = (double)(maincpu_clk - l->open_clk) / (double)machine_get_cycles_per_second();
+    log_message(rs232local_log,
+                "Closed after %.1f s at %u bps: %lu bytes received (%.0f/s), %lu sent (%.0f/s), %lu dropped.",
+                seconds, l->bps,
+                l->bytes_received, seconds > 0.0 ? l->bytes_received / seconds : 0.0,
+                l->bytes_sent, seconds > 0.0 ? l->bytes_sent / seconds : 0.0,
+                l->bytes_dropped);
+
+    if (l->file != NULL) {
+        fclose(l->file);
+    }
+    lib_free(l);
+    fds[fd] = NULL;
+}
+
+/* sends a byte to the RS232 line */
+int rs232local_putc(int fd, uint8_t b)
+{
+    rs232local_t *l;
+
+    if (fd < 0 || fd >= RS232_NUM_DEVICES || fds[fd] == NULL) {
+        log_error(rs232local_log, "Attempt to write to invalid fd %d.", fd);
+        return -1;
+    }
+
+    l = fds[fd];
+    l->bytes_sent++;
+
+    switch (l->peer) {
+        case RS232LOCAL_PEER_ECHO:
+            ring_put(l, &b, 1);
+            break;
+        case RS232LOCAL_PEER_BBS:
+            /* Input is ignored while streaming or after BYE.  */
+            if (l->carrier && l->stream_left == 0) {
+                bbs_input(l, b);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+/* gets a byte from the RS232 line, returns 1 if byte received, byte in *b,
+   0 if none is waiting and -1 on an invalid fd. */
+int rs232local_getc(int fd, uint8_t *b)
+{
+    rs232local_t *l;
+
+    if (fd < 0 || fd >= RS232_NUM_DEVICES || fds[fd] == NULL) {
+        log_error(rs232local_log, "Attempt to read from invalid fd %d.", fd);
+        return -1;
+    }
+
+    l = fds[fd];
+
+    if (l->head == l->tail) {
+        rs232local_refill(l);
+        if (l->head == l->tail) {
+            return 0;
+        }
+    }
+
+    *b = l->ring[l->tail];
+    l->tail = (l->tail + 1) & RS232LOCAL_RING_MASK;
+    l->bytes_received++;
+
+    if (ring_used(l) < RS232LOCAL_CHUNK_SIZE) {
+        rs232local_refill(l);
+    }
+
+    return 1;
+}
+
+/* set the status lines of the RS232 device */
+int rs232local_set_status(int fd, enum rs232handshake_out status)
+{
+    return 0;
+}
+
+/* get the status lines of the RS232 device */
+enum rs232handshake_in rs232local_get_status(int fd)
+{
+    if (fd < 0 || fd >= RS232_NUM_DEVICES || fds[fd] == NULL) {
+        return 0;
+    }
+
+    /* DCD follows CTS, drop both when the BBS hung up.  */
+    if (fds[fd]->peer == RS232LOCAL_PEER_BBS && !fds[fd]->carrier) {
+        return RS232_HSI_DSR;
+    }
+    return RS232_HSI_CTS | RS232_HSI_DSR;
+}
+
+/* set the bps rate of the line */
+void rs232local_set_bps(int fd, unsigned int bps)
+{
+    if (fd >= 0 && fd < RS232_NUM_DEVICES && fds[fd] != NULL) {
+        fds[fd]->bps = bps;
+    }
+}
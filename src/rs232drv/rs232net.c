@@ -82,6 +82,9 @@ int rs232net_cmdline_options_init(void)
 
 /* ------------------------------------------------------------------------- */
 
+/* Number of bytes received from the socket at once.  */
+#define RS232NET_RX_BUFSIZE 256
+
 typedef struct rs232net {
     int inuse; /*!< 0 if the connection has not been opened, 1 otherwise. */
     vice_network_socket_t * fd; /*!< the vice_network_socket_t for the connection.
@@ -89,6 +92,9 @@ typedef struct rs232net {
                     although inuse == 1, then the socket has been closed
                     because of a previous error. This prevents the error
                     log from being flooded with error messages. */
+    uint8_t rx_buf[RS232NET_RX_BUFSIZE]; /*!< bytes received but not yet read */
+    int rx_pos; /*!< next byte to return from rx_buf */
+    int rx_len; /*!< number of valid bytes in rx_buf */
 } rs232net_t;
 
 /* C99 standard guarantees all members of an object of static storage are
@@ -156,6 +162,8 @@ int rs232net_open(int device)
         }
 
         fds[i].inuse = 1;
+        fds[i].rx_pos = 0;
+        fds[i].rx_len = 0;
 
         index = i;
 
@@ -254,20 +262,34 @@ int rs232net_getc(int fd, uint8_t * b)
             break;
         }
 
+        /* hand out what a previous receive left over */
+        if (fds[fd].rx_pos < fds[fd].rx_len) {
+            *b = fds[fd].rx_buf[fds[fd].rx_pos++];
+            no_of_read_byte = 1;
+            break;
+        }
+
         ret = vice_network_select_poll_one(fds[fd].fd);
 
         if (ret > 0) {
+            int n;
 
-            no_of_read_byte = vice_network_receive(fds[fd].fd, b, 1, 0);
+            /* take everything that is available, not just one byte */
+            n = vice_network_receive(fds[fd].fd, fds[fd].rx_buf, RS232NET_RX_BUFSIZE, 0);
 
-            if ( no_of_read_byte != 1 ) {
-                if ( no_of_read_byte < 0 ) {
+            if (n <= 0) {
+                if (n < 0) {
                     log_error(rs232net_log, "Error reading: %u.", vice_network_get_errorcode());
                 } else {
                     log_error(rs232net_log, "EOF");
                 }
                 rs232net_closesocket(fd);
                 no_of_read_byte = -1;
+            } else {
+                fds[fd].rx_pos = 1;
+                fds[fd].rx_len = n;
+                *b = fds[fd].rx_buf[0];
+                no_of_read_byte = 1;
             }
         }
     } while (0);
@@ -0,0 +1,64 @@
+/*
+ * rs232local.h - RS232 emulation with an in-process peer.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_RS232LOCAL_H
+#define VICE_RS232LOCAL_H
+
+#include "types.h"
+
+/* Prefix of the device names handled by the local peer, e.g. "local:echo",
+   "local:bbs" or "local:file:<name>".  */
+#define RS232LOCAL_PREFIX "local:"
+
+/* Returns non-zero if the device name selects a local peer */
+extern int rs232local_is_local(const char *name);
+
+/* Initializes all RS232 stuff */
+extern void rs232local_init(void);
+
+/* Reset for RS232 interfaces */
+extern void rs232local_reset(void);
+
+/* Opens a rs232 window, returns handle to give to functions below. */
+extern int rs232local_open(int device);
+
+/* Closes the rs232 window again */
+extern void rs232local_close(int fd);
+
+/* Sends a byte to the RS232 line */
+extern int rs232local_putc(int fd, uint8_t b);
+
+/* Gets a byte from the RS232 line into *b.  Returns 1 if a byte was
+   received, 0 if none is waiting and -1 if `fd' is invalid. */
+extern int rs232local_getc(int fd, uint8_t *b);
+
+/* write the output handshake lines */
+extern int rs232local_set_status(int fd, enum rs232handshake_out status);
+
+/* write the output handshake lines */
+extern enum rs232handshake_in rs232local_get_status(int fd);
+
+/* set the bps rate of the line */
+extern void rs232local_set_bps(int fd, unsigned int bps);
+
+#endif
@@ -78,6 +78,7 @@
 #include "machine.h"
 #include "main65816cpu.h"
 #include "mem.h"
+#include "memheat.h"
 #include "monitor.h"
 #include "network.h"
 #include "paperclip64.h"
@@ -536,6 +537,10 @@ int machine_resources_init(void)
         return -1;
     }
 #endif
+    if (memheat_resources_init() < 0) {
+        init_resource_fail("memheat");
+        return -1;
+    }
 #ifdef HAVE_MOUSE
     if (mouse_resources_init() < 0) {
         init_resource_fail("mouse");
@@ -612,6 +617,7 @@ void machine_resources_shutdown(void)
     sampler_resources_shutdown();
     userport_resources_shutdown();
     joyport_bbrtc_resources_shutdown();
+    memheat_resources_shutdown();
 }
 
 /* C64-specific command-line option initialization.  */
@@ -717,6 +723,10 @@ int machine_cmdline_options_init(void)
         return -1;
     }
 #endif
+    if (memheat_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("memheat");
+        return -1;
+    }
 #ifdef HAVE_MOUSE
     if (mouse_cmdline_options_init() < 0) {
         init_cmdline_options_fail("mouse");
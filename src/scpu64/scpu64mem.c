@@ -48,6 +48,7 @@
 #include "machine.h"
 #include "main65816cpu.h"
 #include "mem.h"
+#include "memheat.h"
 #include "monitor.h"
 #include "ram.h"
 #include "reu.h"
@@ -96,6 +97,10 @@ static int mem_conf_page_size;
 static int mem_conf_size;
 unsigned int mem_simm_ram_mask = 0;
 uint8_t mem_tooslow[1];
+
+/* Direct pointers to the SIMM RAM for the banks where no address remapping
+   is needed, NULL for everything else.  */
+static uint8_t *mem_simm_bank_tab[0x100];
 static int traps_pending;
 
 #ifdef USE_EMBEDDED
@@ -127,6 +132,11 @@ static uint32_t mem_read_limit_tab[NUM_CONFIGS][0x101];
 static store_func_ptr_t mem_write_tab_watch[0x101];
 static read_func_ptr_t mem_read_tab_watch[0x101];
 
+/* Heatmap tables: the current configuration with the recording handlers
+   patched in for the selected pages of bank 0.  */
+static store_func_ptr_t mem_write_tab_heat[0x101];
+static read_func_ptr_t mem_read_tab_heat[0x101];
+
 /* Current mirror config */
 static int mirror;
 
@@ -136,6 +146,9 @@ static int mem_config;
 /* Current watchpoint state. 1 = watchpoints active, 0 = no watchpoints */
 static int watchpoints_active;
 
+/* Current heatmap state. 1 = recording handlers installed, 0 = none */
+static int heatmap_active;
+
 
 static int mem_reg_sw_1mhz;     /* 1MHz physical switch */
 static int mem_reg_sw_jiffy = 1;/* Jiffy physical switch */
@@ -192,22 +205,93 @@ static void store_watch(uint16_t addr, uint8_t value)
     mem_write_tab[mirror][mem_config][addr >> 8](addr, value);
 }
 
-void mem_toggle_watchpoints(int flag, void *context)
+/* The heatmap handlers record the access and then call the handler of the
+   current configuration.  An opcode fetch is the only read done at the
+   current PC, which is how execution is told apart from data reads.  Only
+   the PC offset is compared, so code running in another bank can mark a
+   bank 0 read at the same offset as executed.  */
+static uint8_t zero_read_heat(uint16_t addr)
+{
+    addr &= 0xff;
+    memheat_record(addr, (addr == reg_pc) ? MEMHEAT_EXEC : MEMHEAT_READ);
+    return mem_read_tab[mem_config][0](addr);
+}
+
+static void zero_store_heat(uint16_t addr, uint8_t value)
+{
+    addr &= 0xff;
+    memheat_record(addr, MEMHEAT_WRITE);
+    mem_write_tab[mirror][mem_config][0](addr, value);
+}
+
+static uint8_t read_heat(uint16_t addr)
+{
+    memheat_record(addr, (addr == reg_pc) ? MEMHEAT_EXEC : MEMHEAT_READ);
+    return mem_read_tab[mem_config][addr >> 8](addr);
+}
+
+static void store_heat(uint16_t addr, uint8_t value)
+{
+    memheat_record(addr, MEMHEAT_WRITE);
+    mem_write_tab[mirror][mem_config][addr >> 8](addr, value);
+}
+
+/* Rebuild the heatmap tables for the current configuration and mirror
+   setting.  */
+static void mem_heatmap_tables_update(void)
+{
+    int i;
+
+    for (i = 0; i <= 0x100; i++) {
+        if (memheat_page_selected((unsigned int)i & 0xff)) {
+            mem_read_tab_heat[i] = (i & 0xff) ? read_heat : zero_read_heat;
+            mem_write_tab_heat[i] = (i & 0xff) ? store_heat : zero_store_heat;
+        } else {
+            mem_read_tab_heat[i] = mem_read_tab[mem_config][i];
+            mem_write_tab_heat[i] = mem_write_tab[mirror][mem_config][i];
+        }
+    }
+}
+
+/* Select the read/write tables to use.  Watchpoints take precedence over
+   the heatmap.  */
+static void mem_update_tab_ptrs(void)
 {
-    if (flag) {
+    if (watchpoints_active) {
         _mem_read_tab_ptr = mem_read_tab_watch;
         _mem_write_tab_ptr = mem_write_tab_watch;
+    } else if (heatmap_active) {
+        mem_heatmap_tables_update();
+        _mem_read_tab_ptr = mem_read_tab_heat;
+        _mem_write_tab_ptr = mem_write_tab_heat;
     } else {
         _mem_read_tab_ptr = mem_read_tab[mem_config];
         _mem_write_tab_ptr = mem_write_tab[mirror][mem_config];
     }
+}
+
+static void mem_heatmap_changed(void)
+{
+    heatmap_active = memheat_active();
+    mem_update_tab_ptrs();
+    maincpu_resync_limits();
+}
+
+void mem_toggle_watchpoints(int flag, void *context)
+{
     watchpoints_active = flag;
+    mem_update_tab_ptrs();
 }
 
 /* ------------------------------------------------------------------------- */
 
 void scpu64_mem_init(void)
 {
+    memheat_set_update_callback(mem_heatmap_changed);
+
+    /* The heatmap resources may have been set before the memory was set up.  */
+    heatmap_active = memheat_active();
+
     /* Initialize REU BA low interface (FIXME find a better place for this) */
     reu_ba_register(vicii_cycle, vicii_steal_cycles, &maincpu_ba_low_flags, MAINCPU_BA_LOW_REU);
 }
@@ -217,13 +301,7 @@ void mem_pla_config_changed(void)
     mem_config = ((mem_pport & 7) | (export.exrom << 3) | (export.game << 4) 
                 | (mem_reg_hwenable << 5) | (mem_reg_dosext << 6) | (mem_reg_bootmap << 7));
 
-    if (watchpoints_active) {
-        _mem_read_tab_ptr = mem_read_tab_watch;
-        _mem_write_tab_ptr = mem_write_tab_watch;
-    } else {
-        _mem_read_tab_ptr = mem_read_tab[mem_config];
-        _mem_write_tab_ptr = mem_write_tab[mirror][mem_config];
-    }
+    mem_update_tab_ptrs();
 
     _mem_read_base_tab_ptr = mem_read_base_tab[mem_config];
     mem_read_limit_tab_ptr = mem_read_limit_tab[mem_config];
@@ -397,6 +475,14 @@ uint8_t mem_read(uint16_t addr)
 
 void mem_store2(uint32_t addr, uint8_t value)
 {
+    uint8_t *p = mem_simm_bank_tab[(addr >> 16) & 0xff];
+
+    if (p != NULL) {
+        p[addr & 0xffff] = value;
+        scpu64_clock_write_stretch_simm(addr);
+        return;
+    }
+
     switch (addr & 0xfe0000) {
     case 0xf60000:
         if (mem_simm_ram_mask) {
@@ -442,6 +528,13 @@ void mem_store2(uint32_t addr, uint8_t value)
 
 uint8_t mem_read2(uint32_t addr)
 {
+    uint8_t *p = mem_simm_bank_tab[(addr >> 16) & 0xff];
+
+    if (p != NULL) {
+        scpu64_clock_read_stretch_simm(addr);
+        return p[addr & 0xffff];
+    }
+
     switch (addr & 0xfe0000) {
     case 0xf60000:
         if (mem_simm_ram_mask) {
@@ -479,6 +572,12 @@ uint8_t mem_read2(uint32_t addr)
 
 static uint8_t mem_peek2(uint32_t addr)
 {
+    uint8_t *p = mem_simm_bank_tab[(addr >> 16) & 0xff];
+
+    if (p != NULL) {
+        return p[addr & 0xffff];
+    }
+
     switch (addr & 0xfe0000) {
     case 0xf60000:
         if (mem_simm_ram_mask) {
@@ -1242,6 +1341,9 @@ void mem_mmu_translate(unsigned int addr, uint8_t **base, int *start, int *limit
         } else {
             cartridge_mmu_translate(addr, base, start, limit);
         }
+        if (heatmap_active) {
+            memheat_clip_limits(addr, base, start, limit);
+        }
     }
 }
 
@@ -1270,9 +1372,26 @@ void mem_set_mirroring(int new_mirroring)
     mirror = ((new_mirroring & 0x1) ? 1 : 0) | ((new_mirroring & 0x4) ? 2 : 0)
            | ((new_mirroring & 0x40) ? 4 : 0) | ((new_mirroring & 0x80) ? 8 : 0);
 
-    /* Do not override watchpoints on vbank switches.  */
-    if (_mem_write_tab_ptr != mem_write_tab_watch) {
-        _mem_write_tab_ptr = mem_write_tab[mirror][mem_config];
+    /* Do not override watchpoints on mirroring switches.  */
+    mem_update_tab_ptrs();
+}
+
+/* Banks $02-$F5 map linearly to the SIMM when the SIMM and the configured
+   page sizes match, which saves the range checks and the address remapping
+   in mem_read2() and mem_store2().  */
+static void mem_simm_bank_tab_update(void)
+{
+    unsigned int bank;
+
+    for (bank = 0; bank < 0x100; bank++) {
+        mem_simm_bank_tab[bank] = NULL;
+        if (bank < 0x02 || bank >= 0xf6) {
+            continue;
+        }
+        if (mem_simm_ram_mask && mem_simm_page_size == mem_conf_page_size
+            && (bank << 16) < (unsigned int)mem_conf_size) {
+            mem_simm_bank_tab[bank] = mem_simm_ram + ((bank << 16) & mem_simm_ram_mask);
+        }
     }
 }
 
@@ -1301,6 +1420,7 @@ void mem_set_simm(int config)
         break;
     }
     scpu64_set_simm_row_size(mem_conf_page_size);
+    mem_simm_bank_tab_update();
 }
 
 void scpu64_hardware_reset(void)
@@ -1324,6 +1444,16 @@ void mem_set_tape_sense(int sense)
 {
 }
 
+/* Set the tape write in.  */
+void mem_set_tape_write_in(int val)
+{
+}
+
+/* Set the tape motor in.  */
+void mem_set_tape_motor_in(int val)
+{
+}
+
 /* ------------------------------------------------------------------------- */
 
 /* FIXME: this part needs to be checked.  */
@@ -1739,6 +1869,43 @@ void mem_bank_write(int bank, uint16_t addr, uint8_t byte, void *context)
     mem_sram[addr] = byte;
 }
 
+/* Return a pointer to `addr' in `bank' if the rest of its page can be read
+   directly without side effects, or NULL to use mem_bank_peek().  */
+uint8_t *mem_bank_base(int bank, uint16_t addr, void *context)
+{
+    uint8_t *p;
+
+    if ((bank >= 5) && (bank <= 6)) {
+        return mem_sram + ((bank - 5) << 16) + addr; /* ram00..01 */
+    }
+    if ((bank >= 7) && (bank <= 252)) {
+        int addr2 = addr + ((bank - ((bank >= 251) ? 251 : 5)) << 16);
+        if (mem_simm_ram_mask && mem_simm_page_size == mem_conf_page_size && addr2 < mem_conf_size) {
+            return mem_simm_ram + (addr2 & mem_simm_ram_mask); /* ram02..f6 */
+        }
+        return NULL;
+    }
+    if ((bank >= 253) && (bank <= 260)) {
+        return scpu64rom_scpu64_rom + ((((bank - 253) << 16) + addr) & (SCPU64_SCPU64_ROM_MAXSIZE-1)); /* romf8..ff */
+    }
+    switch (bank) {
+        case 0:                   /* current */
+            if (WDC65816_REGS_GET_PBR(maincpu_monitor_interface->cpu_65816_regs) > 0) {
+                break;
+            }
+            /* the same pages the CPU fetches opcodes from, but not the
+               processor port */
+            p = _mem_read_base_tab_ptr[addr >> 8];
+            if (p != NULL && addr > 1) {
+                return p + addr;
+            }
+            break;
+        case 1:                   /* ram */
+            return mem_sram + addr;
+    }
+    return NULL;
+}
+
 static int mem_dump_io(void *context, uint16_t addr)
 {
     if ((addr >= 0xdc00) && (addr <= 0xdc3f)) {
@@ -1790,6 +1957,7 @@ void mem_set_simm_size(int val)
         mem_simm_page_size = 11 + 2;  /* 4,3 */
         break;
     }
+    mem_simm_bank_tab_update();
     maincpu_resync_limits();
 }
 
@@ -1832,4 +2000,6 @@ void scpu64_mem_shutdown(void)
 {
     lib_free(mem_simm_ram);
     mem_simm_ram = NULL;
+    mem_simm_ram_mask = 0;
+    mem_simm_bank_tab_update();
 }
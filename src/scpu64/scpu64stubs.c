@@ -27,116 +27,8 @@
 #include "vice.h"
 
 #include "c64mem.h"
-#include "snapshot.h"
-#include "tap.h"
-#include "tape.h"
-#include "tapeport.h"
-#include "tape-snapshot.h"
 
 
-/*******************************************************************************
-    tape
-*******************************************************************************/
-
-tape_image_t *tape_image_dev1 = NULL;
-
-int tape_image_attach(unsigned int unit, const char *name)
-{
-    return 0;
-}
-
-void tape_shutdown(void)
-{
-}
-
-int tape_tap_attached(void)
-{
-    return 0;
-}
-
-int tape_seek_start(tape_image_t *tape_image)
-{
-    return 0;
-}
-
-int tape_seek_to_file(tape_image_t *tape_image, unsigned int file_number)
-{
-    return 0;
-}
-
-void tape_image_event_playback(unsigned int unit, const char *filename)
-{
-}
-
-int tape_image_detach(unsigned int unit)
-{
-    return 0;
-}
-
-int tap_seek_start(tap_t *tap)
-{
-    return 0;
-}
-
-int tape_image_create(const char *name, unsigned int type)
-{
-    return 0;
-}
-
-int tape_snapshot_write_module(snapshot_t *s, int save_image)
-{
-    return 0;
-}
-
-int tape_snapshot_read_module(snapshot_t *s)
-{
-    return 0;
-}
-
-int tape_read(tape_image_t *tape_image, uint8_t *buf, size_t size)
-{
-    return 0;
-}
-
-tape_file_record_t *tape_get_current_file_record(tape_image_t *tape_image)
-{
-    return NULL;
-}
-
-int tape_image_open(tape_image_t *tape_image)
-{
-    return -1;
-}
-
-int tape_image_close(tape_image_t *tape_image)
-{
-    return 0;
-}
-
-int tape_internal_close_tape_image(tape_image_t *tape_image)
-{
-    return 0;
-}
-
-tape_image_t *tape_internal_open_tape_image(const char *name, unsigned int read_only)
-{
-    return NULL;
-}
-
-int tape_seek_to_next_file(tape_image_t *tape_image, unsigned int allow_rewind)
-{
-    return 0;
-}
-
-void tape_get_header(tape_image_t *tape_image, uint8_t *name)
-{
-}
-
-const char *tape_get_file_name(void)
-{
-    return NULL;
-}
-
 uint8_t colorram_read(uint16_t addr)
 {
     return 0;
@@ -145,24 +37,3 @@ uint8_t colorram_read(uint16_t addr)
 void colorram_store(uint16_t addr, uint8_t value)
 {
 }
-
-tapeport_device_list_t *tapeport_device_register(tapeport_device_t *device)
-{
-    return NULL;
-}
-
-void tapeport_snapshot_register(tapeport_snapshot_t *snapshot)
-{
-}
-
-void tapeport_device_unregister(tapeport_device_list_t *device)
-{
-}
-
-void tapeport_trigger_flux_change(unsigned int on, int id)
-{
-}
-
-void tapeport_set_tape_sense(int sense, int id)
-{
-}
@@ -60,6 +60,61 @@ static void set_sid_engine_with_fallback(int engine)
 
 static int intended_sid_engine = -1;
 
+/* The SID setup is read on every snapshot save and restore, so the
+   resources are accessed through handles resolved on first use.  */
+static resource_handle_t sound_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t sid_engine_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t sid_stereo_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t sid_stereo_address_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t sid_triple_address_handle = RESOURCE_HANDLE_NONE;
+
+static int sid_snapshot_get_int(resource_handle_t *handle, const char *name, int *value)
+{
+    return resources_handle_get_int(resources_resolve_handle(handle, name), value);
+}
+
+/* Set while restoring a snapshot that was taken with the current SID setup;
+   the sound device then stays open and the extended modules bring the
+   engine state up to date.  */
+static int sid_hot_restore = 0;
+
+static int sid_snapshot_setup_unchanged(int sids, int sound, int engine)
+{
+    int cur_sids, cur_sound, cur_engine;
+    int i;
+
+    if (0
+        || sid_snapshot_get_int(&sid_stereo_handle, "SidStereo", &cur_sids) < 0
+        || sid_snapshot_get_int(&sound_handle, "Sound", &cur_sound) < 0
+        || sid_snapshot_get_int(&sid_engine_handle, "SidEngine", &cur_engine) < 0) {
+        return 0;
+    }
+
+    if (!sound || sids != cur_sids || sound != cur_sound || engine != cur_engine) {
+        return 0;
+    }
+
+    for (i = 0; i <= sids; i++) {
+        if (sound_get_psid(i) == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void sid_snapshot_set_address(resource_handle_t *handle, const char *name, int address)
+{
+    int cur_address;
+
+    resources_resolve_handle(handle, name);
+
+    if (!sid_hot_restore
+        || resources_handle_get_int(*handle, &cur_address) < 0
+        || cur_address != address) {
+        resources_handle_set_int(*handle, address);
+    }
+}
+
 /* ---------------------------------------------------------------------*/
 
 /* SID snapshot module format:
@@ -121,9 +176,9 @@ static int sid_snapshot_write_module_simple(snapshot_t *s, int sidnr)
         return -1;
     }
 
-    resources_get_int("Sound", &sound);
-    resources_get_int("SidEngine", &sid_engine);
-    resources_get_int("SidStereo", &sids);
+    sid_snapshot_get_int(&sound_handle, "Sound", &sound);
+    sid_snapshot_get_int(&sid_engine_handle, "SidEngine", &sid_engine);
+    sid_snapshot_get_int(&sid_stereo_handle, "SidStereo", &sids);
 
     /* Added in 1.2, for the 1st SID module the amount of SIDs is saved 1st */
     if (!sidnr) {
@@ -134,7 +189,7 @@ static int sid_snapshot_write_module_simple(snapshot_t *s, int sidnr)
 
     /* Added in 1.2, for the 2nd SID module the address is saved */
     if (sidnr == 1) {
-        resources_get_int("SidStereoAddressStart", &sid_address);
+        sid_snapshot_get_int(&sid_stereo_address_handle, "SidStereoAddressStart", &sid_address);
         if (SMW_W(m, (uint16_t)sid_address) < 0) {
             goto fail;
         }
@@ -142,7 +197,7 @@ static int sid_snapshot_write_module_simple(snapshot_t *s, int sidnr)
 
     /* Added in 1.2, for the 3rd SID module the address is saved */
     if (sidnr == 2) {
-        resources_get_int("SidTripleAddressStart", &sid_address);
+        sid_snapshot_get_int(&sid_triple_address_handle, "SidTripleAddressStart", &sid_address);
         if (SMW_W(m, (uint16_t)sid_address) < 0) {
             goto fail;
         }
@@ -207,41 +262,46 @@ static int sid_snapshot_read_module_simple(snapshot_t *s, int sidnr)
     /* Handle 1.3 snapshots differently */
     if (SNAPVAL(major_version, minor_version, 1, 3)) {
         if (!sidnr) {
-            if (SMR_B_INT(m, &sids) < 0) {
-                goto fail;
-            }
-            resources_set_int("SidStereo", sids);
             if (0
+                || SMR_B_INT(m, &sids) < 0
                 || SMR_B(m, &tmp[0]) < 0
                 || SMR_B(m, &tmp[1]) < 0) {
                 goto fail;
             }
-            screenshot_prepare_reopen();
-            sound_close();
-            screenshot_try_reopen();
-            resources_set_int("Sound", (int)tmp[0]);
-
             intended_sid_engine = tmp[1];
-            set_sid_engine_with_fallback(tmp[1]);
+            sid_hot_restore = sid_snapshot_setup_unchanged(sids, (int)tmp[0], (int)tmp[1]);
+
+            if (!sid_hot_restore) {
+                resources_set_int("SidStereo", sids);
+                screenshot_prepare_reopen();
+                sound_close();
+                screenshot_try_reopen();
+                resources_set_int("Sound", (int)tmp[0]);
+                set_sid_engine_with_fallback(tmp[1]);
+            }
         } else {
             if (SMR_W_INT(m, &sid_address) < 0) {
                 goto fail;
             }
         }
         if (sidnr == 1) {
-            resources_set_int("SidStereoAddressStart", sid_address);
+            sid_snapshot_set_address(&sid_stereo_address_handle, "SidStereoAddressStart", sid_address);
         }
         if (sidnr == 2) {
-            resources_set_int("SidTripleAddressStart", sid_address);
+            sid_snapshot_set_address(&sid_triple_address_handle, "SidTripleAddressStart", sid_address);
         }
         if (SMR_BA(m, tmp + 2, 32) < 0) {
             goto fail;
         }
         memcpy(sid_get_siddata(sidnr), &tmp[2], 32);
-        sound_open();
+        if (!sid_hot_restore) {
+            sound_open();
+        }
         return snapshot_module_close(m);
     }
 
+    sid_hot_restore = 0;
+
     /* Handle 1.2 snapshots differently */
     if (SNAPVAL(major_version, minor_version, 1, 2)) {
         if (!sidnr) {
@@ -874,8 +934,8 @@ static int sid_snapshot_write_module_extended(snapshot_t *s, int sidnr)
             break;
     }
 
-    resources_get_int("Sound", &sound);
-    resources_get_int("SidEngine", &sid_engine);
+    sid_snapshot_get_int(&sound_handle, "Sound", &sound);
+    sid_snapshot_get_int(&sid_engine_handle, "SidEngine", &sid_engine);
 
     m = snapshot_module_create(s, snap_module_name_extended, SNAP_MAJOR_EXTENDED, SNAP_MINOR_EXTENDED);
 
@@ -942,7 +1002,7 @@ static int sid_snapshot_read_module_extended(snapshot_t *s, int sidnr)
     int i;
     uint8_t *siddata;
 
-    resources_get_int("SidEngine", &sid_engine);
+    sid_snapshot_get_int(&sid_engine_handle, "SidEngine", &sid_engine);
 
     switch (sidnr) {
         default:
@@ -1045,7 +1105,7 @@ int sid_snapshot_write_module(snapshot_t *s)
     int sids = 0;
     int i;
 
-    resources_get_int("SidStereo", &sids);
+    sid_snapshot_get_int(&sid_stereo_handle, "SidStereo", &sids);
 
     ++sids;
 
@@ -1075,7 +1135,7 @@ int sid_snapshot_read_module(snapshot_t *s)
         return -1;
     }
 
-    resources_get_int("SidStereo", &sids);
+    sid_snapshot_get_int(&sid_stereo_handle, "SidStereo", &sids);
     ++sids;
 
     for (i = 1; i < sids; ++i) {
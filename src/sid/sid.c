@@ -328,11 +328,14 @@ void sid_reset(void)
 
 static int sidengine;
 
+static resource_handle_t sid_engine_handle = RESOURCE_HANDLE_NONE;
+static resource_handle_t sid_stereo_handle = RESOURCE_HANDLE_NONE;
+
 sound_t *sid_sound_machine_open(int chipno)
 {
     sidengine = 0;
 
-    if (resources_get_int("SidEngine", &sidengine) < 0) {
+    if (resources_handle_get_int(resources_resolve_handle(&sid_engine_handle, "SidEngine"), &sidengine) < 0) {
         return NULL;
     }
 
@@ -583,7 +586,7 @@ int sid_sound_machine_channels(void)
 {
     int channels = 0;
 
-    resources_get_int("SidStereo", &channels);
+    resources_handle_get_int(resources_resolve_handle(&sid_stereo_handle, "SidStereo"), &channels);
 
     return channels + 1;
 }
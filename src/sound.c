@@ -237,6 +237,23 @@ static void sound_machine_close(sound_t *psid)
     }
 }
 
+/* Every enabled chip after the first one renders into this cleared scratch
+   buffer.  Unless the chunk came out silent, it is then mixed into the
+   output with `sound_audio_mix()', like the chips used to do themselves.  */
+static int16_t sound_mix_scratch[SOUND_CHANNELS_MAX * SOUND_BUFSIZE];
+
+static int sound_mix_is_silent(const int16_t *buf, int len)
+{
+    int j;
+
+    for (j = 0; j < len; j++) {
+        if (buf[j]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 /*
     There is some inconsistency about when the buffer should be overwritten and
     when mixed. Usually it's overwritten by SID and other cycle based engines,
@@ -247,8 +264,9 @@ static void sound_machine_close(sound_t *psid)
 */
 static int sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, int soc, int scc, int *delta_t)
 {
-    int i;
+    int i, j;
     int temp;
+    int len;
 
     if (sound_calls[0]->cycle_based() || (!sound_calls[0]->cycle_based() && sound_calls[0]->chip_enabled)) {
         temp = sound_calls[0]->calculate_samples(psid, pbuf, nr, soc, scc, delta_t);
@@ -257,9 +275,19 @@ static int sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr
         temp = nr;
     }
 
+    len = temp * soc;
+
     for (i = 1; i < (offset >> 5); i++) {
-        if (sound_calls[i]->chip_enabled) {
-            sound_calls[i]->calculate_samples(psid, pbuf, temp, soc, scc, delta_t);
+        if (!sound_calls[i]->chip_enabled) {
+            continue;
+        }
+        memset(sound_mix_scratch, 0, len * sizeof(int16_t));
+        if (sound_calls[i]->calculate_samples(psid, sound_mix_scratch, temp, soc, scc, delta_t) == 0
+            || sound_mix_is_silent(sound_mix_scratch, len)) {
+            continue;
+        }
+        for (j = 0; j < len; j++) {
+            pbuf[j] = sound_audio_mix(pbuf[j], sound_mix_scratch[j]);
         }
     }
     return temp;
@@ -1694,7 +1722,8 @@ int sound_dac_calculate_samples(sound_dac_t *dac, int16_t *pbuf, int value, int
         dac->value = value;
         sample = (int)dac->output;
         if (!sample) {
-            return nr;
+            /* silent */
+            return 0;
         }
         if (cs & 1) {
             pbuf[off] = sound_audio_mix(pbuf[off], sample);
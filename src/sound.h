@@ -232,6 +232,10 @@ extern const char *sound_device_name(unsigned int num);
 
 extern sound_t *sound_get_psid(unsigned int channel);
 
+/* All chips but the first one are handed a cleared buffer of their own by
+   `calculate_samples()', which may simply be overwritten.  Returning 0 tells
+   the mixer that the chip was silent, a buffer left all zero is skipped as
+   well.  */
 typedef struct sound_chip_s {
     sound_t *(*open)(int chipno);
     int (*init)(sound_t *psid, int speed, int cycles_per_sec);
@@ -254,6 +258,7 @@ typedef struct sound_dac_s {
 } sound_dac_t;
 
 extern void sound_dac_init(sound_dac_t *dac, int speed);
+/* Returns 0 if the DAC output is silent.  */
 extern int sound_dac_calculate_samples(sound_dac_t *dac, int16_t *pbuf, int value, int nr, int soc, int cs);
 
 /* recording related functions, equivalent to screenshot_... */
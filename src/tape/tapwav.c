@@ -0,0 +1,640 @@
+/*
+ * tapwav.c - Convert audio recordings of tapes into TAP images.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* The recording is read in blocks and converted into 8-bit mono samples
+   on the fly; WAV files with PCM, IEEE float, A-law or u-law samples and
+   VOC files with 8 or 16-bit PCM, A-law or u-law blocks are understood.
+   The samples are run through a DC-removing Schmitt trigger with a
+   hysteresis that follows the signal level, and edges are placed where the
+   signal crosses its mean.  Each pulse is recorded as a positive half wave
+   followed by a negative one, so the distance between two rising edges
+   is written out as one TAP version 1 pulse.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_STRINGS_H
+#include <strings.h>
+#endif
+
+#include "archdep.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "tap.h"
+#include "tapwav.h"
+#include "util.h"
+
+/* #define DEBUG_TAPWAV */
+
+#ifdef DEBUG_TAPWAV
+#define DBG(x)  log_debug x
+#else
+#define DBG(x)
+#endif
+
+/* Samples per block used for the DC offset and level estimation.  At
+   44.1kHz this spans roughly 100 ms, which holds plenty of tape cycles.  */
+#define TAPWAV_BLOCK_SIZE   4096
+
+/* Hysteresis is this fraction (as a shift) of the signal level.  The
+   level follows the block peak up at once and decays by 1/8 per block, so
+   the noise in a pause after loud blocks does not make pulses.  */
+#define TAPWAV_HYST_SHIFT   2
+#define TAPWAV_HYST_MIN     4
+#define TAPWAV_LEVEL_DECAY  3
+
+/* Edges are placed with this many bits below a sample.  */
+#define TAPWAV_FRAC_BITS    8
+
+/* Longest pulse a TAP version 1 long gap can hold.  */
+#define TAPWAV_MAX_GAP      0xffffff
+
+#define TAPWAV_OUT_SIZE     4096
+
+/* Bytes read from the recording at a time.  */
+#define TAPWAV_IN_SIZE      8192
+
+/* Sample encodings.  */
+#define TAPWAV_PCM          0
+#define TAPWAV_FLOAT        1
+#define TAPWAV_ALAW         2
+#define TAPWAV_ULAW         3
+
+typedef struct tapwav_out_s {
+    FILE *fd;
+    uint8_t buffer[TAPWAV_OUT_SIZE];
+    unsigned int pos;
+    unsigned int size;
+    int error;
+} tapwav_out_t;
+
+typedef struct tapwav_in_s {
+    FILE *fd;
+    int voc;                /* VOC file, else WAV */
+    int encoding;           /* TAPWAV_PCM, TAPWAV_FLOAT, TAPWAV_ALAW or TAPWAV_ULAW */
+    unsigned int channels;
+    unsigned int bits;
+    unsigned int rate;
+    uint32_t left;          /* bytes left in the data chunk or VOC block */
+    uint32_t silence;       /* samples left in a VOC silence block */
+    unsigned int voc_rate;  /* rate and channels from a VOC extra info block */
+    unsigned int voc_channels;
+    uint8_t buffer[TAPWAV_IN_SIZE];
+    uint8_t samples[TAPWAV_BLOCK_SIZE];
+} tapwav_in_t;
+
+static const char *audio_extensions[] = { ".wav", ".voc", NULL };
+
+/* ------------------------------------------------------------------------- */
+
+int tapwav_is_audio_name(const char *name)
+{
+    size_t l = strlen(name);
+    int i;
+
+    for (i = 0; audio_extensions[i] != NULL; i++) {
+        if (l >= 4 && strcasecmp(name + l - 4, audio_extensions[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void tapwav_out_flush(tapwav_out_t *out)
+{
+    if (out->pos > 0) {
+        if (fwrite(out->buffer, 1, out->pos, out->fd) != out->pos) {
+            out->error = 1;
+        }
+        out->size += out->pos;
+        out->pos = 0;
+    }
+}
+
+inline static void tapwav_out_byte(tapwav_out_t *out, uint8_t b)
+{
+    if (out->pos == TAPWAV_OUT_SIZE) {
+        tapwav_out_flush(out);
+    }
+    out->buffer[out->pos++] = b;
+}
+
+static void tapwav_out_pulse(tapwav_out_t *out, uint64_t cycles)
+{
+    while (cycles > TAPWAV_MAX_GAP) {
+        tapwav_out_byte(out, 0);
+        tapwav_out_byte(out, 0xff);
+        tapwav_out_byte(out, 0xff);
+        tapwav_out_byte(out, 0xff);
+        cycles -= TAPWAV_MAX_GAP;
+    }
+    if (cycles >= 8 && cycles < 256 * 8) {
+        tapwav_out_byte(out, (uint8_t)(cycles / 8));
+    } else if (cycles > 0) {
+        tapwav_out_byte(out, 0);
+        tapwav_out_byte(out, (uint8_t)(cycles & 0xff));
+        tapwav_out_byte(out, (uint8_t)((cycles >> 8) & 0xff));
+        tapwav_out_byte(out, (uint8_t)((cycles >> 16) & 0xff));
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int tapwav_in_bytes(tapwav_in_t *in, uint8_t *buf, size_t n)
+{
+    return fread(buf, 1, n, in->fd) == n ? 0 : -1;
+}
+
+static int tapwav_in_skip(tapwav_in_t *in, uint32_t n)
+{
+    return fseek(in->fd, (long)n, SEEK_CUR);
+}
+
+/* Check the sample format, returns the size of one frame or 0.  */
+static unsigned int tapwav_in_frame_size(tapwav_in_t *in)
+{
+    if (in->channels == 0 || in->rate == 0) {
+        return 0;
+    }
+    if (in->encoding == TAPWAV_PCM
+        && in->bits != 8 && in->bits != 16 && in->bits != 24 && in->bits != 32) {
+        return 0;
+    }
+    if (in->encoding == TAPWAV_FLOAT && in->bits != 32 && in->bits != 64) {
+        return 0;
+    }
+    if ((in->encoding == TAPWAV_ALAW || in->encoding == TAPWAV_ULAW) && in->bits != 8) {
+        return 0;
+    }
+    return in->channels * in->bits / 8;
+}
+
+/* Go to the data chunk of a WAV file.  */
+static int tapwav_wav_open(tapwav_in_t *in)
+{
+    uint8_t header[24];
+    uint32_t size;
+    unsigned int tag;
+    int have_fmt = 0;
+
+    if (tapwav_in_bytes(in, header, 12) < 0
+        || memcmp(header, "RIFF", 4) != 0
+        || memcmp(header + 8, "WAVE", 4) != 0) {
+        return -1;
+    }
+
+    while (tapwav_in_bytes(in, header, 8) == 0) {
+        size = util_le_buf_to_dword(header + 4);
+        if (memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+            if (tapwav_in_bytes(in, header, 16) < 0) {
+                return -1;
+            }
+            tag = util_le_buf_to_word(header);
+            in->channels = util_le_buf_to_word(header + 2);
+            in->rate = util_le_buf_to_dword(header + 4);
+            in->bits = util_le_buf_to_word(header + 14);
+            size -= 16;
+            if (tag == 0xfffe && size >= 10) {
+                /* WAVE_FORMAT_EXTENSIBLE, the format is in the sub format */
+                if (tapwav_in_bytes(in, header, 10) < 0) {
+                    return -1;
+                }
+                tag = util_le_buf_to_word(header + 8);
+                size -= 10;
+            }
+            if (tag == 1) {
+                in->encoding = TAPWAV_PCM;
+            } else if (tag == 3) {
+                in->encoding = TAPWAV_FLOAT;
+            } else if (tag == 6) {
+                in->encoding = TAPWAV_ALAW;
+            } else if (tag == 7) {
+                in->encoding = TAPWAV_ULAW;
+            } else {
+                log_error(LOG_DEFAULT, "tapwav: unsupported WAV format 0x%04x.", tag);
+                return -1;
+            }
+            have_fmt = 1;
+        } else if (memcmp(header, "data", 4) == 0) {
+            if (!have_fmt || tapwav_in_frame_size(in) == 0) {
+                return -1;
+            }
+            in->left = size;
+            return 0;
+        }
+        if (tapwav_in_skip(in, size + (size & 1)) < 0) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/* Go to the next VOC block with samples or silence.  Returns -1 at the
+   end of the file.  */
+static int tapwav_voc_next(tapwav_in_t *in)
+{
+    uint8_t header[12];
+    uint32_t size;
+    unsigned int rate;
+
+    while (tapwav_in_bytes(in, header, 1) == 0 && header[0] != 0) {
+        if (tapwav_in_bytes(in, header + 1, 3) < 0) {
+            return -1;
+        }
+        size = header[1] | (header[2] << 8) | ((uint32_t)header[3] << 16);
+        switch (header[0]) {
+            case 1:
+                if (size < 2 || tapwav_in_bytes(in, header, 2) < 0 || header[1] != 0) {
+                    return -1;
+                }
+                if (in->voc_rate != 0) {
+                    rate = in->voc_rate;
+                    in->channels = in->voc_channels;
+                    in->voc_rate = 0;
+                } else {
+                    rate = 1000000 / (256 - header[0]);
+                    in->channels = 1;
+                }
+                in->encoding = TAPWAV_PCM;
+                in->bits = 8;
+                in->left = size - 2;
+                break;
+            case 2:
+                if (tapwav_in_frame_size(in) == 0) {
+                    return -1;
+                }
+                in->left = size;
+                return 0;
+            case 3:
+                if (size < 3 || tapwav_in_bytes(in, header, 3) < 0) {
+                    return -1;
+                }
+                rate = 1000000 / (256 - header[2]);
+                in->silence = util_le_buf_to_word(header) + 1;
+                size -= 3;
+                if (tapwav_in_skip(in, size) < 0) {
+                    return -1;
+                }
+                if (in->rate == 0) {
+                    in->rate = rate;
+                }
+                return 0;
+            case 8:
+                if (size < 4 || tapwav_in_bytes(in, header, 4) < 0) {
+                    return -1;
+                }
+                in->voc_channels = header[3] + 1;
+                in->voc_rate = 256000000 / ((65536 - util_le_buf_to_word(header)) * in->voc_channels);
+                if (tapwav_in_skip(in, size - 4) < 0) {
+                    return -1;
+                }
+                continue;
+            case 9:
+                if (size < 12 || tapwav_in_bytes(in, header, 12) < 0) {
+                    return -1;
+                }
+                rate = util_le_buf_to_dword(header);
+                in->bits = header[4];
+                in->channels = header[5];
+                switch (util_le_buf_to_word(header + 6)) {
+                    case 0:     /* 8-bit unsigned */
+                    case 4:     /* 16-bit signed */
+                        if (util_le_buf_to_word(header + 6) != (in->bits == 8 ? 0 : 4)) {
+                            log_error(LOG_DEFAULT, "tapwav: unsupported VOC codec %u.", util_le_buf_to_word(header + 6));
+                            return -1;
+                        }
+                        in->encoding = TAPWAV_PCM;
+                        break;
+                    case 6:     /* A-law */
+                        in->encoding = TAPWAV_ALAW;
+                        break;
+                    case 7:     /* u-law */
+                        in->encoding = TAPWAV_ULAW;
+                        break;
+                    default:
+                        log_error(LOG_DEFAULT, "tapwav: unsupported VOC codec %u.", util_le_buf_to_word(header + 6));
+                        return -1;
+                }
+                in->left = size - 12;
+                break;
+            default:
+                if (tapwav_in_skip(in, size) < 0) {
+                    return -1;
+                }
+                continue;
+        }
+
+        if (in->rate == 0) {
+            in->rate = rate;
+        } else if (rate != in->rate) {
+            log_warning(LOG_DEFAULT, "tapwav: VOC block at %uHz read as %uHz.", rate, in->rate);
+        }
+        if (tapwav_in_frame_size(in) == 0) {
+            return -1;
+        }
+        return 0;
+    }
+    return -1;
+}
+
+static int tapwav_voc_open(tapwav_in_t *in)
+{
+    uint8_t header[26];
+
+    if (tapwav_in_bytes(in, header, 26) < 0
+        || memcmp(header, "Creative Voice File\x1a", 20) != 0
+        || fseek(in->fd, (long)util_le_buf_to_word(header + 20), SEEK_SET) != 0) {
+        return -1;
+    }
+    in->voc = 1;
+
+    return tapwav_voc_next(in);
+}
+
+/* Expand a G.711 A-law sample to 16 bits.  */
+static int tapwav_alaw(uint8_t a)
+{
+    int seg, t;
+
+    a ^= 0x55;
+    t = (a & 0x0f) << 4;
+    seg = (a & 0x70) >> 4;
+    if (seg == 0) {
+        t += 8;
+    } else {
+        t = (t + 0x108) << (seg - 1);
+    }
+    return (a & 0x80) ? t : -t;
+}
+
+/* Expand a G.711 u-law sample to 16 bits.  */
+static int tapwav_ulaw(uint8_t u)
+{
+    int t;
+
+    u = (uint8_t)~u;
+    t = (((u & 0x0f) << 3) + 0x84) << ((u & 0x70) >> 4);
+    return (u & 0x80) ? (0x84 - t) : (t - 0x84);
+}
+
+/* Convert the first channel of `frames' frames from the input buffer.  */
+static void tapwav_in_convert(tapwav_in_t *in, uint8_t *samples, unsigned int frames)
+{
+    unsigned int frame_size = in->channels * in->bits / 8;
+    unsigned int i;
+    const uint8_t *p = in->buffer;
+    float f;
+    double d;
+
+    for (i = 0; i < frames; i++, p += frame_size) {
+        if (in->encoding == TAPWAV_FLOAT) {
+            if (in->bits == 32) {
+                memcpy(&f, p, sizeof(float));
+                d = f;
+            } else {
+                memcpy(&d, p, sizeof(double));
+            }
+            d = d * 128.0 + 128.0;
+            samples[i] = (uint8_t)(d < 0.0 ? 0 : (d > 255.0 ? 255 : d));
+        } else if (in->encoding == TAPWAV_ALAW) {
+            samples[i] = (uint8_t)((tapwav_alaw(p[0]) >> 8) + 0x80);
+        } else if (in->encoding == TAPWAV_ULAW) {
+            samples[i] = (uint8_t)((tapwav_ulaw(p[0]) >> 8) + 0x80);
+        } else if (in->bits == 8) {
+            samples[i] = p[0];
+        } else {
+            /* signed little endian, the top byte is enough */
+            samples[i] = (uint8_t)(p[in->bits / 8 - 1] + 0x80);
+        }
+    }
+}
+
+/* Read up to `n' samples, returns the number read, 0 at the end.  */
+static unsigned int tapwav_in_read(tapwav_in_t *in, uint8_t *samples, unsigned int n)
+{
+    unsigned int frame_size, frames;
+
+    while (1) {
+        if (in->silence > 0) {
+            frames = in->silence < n ? in->silence : n;
+            memset(samples, 0x80, frames);
+            in->silence -= frames;
+            return frames;
+        }
+
+        frame_size = in->channels * in->bits / 8;
+        if (frame_size > 0 && in->left >= frame_size) {
+            frames = in->left / frame_size;
+            if (frames > n) {
+                frames = n;
+            }
+            if (frames > TAPWAV_IN_SIZE / frame_size) {
+                frames = TAPWAV_IN_SIZE / frame_size;
+            }
+            frames = (unsigned int)fread(in->buffer, frame_size, frames, in->fd);
+            if (frames == 0) {
+                /* a short file ends the recording */
+                in->left = 0;
+                return 0;
+            }
+            in->left -= frames * frame_size;
+            tapwav_in_convert(in, samples, frames);
+            return frames;
+        }
+
+        /* skip a partial frame and go on with the next block */
+        if (!in->voc
+            || tapwav_in_skip(in, in->left) < 0
+            || tapwav_voc_next(in) < 0) {
+            return 0;
+        }
+    }
+}
+
+/* Fill a whole block unless the recording ends.  */
+static unsigned int tapwav_in_block(tapwav_in_t *in)
+{
+    unsigned int n = 0, got;
+
+    while (n < TAPWAV_BLOCK_SIZE
+           && (got = tapwav_in_read(in, in->samples + n, TAPWAV_BLOCK_SIZE - n)) > 0) {
+        n += got;
+    }
+    return n;
+}
+
+/* Return the mean of the block, and its peak deviation from that mean in
+   `peak'.  Both loops are free of dependencies between iterations, so the
+   compiler can vectorise them.  */
+static int tapwav_block_level(const uint8_t *samples, unsigned int n, int *peak)
+{
+    unsigned int i;
+    unsigned int sum = 0;
+    int mean;
+    uint8_t lo = 0xff, hi = 0;
+
+    for (i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    for (i = 0; i < n; i++) {
+        lo = samples[i] < lo ? samples[i] : lo;
+        hi = samples[i] > hi ? samples[i] : hi;
+    }
+    mean = (int)(sum / n);
+    *peak = (hi - mean) > (mean - lo) ? (hi - mean) : (mean - lo);
+
+    return mean;
+}
+
+/* An edge is taken where the signal last went up through the mean before
+   it passed the upper threshold, interpolated between the two samples.
+   Edge positions are counted in 1/256 samples.  */
+static void tapwav_extract_pulses(tapwav_in_t *in, tapwav_out_t *out)
+{
+    uint64_t clock = (uint64_t)machine_get_cycles_per_second();
+    uint64_t rate = in->rate << TAPWAV_FRAC_BITS;
+    uint64_t start = 0, last_edge = 0, cross = 0;
+    int have_edge = 0;
+    int high = 0;
+    int crossed = 0;
+    int level = 0;
+    int prev = 0x80;
+    unsigned int n, i;
+
+    while ((n = tapwav_in_block(in)) > 0) {
+        const uint8_t *samples = in->samples;
+        int mean, peak, hyst, lo, hi;
+
+        mean = tapwav_block_level(samples, n, &peak);
+        level -= level >> TAPWAV_LEVEL_DECAY;
+        if (peak > level) {
+            level = peak;
+        }
+        hyst = level >> TAPWAV_HYST_SHIFT;
+        if (hyst < TAPWAV_HYST_MIN) {
+            hyst = TAPWAV_HYST_MIN;
+        }
+        lo = mean - hyst;
+        hi = mean + hyst;
+
+        for (i = 0; i < n; prev = samples[i++]) {
+            if (!high) {
+                if (prev <= mean && samples[i] > mean && start + i > 0) {
+                    cross = ((start + i - 1) << TAPWAV_FRAC_BITS)
+                            + (((uint64_t)(mean - prev) << TAPWAV_FRAC_BITS) / (unsigned int)(samples[i] - prev));
+                    crossed = 1;
+                }
+                if (samples[i] > hi) {
+                    /* Without a crossing the signal was above the mean since
+                       the start or since the mean moved at a new block.  */
+                    if (!crossed) {
+                        cross = (start + i) << TAPWAV_FRAC_BITS;
+                    }
+                    crossed = 0;
+                    high = 1;
+                    if (have_edge) {
+                        tapwav_out_pulse(out, ((cross - last_edge) * clock + rate / 2) / rate);
+                    }
+                    last_edge = cross;
+                    have_edge = 1;
+                }
+            } else if (samples[i] < lo) {
+                high = 0;
+            }
+        }
+        start += n;
+    }
+
+    /* Trailing silence.  */
+    if (have_edge && (start << TAPWAV_FRAC_BITS) > last_edge) {
+        tapwav_out_pulse(out, (((start << TAPWAV_FRAC_BITS) - last_edge) * clock + rate / 2) / rate);
+    }
+}
+
+/* Convert the audio recording `name' into the TAP image `tap_name'.  */
+int tapwav_convert(const char *name, const char *tap_name)
+{
+    uint8_t header[TAP_HDR_SIZE];
+    tapwav_in_t *in;
+    tapwav_out_t *out;
+    int retval = 0;
+
+    in = lib_calloc(1, sizeof(tapwav_in_t));
+    in->fd = fopen(name, MODE_READ);
+    if (in->fd == NULL) {
+        lib_free(in);
+        return -1;
+    }
+    if (tapwav_wav_open(in) < 0) {
+        FILE *fd = in->fd;
+
+        memset(in, 0, sizeof(tapwav_in_t));
+        in->fd = fd;
+        rewind(in->fd);
+        if (tapwav_voc_open(in) < 0) {
+            fclose(in->fd);
+            lib_free(in);
+            return -1;
+        }
+    }
+
+    out = lib_calloc(1, sizeof(tapwav_out_t));
+    out->fd = fopen(tap_name, MODE_WRITE);
+    if (out->fd == NULL) {
+        fclose(in->fd);
+        lib_free(in);
+        lib_free(out);
+        return -1;
+    }
+
+    /* The size is filled in once all the pulses are known.  */
+    memset(header, 0, sizeof(header));
+    memcpy(header + TAP_HDR_MAGIC_OFFSET, "C64-TAPE-RAW", 12);
+    header[TAP_HDR_VERSION] = 1;
+    if (fwrite(header, 1, TAP_HDR_SIZE, out->fd) != TAP_HDR_SIZE) {
+        out->error = 1;
+    }
+
+    tapwav_extract_pulses(in, out);
+    tapwav_out_flush(out);
+
+    util_dword_to_le_buf(header + TAP_HDR_LEN, out->size);
+    if (out->error
+        || out->size == 0
+        || fseek(out->fd, TAP_HDR_LEN, SEEK_SET) != 0
+        || fwrite(header + TAP_HDR_LEN, 1, 4, out->fd) != 4) {
+        retval = -1;
+    }
+
+    DBG(("tapwav: %s at %uHz, %u TAP bytes.", name, in->rate, out->size));
+
+    fclose(in->fd);
+    lib_free(in);
+    fclose(out->fd);
+    lib_free(out);
+
+    return retval;
+}
@@ -51,10 +51,13 @@
 #include "archdep.h"
 #include "cmdline.h"
 #include "crc32.h"
+#include "interrupt.h"
 #include "lib.h"
 #include "log.h"
 #include "machine.h"
 #include "maincpu.h"
+#include "mem.h"
+#include "mos6510.h"
 #include "resources.h"
 #include "snapshot.h"
 #include "tapeport.h"
@@ -67,6 +70,7 @@ static int tapecart_enabled       = 0;
 static int tapecart_update_tcrt   = 0;
 static int tapecart_optimize_tcrt = 0;
 static int tapecart_loglevel      = 0;
+static int tapecart_accelerate    = 0;
 
 /* ------------------------------------------------------------------------- */
 
@@ -98,11 +102,14 @@ static void    tapecart_logic_alarm_handler(CLOCK offset, void *unused);
 
 static void    tapecart_set_mode(tapecart_mode_t mode);
 static clock_t fasttx_byte_advance(void);
+static clock_t fastload_accel_handshake(void);
 static clock_t cmdmode_receive_command(void);
 
 static int     load_tcrt(const char *filename, tapecart_memory_t *tcmem);
 static void    update_tcrt(void);
 
+static const unsigned char default_loader[TAPECART_LOADER_SIZE];
+
 static tapeport_device_t tapecart_device = {
     TAPEPORT_DEVICE_TAPECART,
     "tapecart",
@@ -205,6 +212,18 @@ typedef enum { /* order matters! */
 
 static fasttx_state_t      fasttx_state;
 
+/* addresses within the default loader */
+#define LOADER_START          0x0351
+#define LOADER_INFO_RETURN    0x037d /* return address of the info block getbyte */
+#define LOADER_DATA_RETURN    0x0386 /* return address of the data getbyte */
+#define LOADER_LOAD_COMPLETE  0x039b
+#define LOADER_HANDSHAKE_DONE 0x03be /* just after "stx $01" in getbyte */
+#define LOADER_HANDSHAKE      0x03f3 /* handshake value, end of the code */
+#define LOADER_INFO_BLOCK     0xaa
+
+/* set while the first handshake of an accelerated fastload is expected */
+static int fastload_accel_pending;
+
 /** shared between fastload mode and command mode */
 static wait_handler_t  transfer_complete;
 /* 256 bytes needed for dir_lookup */
@@ -414,6 +433,12 @@ static int set_tapecart_optimize_tcrt(int value, void *unused_param)
     return 0;
 }
 
+static int set_tapecart_accelerate(int value, void *unused_param)
+{
+    tapecart_accelerate = !!value;
+    return 0;
+}
+
 static int set_tapecart_loglevel(int value, void *unused_param)
 {
     tapecart_loglevel = value;
@@ -427,6 +452,8 @@ static const resource_int_t resources_int[] = {
       &tapecart_update_tcrt, set_tapecart_update_tcrt, NULL },
     { "TapecartOptimizeTCRT", 1, RES_EVENT_STRICT, (resource_value_t)0,
       &tapecart_optimize_tcrt, set_tapecart_optimize_tcrt, NULL },
+    { "TapecartAccelerate", 1, RES_EVENT_STRICT, (resource_value_t)0,
+      &tapecart_accelerate, set_tapecart_accelerate, NULL },
     { "TapecartLogLevel", 0, RES_EVENT_NO, (resource_value_t)0,
       &tapecart_loglevel, set_tapecart_loglevel, NULL },
     RESOURCE_INT_LIST_END
@@ -472,6 +499,12 @@ static const cmdline_option_t cmdline_options[] =
     { "+tapecartoptimizetcrt", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
       NULL, NULL, "TapecartOptimizeTCRT", (resource_value_t)0,
       NULL, "Disable tapecart .tcrt image optimization on write" },
+    { "-tapecartaccelerate", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "TapecartAccelerate", (resource_value_t)1,
+      NULL, "Transfer fastload data directly when the default loader is used" },
+    { "+tapecartaccelerate", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "TapecartAccelerate", (resource_value_t)0,
+      NULL, "Always transfer fastload data bit by bit" },
     { "-tapecartloglevel", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
       NULL, NULL, "TapecartLogLevel", NULL,
       NULL, "Set tapecart log verbosity" },
@@ -724,7 +757,11 @@ static clock_t fasttx_nibble_advance(void)
 
     switch (fasttx_state) {
     case FASTTX_WAIT_WRITE_HIGH:
-        wait_handler    = fasttx_nibble_advance;
+        if (fastload_accel_pending) {
+            wait_handler = fastload_accel_handshake;
+        } else {
+            wait_handler = fasttx_nibble_advance;
+        }
         wait_for_signal = WAIT_WRITE_HIGH;
         transfer_byte   = *transfer_ptr++;
         transfer_remaining--;
@@ -841,6 +878,10 @@ static clock_t fastload_mode_init(void)
            tapecart_memory->flash + tapecart_memory->data_offset + 2,
            tapecart_memory->data_length - 2);
 
+    /* the default loader can be served without sending any bits */
+    fastload_accel_pending = tapecart_accelerate
+        && memcmp(tapecart_memory->loader, default_loader, TAPECART_LOADER_SIZE) == 0;
+
     /* transfer data after 100ms to give the C64 time to turn off the motor */
     return transmit_fast(machine_get_cycles_per_second() / 10,
                          tapecart_buffers->data,
@@ -849,6 +890,96 @@ static clock_t fastload_mode_init(void)
 }
 
 
+/* Runs between two instructions after the first handshake of the default
+   loader.  If the C64 is really waiting in its getbyte routine, all data is
+   stored at once and the CPU is put into the state the loader has after its
+   last byte.  Otherwise the normal transfer that was started continues.  */
+static void fastload_accel_trap(uint16_t addr, void *unused_data)
+{
+    uint8_t *info = tapecart_buffers->data;
+    unsigned int loadaddr = get_u16_le(info + 4);
+    unsigned int length = tapecart_memory->data_length - 2;
+    unsigned int sp = maincpu_get_sp();
+    unsigned int i;
+
+    if (tapecart_mode != MODE_FASTLOAD
+        || transfer_ptr != tapecart_buffers->data + 1
+        || addr != LOADER_HANDSHAKE_DONE
+        || maincpu_get_y() != 0x100 - 6
+        || mem_read((uint16_t)(0x100 + ((sp + 1) & 0xff))) != (LOADER_INFO_RETURN & 0xff)
+        || mem_read((uint16_t)(0x100 + ((sp + 2) & 0xff))) != (LOADER_INFO_RETURN >> 8)) {
+        return;
+    }
+
+    /* the data must not run over the loader, its stack or its variables */
+    if (tapecart_memory->data_length < 3
+        || loadaddr < 0x0400
+        || loadaddr + length > 0x10000) {
+        return;
+    }
+
+    /* the handshake value has been shifted out by the loader */
+    for (i = 0; i < LOADER_HANDSHAKE - LOADER_START; i++) {
+        if (mem_read((uint16_t)(LOADER_START + i)) != default_loader[i]) {
+            return;
+        }
+    }
+
+    /* the loader stores its data with LORAM, HIRAM and CHAREN driven low,
+       so mem_store() only hits RAM, even at $d000-$dfff, if the CPU port
+       has that setup already; otherwise the loader is left to run */
+    if ((mem_read(0x00) & 0x07) != 0x07 || (mem_read(0x01) & 0x07) != 0) {
+        return;
+    }
+
+    if (tapecart_loglevel > 0) {
+        log_message(tapecart_log, "accelerated fastload of %u bytes to $%04x",
+                    length, loadaddr);
+    }
+
+    /* tapecart side: transfer done, busy, post-transfer delay */
+    alarm_unset(tapecart_logic_alarm);
+    wait_for_signal    = WAIT_NONE;
+    transfer_ptr      += transfer_remaining;
+    transfer_remaining = 0;
+    set_sense(1);
+    set_write(1);
+    alarm_set(tapecart_logic_alarm, maincpu_clk + fastload_postdelay());
+
+    /* C64 side: info block, data and the loader's end state */
+    for (i = 0; i < 6; i++) {
+        mem_store((uint16_t)(LOADER_INFO_BLOCK + i), info[i]);
+    }
+    for (i = 0; i < length; i++) {
+        mem_store((uint16_t)(loadaddr + i), info[6 + i]);
+    }
+    mem_store((uint16_t)(LOADER_INFO_BLOCK + 4), (uint8_t)(loadaddr + length));
+    mem_store((uint16_t)(LOADER_INFO_BLOCK + 5), (uint8_t)((loadaddr + length) >> 8));
+
+    mem_store((uint16_t)(0x100 + ((sp + 1) & 0xff)), LOADER_DATA_RETURN & 0xff);
+    mem_store((uint16_t)(0x100 + ((sp + 2) & 0xff)), LOADER_DATA_RETURN >> 8);
+    mem_store(0x00, 0x2f);
+    mem_store(0x01, 0x30);
+
+    MOS6510_REGS_SET_SP(&maincpu_regs, (uint8_t)(sp + 2));
+    maincpu_set_a((loadaddr + length) & 0xff);
+    maincpu_set_x(((loadaddr + length) >> 8) & 0xff);
+    maincpu_set_y(0);
+    maincpu_set_sign(0);
+    maincpu_set_zero(1);
+    maincpu_set_carry(1);
+    maincpu_set_pc(LOADER_LOAD_COMPLETE);
+}
+
+static clock_t fastload_accel_handshake(void)
+{
+    fastload_accel_pending = 0;
+    interrupt_maincpu_trigger_trap(fastload_accel_trap, NULL);
+
+    /* keep going as usual in case the trap finds an unknown loader */
+    return fasttx_nibble_advance();
+}
+
 /* ---------------------------------------------------------------------*/
 /*  command mode functions                                              */
 /* ---------------------------------------------------------------------*/
@@ -1466,6 +1597,7 @@ static void tapecart_set_mode(tapecart_mode_t mode)
     alarm_unset(tapecart_logic_alarm);
     alarm_unset(tapecart_pulse_alarm);
 
+    fastload_accel_pending = 0;
     tapecart_mode = mode;
 
     switch (mode) {
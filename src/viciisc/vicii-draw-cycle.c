@@ -482,7 +482,13 @@ static DRAW_INLINE void draw_sprites8(unsigned int cycle_flags)
     if (cycle_is_sprite_dma1_dma2(cycle_flags)) {
         dma_cycle_2 = 1 << cycle_get_sprite_num(cycle_flags);
     }
-    candidate_bits = get_trigger_candidates(xpos);
+    /* nothing can trigger in this cycle if no sprite is pending and none
+       becomes pending at pixel 4 (the common case, all sprites off) */
+    if (sprite_pending_bits || (spr_en && vicii.sprite_display_bits)) {
+        candidate_bits = get_trigger_candidates(xpos);
+    } else {
+        candidate_bits = 0;
+    }
 
     /* process and render sprites */
     /* pixel 0 */
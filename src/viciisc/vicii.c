@@ -139,13 +139,23 @@ void vicii_handle_pending_alarms_external_write(void)
     return;
 }
 
+static resource_handle_t video_standard_handle = RESOURCE_HANDLE_NONE;
+
+static int vicii_get_video_standard(void)
+{
+    int video = MACHINE_SYNC_PAL;
+
+    resources_handle_get_int(resources_resolve_handle(&video_standard_handle, "MachineVideoStandard"), &video);
+    return video;
+}
+
 /* return pixel aspect ratio for current video mode
  * based on http://codebase64.com/doku.php?id=base:pixel_aspect_ratio
  */
 static float vicii_get_pixel_aspect(void)
 {
-    int video;
-    resources_get_int("MachineVideoStandard", &video);
+    int video = vicii_get_video_standard();
+
     switch (video) {
         case MACHINE_SYNC_PAL:
             return 0.93650794f;
@@ -163,8 +173,8 @@ static float vicii_get_pixel_aspect(void)
 /* return type of monitor used for current video mode */
 static int vicii_get_crt_type(void)
 {
-    int video;
-    resources_get_int("MachineVideoStandard", &video);
+    int video = vicii_get_video_standard();
+
     switch (video) {
         case MACHINE_SYNC_PAL:
         case MACHINE_SYNC_PALN:
@@ -216,6 +216,11 @@ static int speed_eval_suspended = 1;
 static int sync_reset = 1;
 static CLOCK speed_eval_prev_clk;
 
+/* Host time and machine clock when the emulation started, for the
+   -limitcycles benchmark report.  */
+static unsigned long benchmark_start_time;
+static double benchmark_start_clk;
+
 /* Initialize vsync timers and set relative speed of emulation in percent. */
 static int set_timer_speed(int speed)
 {
@@ -263,6 +268,7 @@ static void display_speed(int num_frames)
 static void clk_overflow_callback(CLOCK amount, void *data)
 {
     speed_eval_prev_clk -= amount;
+    benchmark_start_clk -= amount;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -289,6 +295,32 @@ void vsync_init(void (*hook)(void))
 
     vsyncarch_freq = vsyncarch_frequency();  /* number of units per second */
     /* log_message(LOG_DEFAULT, "VSYNC Init freq: %u", (unsigned int)vsyncarch_freq); */
+
+    benchmark_start_time = vsyncarch_gettime();
+    benchmark_start_clk = (double)maincpu_clk;
+}
+
+/* Log the average emulation speed since vsync_init(); called when the CPU
+   reaches the -limitcycles limit, so that `-warp -limitcycles <n>' can be
+   used as a headless benchmark.  Returns the speed relative to the real
+   machine (1.0 = 100%).  */
+double vsync_log_benchmark(void)
+{
+    double diff_sec, diff_clk, factor;
+
+    diff_sec = (double)(signed long)(vsyncarch_gettime() - benchmark_start_time) / vsyncarch_freq;
+    diff_clk = (double)maincpu_clk - benchmark_start_clk;
+
+    if (diff_sec <= 0.0 || cycles_per_sec <= 0) {
+        return 0.0;
+    }
+
+    factor = diff_clk / (cycles_per_sec * diff_sec);
+
+    log_message(LOG_DEFAULT, "Benchmark: %.0f cycles in %.2f s, %.3f emulated MHz, %.1f%% speed.",
+                diff_clk, diff_sec, diff_clk / diff_sec / 1000000.0, factor * 100.0);
+
+    return factor;
 }
 
 /* FIXME: This function is not needed here anymore, however it is
@@ -50,10 +50,15 @@
 #include <strings.h>
 #endif
 
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
 #include "archdep.h"
 #include "ioutil.h"
 #include "lib.h"
 #include "log.h"
+#include "tapwav.h"
 #include "util.h"
 #include "zfile.h"
 #include "zipcode.h"
@@ -76,7 +81,8 @@ enum compression_type {
     COMPR_ARCHIVE,
     COMPR_ZIPCODE,
     COMPR_LYNX,
-    COMPR_TZX
+    COMPR_TZX,
+    COMPR_TAPWAV
 };
 
 /* This defines a linked list of all the compressed files that have been
@@ -96,6 +102,14 @@ typedef struct zfile_s zfile_t;
 
 static zfile_t *zfile_list = NULL;
 
+/* The TAP image of the last converted audio recording.  It is kept until
+   another recording is converted, so reopening the tape (eg. when probing
+   the image type) does not convert it again.  */
+static char *tapwav_orig_name = NULL;
+static char *tapwav_tmp_name = NULL;
+static off_t tapwav_orig_size = 0;
+static time_t tapwav_orig_mtime = 0;
+
 static log_t zlog = LOG_ERR;
 
 /* ------------------------------------------------------------------------- */
@@ -183,8 +197,36 @@ static void zfile_list_add(const char *tmp_name,
     zfile_list = new_zfile;
 }
 
+/* Forget the converted audio recording, removing its TAP image unless it is
+   still open.  */
+static void tapwav_cache_drop(void)
+{
+    zfile_t *p;
+
+    if (tapwav_tmp_name != NULL) {
+        for (p = zfile_list; p != NULL; p = p->next) {
+            if (p->tmp_name != NULL && strcmp(p->tmp_name, tapwav_tmp_name) == 0) {
+                break;
+            }
+        }
+        if (p == NULL) {
+            ioutil_remove(tapwav_tmp_name);
+        }
+    }
+    lib_free(tapwav_orig_name);
+    lib_free(tapwav_tmp_name);
+    tapwav_orig_name = NULL;
+    tapwav_tmp_name = NULL;
+}
+
+static int tapwav_is_cached(const char *tmp_name)
+{
+    return tapwav_tmp_name != NULL && strcmp(tmp_name, tapwav_tmp_name) == 0;
+}
+
 void zfile_shutdown(void)
 {
+    tapwav_cache_drop();
     zfile_list_destroy();
 }
 
@@ -349,6 +391,55 @@ static char *try_uncompress_with_tzx(const char *name)
     }
 }
 
+/* Audio recordings of tapes are converted into a TAP image in-process.  */
+static char *try_uncompress_with_tapwav(const char *name, int write_mode)
+{
+    char *tmp_name = NULL;
+    struct stat st;
+
+    /* Check whether the name sounds like an audio recording. */
+    if (!tapwav_is_audio_name(name)) {
+        return NULL;
+    }
+
+    /* The recording cannot be written back.  */
+    if (write_mode) {
+        return "";
+    }
+
+    if (stat(name, &st) < 0) {
+        return NULL;
+    }
+
+    /* Reuse the last conversion if the recording has not changed.  */
+    if (tapwav_orig_name != NULL
+        && strcmp(name, tapwav_orig_name) == 0
+        && st.st_size == tapwav_orig_size
+        && st.st_mtime == tapwav_orig_mtime
+        && util_file_exists(tapwav_tmp_name)) {
+        ZDEBUG(("try_uncompress_with_tapwav: reusing %s", tapwav_tmp_name));
+        return lib_stralloc(tapwav_tmp_name);
+    }
+
+    tmp_name = archdep_tmpnam();
+
+    ZDEBUG(("try_uncompress_with_tapwav: converting %s", name));
+    if (tapwav_convert(name, tmp_name) == 0) {
+        ZDEBUG(("try_uncompress_with_tapwav: OK"));
+        tapwav_cache_drop();
+        tapwav_orig_name = lib_stralloc(name);
+        tapwav_tmp_name = lib_stralloc(tmp_name);
+        tapwav_orig_size = st.st_size;
+        tapwav_orig_mtime = st.st_mtime;
+        return tmp_name;
+    } else {
+        ZDEBUG(("try_uncompress_with_tapwav: failed"));
+        ioutil_remove(tmp_name);
+        lib_free(tmp_name);
+        return NULL;
+    }
+}
+
 /* is the name zipcode -name? */
 static int is_zipcode_name(char *name)
 {
@@ -800,6 +891,10 @@ static enum compression_type try_uncompress(const char *name,
         return COMPR_TZX;
     }
 
+    if ((*tmp_name = try_uncompress_with_tapwav(name, write_mode)) != NULL) {
+        return COMPR_TAPWAV;
+    }
+
     return COMPR_NONE;
 }
 
@@ -936,6 +1031,12 @@ static int zfile_compress(const char *src, const char *dest,
         return -1;
     }
 
+    /* This shouldn't happen */
+    if (type == COMPR_TAPWAV) {
+        log_error(zlog, "compress: trying to compress audio tape recording.");
+        return -1;
+    }
+
     /* Check whether `compression_type' is a known one.  */
     if (type != COMPR_GZIP && type != COMPR_BZIP) {
         log_error(zlog, "compress: unknown compression type");
@@ -1105,8 +1206,9 @@ static int handle_close(zfile_t *ptr)
             return -1;
         }
 
-        /* Remove temporary file.  */
-        if (ioutil_remove(ptr->tmp_name) < 0) {
+        /* Remove temporary file, the converted audio recording is kept.  */
+        if (!(ptr->type == COMPR_TAPWAV && tapwav_is_cached(ptr->tmp_name))
+            && ioutil_remove(ptr->tmp_name) < 0) {
             log_error(zlog, "Cannot unlink `%s': %s", ptr->tmp_name, strerror(errno));
         }
     }
@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# c1541-batch-test.sh - Batch mode of c1541 with one and with several jobs.
+#
+# This file is part of VICE, the Versatile Commodore Emulator.
+# See README for copyright notice.
+#
+# Usage: c1541-batch-test.sh <c1541> [<images>]
+#
+# Builds a corpus of D64 images with a file of a different size on each,
+# then extracts the file from every image with `c1541 -batch', once with a
+# single job and once with four.  Every image must be reported as ok and
+# every extracted file must match the one that was written.  c1541 reports
+# the time of each run on stderr.
+
+C1541=$1
+IMAGES=${2:-200}
+
+fail() {
+    echo "c1541-batch-test: $*" >&2
+    exit 1
+}
+
+rm -rf batch-corpus batch-out1 batch-out4
+mkdir batch-corpus batch-out1 batch-out4 || fail "cannot create directories"
+
+i=0
+while [ $i -lt $IMAGES ]; do
+    seq 1 $((i * 37 % 4000 + 1)) > batch-corpus/data$i.txt
+    "$C1541" -format "game $i,$((i % 100))" d64 batch-corpus/game$i.d64 \
+        -write batch-corpus/data$i.txt prog > /dev/null \
+        || fail "cannot create batch-corpus/game$i.d64"
+    i=$((i + 1))
+done
+
+for jobs in 1 4; do
+    (cd batch-out$jobs && "../$C1541" -batch $jobs '../batch-corpus/*.d64' \
+        -read prog '{}.prg' > results.txt 2> log.txt)
+    tail -n 1 batch-out$jobs/log.txt | sed "s/^/$jobs job(s): /"
+    [ "$(grep -c '^ok' batch-out$jobs/results.txt)" -eq $IMAGES ] \
+        || fail "$jobs job(s): not every image was processed"
+    i=0
+    while [ $i -lt $IMAGES ]; do
+        cmp -s batch-corpus/data$i.txt batch-out$jobs/game$i.prg \
+            || fail "$jobs job(s): game$i.prg does not match"
+        i=$((i + 1))
+    done
+done
+
+echo "c1541-batch-test: all checks passed"
@@ -0,0 +1,267 @@
+/*
+ * c1541-host.c - System specific parts of c1541 for the host build.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* The Vita archdep.c cannot be built for the host.  These are the POSIX
+   versions of what c1541 uses, and no-ops for the parts of the emulator
+   that the image layers reference but c1541 never reaches.  */
+
+#include "vice.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "archdep.h"
+#include "fsdrive.h"
+#include "lib.h"
+#include "machine.h"
+#include "serial-iec.h"
+#include "serial.h"
+#include "util.h"
+#include "vdrive-snapshot.h"
+
+int archdep_init(int *argc, char **argv)
+{
+    return 0;
+}
+
+void archdep_shutdown(void)
+{
+}
+
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+FILE *archdep_open_default_log_file(void)
+{
+    return stdout;
+}
+
+int archdep_default_logger(const char *level_string, const char *txt)
+{
+    fprintf(stdout, "%s%s\n", level_string, txt);
+    return 0;
+}
+
+void archdep_startup_log_error(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+}
+
+char *archdep_default_resource_file_name(void)
+{
+    return lib_stralloc("vicerc");
+}
+
+int archdep_path_is_relative(const char *path)
+{
+    return path == NULL || *path != '/';
+}
+
+int archdep_expand_path(char **return_path, const char *orig_name)
+{
+    *return_path = lib_stralloc(orig_name);
+    return 0;
+}
+
+char *archdep_make_backup_filename(const char *fname)
+{
+    return util_concat(fname, "~", NULL);
+}
+
+char *archdep_filename_parameter(const char *name)
+{
+    return lib_stralloc(name);
+}
+
+char *archdep_quote_parameter(const char *name)
+{
+    return lib_stralloc(name);
+}
+
+void archdep_sanitize_filename(char *name)
+{
+    while (*name != '\0') {
+        if (*name == ARCHDEP_DIR_SEPARATOR) {
+            *name = '_';
+        }
+        name++;
+    }
+}
+
+int archdep_spawn(const char *name, char **argv,
+                  char **pstdout_redir, const char *stderr_redir)
+{
+    return -1;
+}
+
+char *archdep_tmpnam(void)
+{
+    char name[] = "/tmp/vice.XXXXXX";
+    int fd = mkstemp(name);
+
+    if (fd < 0) {
+        return NULL;
+    }
+    close(fd);
+    return lib_stralloc(name);
+}
+
+FILE *archdep_mkstemp_fd(char **filename, const char *mode)
+{
+    char name[] = "/tmp/vice.XXXXXX";
+    int fd = mkstemp(name);
+    FILE *f;
+
+    if (fd < 0) {
+        return NULL;
+    }
+    f = fdopen(fd, mode);
+    if (f == NULL) {
+        close(fd);
+        return NULL;
+    }
+    *filename = lib_stralloc(name);
+    return f;
+}
+
+int archdep_mkdir(const char *pathname, int mode)
+{
+    return mkdir(pathname, (mode_t)mode);
+}
+
+int archdep_rmdir(const char *pathname)
+{
+    return rmdir(pathname);
+}
+
+int archdep_rename(const char *oldpath, const char *newpath)
+{
+    return rename(oldpath, newpath);
+}
+
+int archdep_stat(const char *file_name, unsigned int *len, unsigned int *isdir)
+{
+    struct stat statbuf;
+
+    if (stat(file_name, &statbuf) < 0) {
+        *len = 0;
+        *isdir = 0;
+        return -1;
+    }
+    *len = (unsigned int)statbuf.st_size;
+    *isdir = S_ISDIR(statbuf.st_mode);
+    return 0;
+}
+
+int archdep_file_is_blockdev(const char *name)
+{
+    return 0;
+}
+
+int archdep_file_is_chardev(const char *name)
+{
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void fsdrive_init(void)
+{
+}
+
+void fsdrive_reset(void)
+{
+}
+
+void fsdrive_open(unsigned int device, uint8_t secondary, void (*st_func)(uint8_t))
+{
+}
+
+void fsdrive_close(unsigned int device, uint8_t secondary, void (*st_func)(uint8_t))
+{
+}
+
+void fsdrive_listentalk(unsigned int device, uint8_t secondary, void (*st_func)(uint8_t))
+{
+}
+
+void fsdrive_unlisten(unsigned int device, uint8_t secondary, void (*st_func)(uint8_t))
+{
+}
+
+void fsdrive_untalk(unsigned int device, uint8_t secondary, void (*st_func)(uint8_t))
+{
+}
+
+void fsdrive_write(unsigned int device, uint8_t secondary, uint8_t data, void (*st_func)(uint8_t))
+{
+}
+
+uint8_t fsdrive_read(unsigned int device, uint8_t secondary, void (*st_func)(uint8_t))
+{
+    return 0;
+}
+
+long machine_get_cycles_per_second(void)
+{
+    return 985248;
+}
+
+int serial_iec_open(unsigned int unit, unsigned int secondary, const char *name, unsigned int length)
+{
+    return -1;
+}
+
+int serial_iec_close(unsigned int unit, unsigned int secondary)
+{
+    return -1;
+}
+
+int serial_iec_read(unsigned int unit, unsigned int secondary, uint8_t *data)
+{
+    return -1;
+}
+
+int serial_realdevice_enable(void)
+{
+    return -1;
+}
+
+void serial_realdevice_disable(void)
+{
+}
+
+void vdrive_snapshot_init(void)
+{
+}
@@ -0,0 +1,14 @@
+/*
+ * config.h - Host configuration of c1541.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ */
+
+/* The Vita configuration, plus what batch mode uses on the host.  It is
+   found before src/config.h by the c1541 target only.  */
+
+#include "../../src/config.h"
+
+#define HAVE_FORK 1
+#define HAVE_GLOB_H 1
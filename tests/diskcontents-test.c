@@ -0,0 +1,317 @@
+/*
+ * diskcontents-test.c - Direct directory reader against the vdrive one.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Images of every type the direct reader handles are created, formatted
+   and filled with files through the virtual drive.  The directory read by
+   diskcontents_direct_read() must match the one the block reader gets
+   through a vdrive, also for a directory chain that loops.  Then the time
+   both need per preview is printed.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "attach.h"
+#include "cbmimage.h"
+#include "charset.h"
+#include "diskcontents-block.h"
+#include "diskcontents-direct.h"
+#include "diskimage.h"
+#include "imagecontents.h"
+#include "ioutil.h"
+#include "lib.h"
+#include "machine-bus.h"
+#include "machine-drive.h"
+#include "test.h"
+#include "types.h"
+#include "vdrive-command.h"
+#include "vdrive-iec.h"
+#include "vdrive-internal.h"
+#include "vdrive-snapshot.h"
+#include "vdrive.h"
+#include "zfile.h"
+
+#define BENCH_READS     200
+
+static const struct {
+    const char *name;
+    unsigned int type;
+    unsigned int files;
+} images[] = {
+    { "diskcontents.d64", DISK_IMAGE_TYPE_D64, 40 },
+    { "diskcontents.d71", DISK_IMAGE_TYPE_D71, 40 },
+    { "diskcontents.d81", DISK_IMAGE_TYPE_D81, 60 },
+    { "diskcontents.d80", DISK_IMAGE_TYPE_D80, 60 },
+    { "diskcontents.d82", DISK_IMAGE_TYPE_D82, 60 },
+    { "diskcontents.g64", DISK_IMAGE_TYPE_G64, 40 },
+    { NULL, 0, 0 }
+};
+
+static image_contents_t *block_read(const char *name)
+{
+    return diskcontents_block_read(vdrive_internal_open_fsimage(name, 1));
+}
+
+static int write_file(vdrive_t *vdrive, unsigned int n)
+{
+    static const char types[] = "PSU";
+    char name[32];
+    unsigned int i, length;
+
+    sprintf(name, "FILE %u,%c,W", n, types[n % 3]);
+    if (vdrive_iec_open(vdrive, (const uint8_t *)name, (unsigned int)strlen(name), 1, NULL)) {
+        return -1;
+    }
+    /* 0 to 12 blocks */
+    length = (n * 397) % 3000;
+    for (i = 0; i < length; i++) {
+        vdrive_iec_write(vdrive, (uint8_t)i, 1);
+    }
+    return vdrive_iec_close(vdrive, 1);
+}
+
+static int create_image(const char *name, unsigned int type, unsigned int files)
+{
+    vdrive_t *vdrive;
+    unsigned int n;
+    int status = 0;
+
+    ioutil_remove(name);
+    if (vdrive_internal_create_format_disk_image(name, "DIRECT READER,T1", type) < 0) {
+        return -1;
+    }
+    vdrive = vdrive_internal_open_fsimage(name, 0);
+    if (vdrive == NULL) {
+        return -1;
+    }
+    for (n = 0; n < files && status == 0; n++) {
+        status = write_file(vdrive, n);
+    }
+    /* a scratched file leaves an empty slot */
+    vdrive_command_execute(vdrive, (const uint8_t *)"S:FILE 3", 8);
+    vdrive_internal_close_disk_image(vdrive);
+
+    return status;
+}
+
+/* Link the last directory sector of a D64 back to the first one.  */
+static int make_circular(const char *name)
+{
+    FILE *fd;
+    uint8_t link[2];
+    long dir_track = 0x16500;       /* 18/0 */
+    long offset = dir_track + 256;  /* 18/1 */
+
+    fd = fopen(name, "r+b");
+    if (fd == NULL) {
+        return -1;
+    }
+    for (;;) {
+        if (fseek(fd, offset, SEEK_SET) != 0 || fread(link, 1, 2, fd) != 2) {
+            fclose(fd);
+            return -1;
+        }
+        if (link[0] != 18) {
+            break;
+        }
+        offset = dir_track + link[1] * 256;
+    }
+    link[0] = 18;
+    link[1] = 1;
+    fseek(fd, offset, SEEK_SET);
+    fwrite(link, 1, 2, fd);
+    fclose(fd);
+
+    return 0;
+}
+
+static unsigned int compare_contents(const char *name, image_contents_t *direct, image_contents_t *block)
+{
+    image_contents_file_list_t *d, *b;
+    unsigned int files = 0;
+
+    TEST_CHECK(direct != NULL);
+    TEST_CHECK(block != NULL);
+    if (direct == NULL || block == NULL) {
+        return 0;
+    }
+    TEST_CHECK(memcmp(direct->name, block->name, IMAGE_CONTENTS_NAME_LEN) == 0);
+    TEST_CHECK(memcmp(direct->id, block->id, IMAGE_CONTENTS_ID_LEN) == 0);
+    TEST_CHECK(direct->blocks_free == block->blocks_free);
+    if (direct->blocks_free != block->blocks_free) {
+        fprintf(stderr, "%s: %d blocks free, vdrive says %d\n", name,
+                direct->blocks_free, block->blocks_free);
+    }
+    for (d = direct->file_list, b = block->file_list; d && b; d = d->next, b = b->next) {
+        TEST_CHECK(memcmp(d->name, b->name, IMAGE_CONTENTS_FILE_NAME_LEN) == 0);
+        TEST_CHECK(memcmp(d->type, b->type, IMAGE_CONTENTS_TYPE_LEN) == 0);
+        TEST_CHECK(d->size == b->size);
+        files++;
+    }
+    TEST_CHECK(d == NULL && b == NULL);
+
+    return files;
+}
+
+static void check_image(const char *name, unsigned int files)
+{
+    image_contents_t *direct = diskcontents_direct_read(name);
+    image_contents_t *block = block_read(name);
+    unsigned int listed = compare_contents(name, direct, block);
+
+    printf("%s: %u files, %d blocks free\n", name, listed,
+           direct ? direct->blocks_free : -1);
+    /* one of them was scratched */
+    TEST_CHECK(listed == files - 1);
+
+    if (direct) {
+        image_contents_destroy(direct);
+    }
+    if (block) {
+        image_contents_destroy(block);
+    }
+}
+
+static double time_reads(const char *name, image_contents_t *(*reader)(const char *))
+{
+    clock_t start = clock();
+    unsigned int i;
+
+    for (i = 0; i < BENCH_READS; i++) {
+        image_contents_t *contents = reader(name);
+
+        if (contents) {
+            image_contents_destroy(contents);
+        }
+    }
+    return (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / BENCH_READS;
+}
+
+static void bench(void)
+{
+    unsigned int i;
+
+    for (i = 0; images[i].name != NULL; i++) {
+        printf("%s: %.0f us direct, %.0f us through vdrive per preview\n",
+               images[i].name,
+               time_reads(images[i].name, diskcontents_direct_read),
+               time_reads(images[i].name, block_read));
+    }
+}
+
+int main(void)
+{
+    unsigned int i;
+
+    vdrive_init();
+
+    for (i = 0; images[i].name != NULL; i++) {
+        TEST_CHECK(create_image(images[i].name, images[i].type, images[i].files) == 0);
+        check_image(images[i].name, images[i].files);
+    }
+
+    /* both readers stop where the chain comes back */
+    TEST_CHECK(create_image("diskcontents-loop.d64", DISK_IMAGE_TYPE_D64, 40) == 0);
+    TEST_CHECK(make_circular("diskcontents-loop.d64") == 0);
+    check_image("diskcontents-loop.d64", 40);
+
+    bench();
+
+    return test_result("diskcontents-test");
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The rest of the emulator as far as the disk image layers need it.  */
+
+int cbmimage_create_image(const char *name, unsigned int type)
+{
+    return disk_image_fsimage_create(name, type);
+}
+
+void charset_petcii_to_screencode_line(const uint8_t *line, uint8_t **buf,
+                                       unsigned int *len)
+{
+    *buf = NULL;
+    *len = 0;
+}
+
+uint8_t *charset_petconv_stralloc(uint8_t *in, int conv)
+{
+    return (uint8_t *)lib_stralloc((char *)in);
+}
+
+struct vdrive_s *file_system_get_vdrive(unsigned int unit)
+{
+    return NULL;
+}
+
+int ioutil_remove(const char *name)
+{
+    return remove(name);
+}
+
+int machine_bus_device_attach(unsigned int unit, const char *name,
+                              int (*getf)(struct vdrive_s *,
+                                          uint8_t *, unsigned int),
+                              int (*putf)(struct vdrive_s *, uint8_t,
+                                          unsigned int),
+                              int (*openf)(struct vdrive_s *,
+                                           const uint8_t *, unsigned int, unsigned int,
+                                           struct cbmdos_cmd_parse_s *),
+                              int (*closef)(struct vdrive_s *,
+                                            unsigned int),
+                              void (*flushf)(struct vdrive_s *,
+                                             unsigned int),
+                              void (*listenf)(struct vdrive_s *,
+                                              unsigned int))
+{
+    return 0;
+}
+
+int machine_bus_lib_read_sector(unsigned int unit, unsigned int track,
+                                unsigned int sector, uint8_t *buf)
+{
+    return -1;
+}
+
+void machine_drive_flush(void)
+{
+}
+
+void vdrive_snapshot_init(void)
+{
+}
+
+FILE *zfile_fopen(const char *name, const char *mode)
+{
+    return fopen(name, mode);
+}
+
+int zfile_fclose(FILE *stream)
+{
+    return fclose(stream);
+}
@@ -0,0 +1,361 @@
+/*
+ * fdd-cache-test.c - Encoded track cache of the 1581/2000/4000 FDD.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* A D81 image in memory is accessed through the FDD the way the WD1770
+   does it: step to a track, search the ID mark of a sector and read or
+   write its data field.  The workload copies blocks between two groups of
+   tracks and updates a BAM track in between.  Every sector read must
+   return what a plain model of the image holds, every track must be
+   encoded only once, and the image must only be written when the motor
+   stops, matching the model then.  A snapshot taken in between must leave
+   the image alone and carry the modified tracks to a second drive.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "diskimage.h"
+#include "drive.h"
+#include "fdd.h"
+#include "lib.h"
+#include "snapshot.h"
+#include "test.h"
+#include "types.h"
+
+#define D81_SIZE        (80 * 40 * 256)
+#define COPY_BLOCKS     800
+#define BAM_TRACK       39
+
+static uint8_t image_data[D81_SIZE];
+static uint8_t model[D81_SIZE];
+static unsigned long sector_reads, sector_writes;
+static int visited[83 * 2];
+static int current_track;
+
+/* ------------------------------------------------------------------------- */
+
+int disk_image_read_sector(const disk_image_t *image, uint8_t *buf, const disk_addr_t *dadr)
+{
+    sector_reads++;
+    memcpy(buf, image_data + ((dadr->track - 1) * 40 + dadr->sector) * 256, 256);
+    return 0;
+}
+
+int disk_image_write_sector(disk_image_t *image, const uint8_t *buf, const disk_addr_t *dadr)
+{
+    sector_writes++;
+    memcpy(image_data + ((dadr->track - 1) * 40 + dadr->sector) * 256, buf, 256);
+    return 0;
+}
+
+/* A single snapshot module kept in memory.  */
+struct snapshot_module_s {
+    uint8_t *data;
+    size_t size;
+    size_t pos;
+};
+
+static snapshot_module_t snapshot_module;
+
+snapshot_module_t *snapshot_module_create(snapshot_t *s, const char *name,
+                                          uint8_t major_version, uint8_t minor_version)
+{
+    snapshot_module.size = 0;
+    snapshot_module.pos = 0;
+    snapshot_module_write_byte(&snapshot_module, major_version);
+    snapshot_module_write_byte(&snapshot_module, minor_version);
+    return &snapshot_module;
+}
+
+snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name,
+                                        uint8_t *major_version_return,
+                                        uint8_t *minor_version_return)
+{
+    snapshot_module.pos = 0;
+    snapshot_module_read_byte(&snapshot_module, major_version_return);
+    snapshot_module_read_byte(&snapshot_module, minor_version_return);
+    return &snapshot_module;
+}
+
+int snapshot_module_close(snapshot_module_t *m)
+{
+    return 0;
+}
+
+void snapshot_set_error(int error)
+{
+}
+
+int snapshot_module_write_byte_array(snapshot_module_t *m, const uint8_t *data, unsigned int num)
+{
+    m->data = lib_realloc(m->data, m->size + num);
+    memcpy(m->data + m->size, data, num);
+    m->size += num;
+    return 0;
+}
+
+int snapshot_module_write_byte(snapshot_module_t *m, uint8_t data)
+{
+    return snapshot_module_write_byte_array(m, &data, 1);
+}
+
+int snapshot_module_write_dword(snapshot_module_t *m, uint32_t data)
+{
+    uint8_t b[4] = { (uint8_t)data, (uint8_t)(data >> 8), (uint8_t)(data >> 16), (uint8_t)(data >> 24) };
+
+    return snapshot_module_write_byte_array(m, b, 4);
+}
+
+int snapshot_module_read_byte_array(snapshot_module_t *m, uint8_t *b_return, unsigned int num)
+{
+    if (m->pos + num > m->size) {
+        return -1;
+    }
+    memcpy(b_return, m->data + m->pos, num);
+    m->pos += num;
+    return 0;
+}
+
+int snapshot_module_read_byte(snapshot_module_t *m, uint8_t *b_return)
+{
+    return snapshot_module_read_byte_array(m, b_return, 1);
+}
+
+int snapshot_module_read_byte_into_int(snapshot_module_t *m, int *value_return)
+{
+    uint8_t b;
+
+    if (snapshot_module_read_byte(m, &b) < 0) {
+        return -1;
+    }
+    *value_return = b;
+    return 0;
+}
+
+int snapshot_module_read_dword(snapshot_module_t *m, uint32_t *dw_return)
+{
+    uint8_t b[4];
+
+    if (snapshot_module_read_byte_array(m, b, 4) < 0) {
+        return -1;
+    }
+    *dw_return = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+    return 0;
+}
+
+int snapshot_module_read_dword_into_int(snapshot_module_t *m, int *value_return)
+{
+    uint32_t dw;
+
+    if (snapshot_module_read_dword(m, &dw) < 0) {
+        return -1;
+    }
+    *value_return = (int)dw;
+    return 0;
+}
+
+int snapshot_module_read_dword_into_uint(snapshot_module_t *m, unsigned int *value_return)
+{
+    uint32_t dw;
+
+    if (snapshot_module_read_dword(m, &dw) < 0) {
+        return -1;
+    }
+    *value_return = dw;
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void seek(fd_drive_t *fd, int track)
+{
+    while (current_track < track) {
+        fdd_seek_pulse(fd, 1);
+        current_track++;
+    }
+    while (current_track > track) {
+        fdd_seek_pulse(fd, 0);
+        current_track--;
+    }
+}
+
+/* Offset of the data field of `sector' (1-10) in the image, the 1581
+   puts side 1 of a track first.  */
+static unsigned int model_offset(int track, int head, int sector)
+{
+    return (unsigned int)(((track * 2 + (head ^ 1)) * 10 + sector - 1) * 512);
+}
+
+/* Reads or writes the data field of `sector' on the current track, returns
+   -1 if the sector is not found within 5 revolutions.  */
+static int access_sector(fd_drive_t *fd, int head, int sector, uint8_t *buf, int write)
+{
+    uint16_t id[6];
+    int sync = 0, found, i;
+
+    fdd_select_head(fd, head);
+    visited[current_track * 2 + head] = 1;
+    fdd_index_count_reset(fd);
+    for (;;) {
+        fdd_find_id_mark(fd, 1000000, 5, 0, &sync, &found);
+        if (!found) {
+            return -1;
+        }
+        for (i = 0; i < 6; i++) {
+            id[i] = fdd_read(fd);
+        }
+        if (id[0] == current_track && id[1] == (head ^ 1) && id[2] == sector) {
+            break;
+        }
+        sync = 0;
+    }
+    for (i = 0; i < 43 && fdd_read(fd) != 0xfb; i++) {
+    }
+    for (i = 0; i < 512; i++) {
+        if (write) {
+            fdd_write(fd, buf[i]);
+        } else {
+            buf[i] = (uint8_t)fdd_read(fd);
+        }
+    }
+    return 0;
+}
+
+static int read_check(fd_drive_t *fd, int track, int head, int sector, uint8_t *buf)
+{
+    seek(fd, track);
+    return access_sector(fd, head, sector, buf, 0) == 0
+           && memcmp(buf, model + model_offset(track, head, sector), 512) == 0;
+}
+
+static void write_model(fd_drive_t *fd, int track, int head, int sector, const uint8_t *buf)
+{
+    seek(fd, track);
+    TEST_CHECK(access_sector(fd, head, sector, (uint8_t *)buf, 1) == 0);
+    memcpy(model + model_offset(track, head, sector), buf, 512);
+}
+
+/* Copies blocks `first' to `last' - 1 from tracks 1-38 to 41-78, the BAM
+   sector is read and written back after every 10.  */
+static int copy_blocks(fd_drive_t *fd, int first, int last)
+{
+    uint8_t buf[512];
+    int ok = 1;
+    int b;
+
+    for (b = first; b < last; b++) {
+        int src = 1 + (b / 20) % 38;
+        int dst = 41 + (b / 20) % 38;
+        int head = b & 1;
+        int sector = 1 + (b / 2) % 10;
+
+        ok &= read_check(fd, src, head, sector, buf);
+        buf[0] = (uint8_t)b;
+        write_model(fd, dst, head, sector, buf);
+        ok &= read_check(fd, dst, head, sector, buf);
+        if (b % 10 == 9) {
+            ok &= read_check(fd, BAM_TRACK, 0, 1, buf);
+            buf[b % 256] ^= 0xff;
+            write_model(fd, BAM_TRACK, 0, 1, buf);
+        }
+    }
+    return ok;
+}
+
+static int count_visited(void)
+{
+    int i, n = 0;
+
+    for (i = 0; i < 83 * 2; i++) {
+        n += visited[i];
+    }
+    return n;
+}
+
+int main(void)
+{
+    disk_image_t image;
+    drive_t drive[2];
+    fd_drive_t *fd, *fd2;
+    clock_t start;
+    unsigned int i;
+
+    for (i = 0; i < D81_SIZE; i++) {
+        image_data[i] = (uint8_t)(i * 13 + (i >> 9));
+    }
+    memcpy(model, image_data, D81_SIZE);
+    memset(&image, 0, sizeof image);
+    image.type = DISK_IMAGE_TYPE_D81;
+    memset(drive, 0, sizeof drive);
+
+    fd = fdd_init(0, &drive[0]);
+    fdd_image_attach(fd, &image);
+    fdd_set_motor(fd, 1);
+    fdd_set_rate(fd, 2);
+
+    start = clock();
+
+    /* modified tracks stay in the cache while the motor runs */
+    TEST_CHECK(copy_blocks(fd, 0, COPY_BLOCKS / 2));
+    TEST_CHECK(sector_writes == 0);
+    TEST_CHECK(sector_reads == (unsigned long)count_visited() * 20);
+
+    /* the snapshot leaves the image alone and carries the modified tracks */
+    TEST_CHECK(fdd_snapshot_write_module(fd, NULL) == 0);
+    TEST_CHECK(sector_writes == 0);
+
+    fd2 = fdd_init(1, &drive[1]);
+    fdd_image_attach(fd2, &image);
+    TEST_CHECK(fdd_snapshot_read_module(fd2, NULL) == 0);
+    TEST_CHECK(sector_writes == 0);
+    fdd_set_motor(fd2, 0);
+    TEST_CHECK(memcmp(image_data, model, D81_SIZE) == 0);
+    fdd_image_detach(fd2);
+    fdd_shutdown(fd2);
+
+    TEST_CHECK(copy_blocks(fd, COPY_BLOCKS / 2, COPY_BLOCKS));
+    fdd_set_motor(fd, 0);
+    TEST_CHECK(memcmp(image_data, model, D81_SIZE) == 0);
+
+    printf("%d tracks visited, %lu sector reads, %lu sector writes, %.3f s\n",
+           count_visited(), sector_reads, sector_writes,
+           (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    /* a new attach encodes the tracks from the written image again */
+    fdd_image_detach(fd);
+    fdd_image_attach(fd, &image);
+    fdd_set_motor(fd, 1);
+    for (i = 0; i < 20; i++) {
+        uint8_t buf[512];
+
+        TEST_CHECK(read_check(fd, 41 + (int)i, (int)i & 1, 1 + (int)i % 10, buf));
+    }
+    fdd_image_detach(fd);
+    fdd_shutdown(fd);
+    lib_free(snapshot_module.data);
+
+    return test_result("fdd-cache-test");
+}
@@ -0,0 +1,505 @@
+/*
+ * monitor-cond-test.c - Compiled checkpoint conditions.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Random condition trees over registers, memory and constants are
+   evaluated by the tree walker and by the compiled program for random
+   CPU states, both must agree.  Then the time both need for a typical
+   condition on a hot loop is printed.  */
+
+#include "vice.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "asm.h"
+#include "charset.h"
+#include "cmdline.h"
+#include "console.h"
+#include "interrupt.h"
+#include "ioutil.h"
+#include "lib.h"
+#include "mon_breakpoint.h"
+#include "mon_memory.h"
+#include "mon_register.h"
+#include "monitor.h"
+#include "montypes.h"
+#include "mos6510.h"
+#include "resources.h"
+#include "test.h"
+#include "types.h"
+
+#define TREES           2000
+#define STATES          200
+#define BENCH_HITS      20000000
+
+static mos6510_regs_t regs;
+static uint8_t ram[0x10000];
+static monitor_interface_t comp_interface;
+static monitor_cpu_type_t cpu_6502;
+static monitor_cpu_type_t cpu_other;
+
+static unsigned int test_seed = 1;
+
+static unsigned int test_rand(void)
+{
+    test_seed = test_seed * 1103515245 + 12345;
+    return (test_seed >> 16) & 0x7fff;
+}
+
+static uint8_t test_peek(int bank, uint16_t addr, void *context)
+{
+    return ram[addr];
+}
+
+/* Registers of another CPU on the same memspace.  */
+static unsigned int other_register_get_val(int mem, int reg_id)
+{
+    return (regs.a ^ (reg_id * 0x35)) & 0xff;
+}
+
+static void random_state(void)
+{
+    unsigned int i;
+
+    regs.a = (uint8_t)test_rand();
+    regs.x = (uint8_t)test_rand();
+    regs.y = (uint8_t)test_rand();
+    regs.sp = (uint8_t)test_rand();
+    regs.p = (uint8_t)test_rand();
+    regs.pc = (test_rand() << 1) & 0xffff;
+    /* the conditions only look at the first page */
+    for (i = 0; i < 0x100; i++) {
+        ram[i] = (uint8_t)test_rand();
+    }
+}
+
+static cond_node_t *new_node(int operation)
+{
+    cond_node_t *cnode = lib_calloc(1, sizeof(cond_node_t));
+
+    cnode->operation = operation;
+    cnode->banknum = -1;
+    return cnode;
+}
+
+static cond_node_t *new_leaf(void)
+{
+    static const int reg_ids[] = { e_A, e_X, e_Y, e_SP, e_PC, e_FLAGS };
+    cond_node_t *cnode = new_node(e_INV);
+
+    switch (test_rand() % 3) {
+        case 0:
+            cnode->is_reg = true;
+            cnode->reg_num = new_reg(e_comp_space, reg_ids[test_rand() % 6]);
+            break;
+        case 1:
+            cnode->banknum = 0;
+            cnode->value = new_addr(e_comp_space, test_rand() & 0xff);
+            break;
+        default:
+            /* small constants so the comparisons go both ways */
+            cnode->value = test_rand() % 0x110;
+            break;
+    }
+    return cnode;
+}
+
+static cond_node_t *new_tree(int depth)
+{
+    cond_node_t *cnode;
+
+    if (depth == 0 || test_rand() % 4 == 0) {
+        cnode = new_node(e_EQU + (int)(test_rand() % (e_LTE - e_EQU + 1)));
+        cnode->child1 = new_leaf();
+        cnode->child2 = new_leaf();
+        if (test_rand() % 2) {
+            /* a register or memory operand alone is a truth value */
+            cond_node_t *leaf = cnode;
+
+            cnode = new_node((test_rand() % 2) ? e_AND : e_OR);
+            cnode->child1 = leaf;
+            cnode->child2 = new_leaf();
+        }
+        return cnode;
+    }
+    cnode = new_node((test_rand() % 2) ? e_AND : e_OR);
+    cnode->child1 = new_tree(depth - 1);
+    cnode->child2 = new_tree(depth - 1);
+    return cnode;
+}
+
+static void check_trees(void)
+{
+    unsigned int tree, state, mismatches = 0, fallbacks = 0;
+
+    for (tree = 0; tree < TREES; tree++) {
+        cond_node_t *cnode = new_tree(tree % 5);
+        cond_prog_t *prog = mon_compile_conditional(cnode);
+
+        TEST_CHECK(prog != NULL);
+        if (prog == NULL) {
+            mon_delete_conditional(cnode);
+            continue;
+        }
+        for (state = 0; state < STATES; state++) {
+            random_state();
+            if (mon_evaluate_conditional(cnode) != mon_evaluate_compiled_conditional(prog)) {
+                if (mismatches++ < 10) {
+                    fprintf(stderr, "tree %u: results differ\n", tree);
+                }
+            }
+        }
+        /* after a CPU switch the registers must come from the new CPU */
+        monitor_cpu_for_memspace[e_comp_space] = &cpu_other;
+        for (state = 0; state < STATES; state++) {
+            random_state();
+            if (mon_evaluate_conditional(cnode) != mon_evaluate_compiled_conditional(prog)) {
+                fallbacks++;
+            }
+        }
+        monitor_cpu_for_memspace[e_comp_space] = &cpu_6502;
+        mon_delete_compiled_conditional(prog);
+        mon_delete_conditional(cnode);
+    }
+    printf("%u trees, %u states each: %u differ, %u differ after a CPU switch\n",
+           TREES, STATES, mismatches, fallbacks);
+    TEST_CHECK(mismatches == 0);
+    TEST_CHECK(fallbacks == 0);
+}
+
+/* `A == $20 && X > 3', as set with `cond 1 if a == $20 && x > 3'.  */
+static cond_node_t *bench_condition(void)
+{
+    cond_node_t *cnode = new_node(e_AND);
+    cond_node_t *equ = new_node(e_EQU);
+    cond_node_t *gt = new_node(e_GT);
+
+    equ->child1 = new_node(e_INV);
+    equ->child1->is_reg = true;
+    equ->child1->reg_num = new_reg(e_comp_space, e_A);
+    equ->child2 = new_node(e_INV);
+    equ->child2->value = 0x20;
+    gt->child1 = new_node(e_INV);
+    gt->child1->is_reg = true;
+    gt->child1->reg_num = new_reg(e_comp_space, e_X);
+    gt->child2 = new_node(e_INV);
+    gt->child2->value = 3;
+    cnode->child1 = equ;
+    cnode->child2 = gt;
+    return cnode;
+}
+
+static void bench(void)
+{
+    cond_node_t *cnode = bench_condition();
+    cond_prog_t *prog = mon_compile_conditional(cnode);
+    unsigned int i, hits_tree = 0, hits_prog = 0;
+    clock_t start;
+    double tree_time, prog_time;
+
+    /* a loop counting X down with A taking a few values */
+    start = clock();
+    for (i = 0; i < BENCH_HITS; i++) {
+        regs.x = (uint8_t)i;
+        regs.a = (uint8_t)(0x1e + (i >> 8) % 4);
+        hits_tree += mon_evaluate_conditional(cnode);
+    }
+    tree_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (i = 0; i < BENCH_HITS; i++) {
+        regs.x = (uint8_t)i;
+        regs.a = (uint8_t)(0x1e + (i >> 8) % 4);
+        hits_prog += mon_evaluate_compiled_conditional(prog);
+    }
+    prog_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%u hits of `A == $20 && X > 3': tree %.1f ns, compiled %.1f ns per hit\n",
+           BENCH_HITS, tree_time * 1e9 / BENCH_HITS, prog_time * 1e9 / BENCH_HITS);
+    TEST_CHECK(hits_tree == hits_prog);
+
+    mon_delete_compiled_conditional(prog);
+    mon_delete_conditional(cnode);
+}
+
+int main(void)
+{
+    comp_interface.cpu_regs = &regs;
+    comp_interface.mem_bank_peek = test_peek;
+    comp_interface.mem_bank_read = test_peek;
+    mon_interfaces[e_comp_space] = &comp_interface;
+
+    mon_register6502_init(&cpu_6502);
+    cpu_6502.cpu_type = CPU_6502;
+    mon_register6502_init(&cpu_other);
+    cpu_other.cpu_type = CPU_6502;
+    cpu_other.mon_register_get_val = other_register_get_val;
+    monitor_cpu_for_memspace[e_comp_space] = &cpu_6502;
+
+    check_trees();
+    bench();
+
+    return test_result("monitor-cond-test");
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The rest of the emulator as far as monitor.c needs it.  */
+
+int console_mode = 0;
+int yydebug = 0;
+
+uint8_t charset_p_toascii(uint8_t c, int cs)
+{
+    return c;
+}
+
+uint8_t charset_screencode_to_petcii(uint8_t code)
+{
+    return code;
+}
+
+int cmdline_register_options(const cmdline_option_t *c)
+{
+    return 0;
+}
+
+void datasette_control(int command)
+{
+}
+
+void drive_cpu_trigger_reset(unsigned int dnr)
+{
+}
+
+void interrupt_maincpu_trigger_trap(void (*trap_func)(uint16_t, void *data), void *data)
+{
+}
+
+void interrupt_monitor_trap_off(interrupt_cpu_status_t *cs)
+{
+}
+
+void interrupt_monitor_trap_on(interrupt_cpu_status_t *cs)
+{
+}
+
+int ioutil_chdir(const char *path)
+{
+    return -1;
+}
+
+void ioutil_closedir(ioutil_dir_t *ioutil_dir)
+{
+}
+
+char *ioutil_current_dir(void)
+{
+    return NULL;
+}
+
+ioutil_dir_t *ioutil_opendir(const char *path, int mode)
+{
+    return NULL;
+}
+
+char *ioutil_readdir(ioutil_dir_t *ioutil_dir)
+{
+    return NULL;
+}
+
+int ioutil_remove(const char *name)
+{
+    return -1;
+}
+
+int ioutil_stat(const char *file_name, unsigned int *len, unsigned int *isdir)
+{
+    return -1;
+}
+
+int kbdbuf_feed_string(const char *string)
+{
+    return 0;
+}
+
+void machine_trigger_reset(const unsigned int reset_mode)
+{
+}
+
+struct video_canvas_s *machine_video_canvas_get(unsigned int window)
+{
+    return NULL;
+}
+
+void mem_get_screen_parameter(uint16_t *base, uint8_t *rows, uint8_t *columns, int *bank)
+{
+}
+
+int mon_breakpoint_add_checkpoint(MON_ADDR start_addr, MON_ADDR end_addr,
+                                  bool stop, MEMORY_OP op, bool is_temp)
+{
+    return 0;
+}
+
+bool mon_breakpoint_check_checkpoint(MEMSPACE mem, unsigned int addr,
+                                     unsigned int lastpc, MEMORY_OP op)
+{
+    return false;
+}
+
+void mon_breakpoint_init(void)
+{
+}
+
+void mon_disassemble_with_regdump(MEMSPACE mem, unsigned int addr)
+{
+}
+
+void mon_log_file_close(void)
+{
+}
+
+int mon_log_file_open(const char *name)
+{
+    return 0;
+}
+
+void mon_memmap_init(void)
+{
+}
+
+void mon_memmap_shutdown(void)
+{
+}
+
+void mon_memory_display(int radix_type, MON_ADDR start_addr,
+                        MON_ADDR end_addr, mon_display_format_t format)
+{
+}
+
+int mon_out(const char *format, ...)
+{
+    return 0;
+}
+
+int mon_register_name_to_value(int mem, char *name)
+{
+    return -1;
+}
+
+int mon_register_name_valid(int mem, char *name)
+{
+    return 0;
+}
+
+void mon_ui_init(void)
+{
+}
+
+int monitor_is_remote(void)
+{
+    return 0;
+}
+
+void parse_and_execute_line(char *input)
+{
+}
+
+resource_type_t resources_query_type(const char *name)
+{
+    return RES_INTEGER;
+}
+
+int resources_register_int(const resource_int_t *r)
+{
+    return 0;
+}
+
+int resources_set_value_string(const char *name, const char *value)
+{
+    return 0;
+}
+
+char *resources_write_item_to_string(const char *name, const char *delim)
+{
+    return NULL;
+}
+
+int screenshot_save(const char *drvname, const char *filename,
+                    struct video_canvas_s *canvas)
+{
+    return -1;
+}
+
+FILE *sysfile_open(const char *name, char **complete_path_return, const char *open_mode)
+{
+    return NULL;
+}
+
+int traps_checkaddr(unsigned int addr)
+{
+    return 0;
+}
+
+void ui_update_menus(void)
+{
+}
+
+char *uimon_in(const char *prompt)
+{
+    return NULL;
+}
+
+void uimon_notify_change(void)
+{
+}
+
+void uimon_set_interface(struct monitor_interface_s **interface, int count)
+{
+}
+
+void uimon_window_close(void)
+{
+}
+
+struct console_s *uimon_window_open(void)
+{
+    return NULL;
+}
+
+struct console_s *uimon_window_resume(void)
+{
+    return NULL;
+}
+
+void uimon_window_suspend(void)
+{
+}
+
+void vsync_suspend_speed_eval(void)
+{
+}
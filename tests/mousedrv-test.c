@@ -0,0 +1,267 @@
+/*
+ * mousedrv-test.c - Replay of touch pad samples through the Vita mousedrv.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* A touch trace is fed to mousedrv the way the controller does it: at the
+   end of every PAL frame, all samples taken during the frame with their
+   age.  The emulation then runs the next frame and records the emulated
+   time at which each sample becomes visible to the mouse emulation.
+
+   The latency of a sample is that time minus the time the sample was
+   taken.  The jitter is its standard deviation.  Both are printed next to
+   what feeding all samples of a frame at once gives.  The samples must all
+   arrive in order, with their buttons, and with less than 0.5 ms jitter.
+
+   Without arguments a 60 Hz sensor trace with 1 ms jitter is replayed.  A
+   recorded trace can be given as a file with one sample per line:
+   "<time in us> <dx> <dy> <button>".  */
+
+#include "vice.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alarm.h"
+#include "clkguard.h"
+#include "maincpu.h"
+#include "mouse.h"
+#include "mousedrv.h"
+#include "test.h"
+#include "types.h"
+
+#define MAX_SAMPLES     4096
+#define CYCLES_PER_SEC  985248
+#define CYCLES_PER_FRAME 19656
+#define STEP_CYCLES     64
+
+typedef struct trace_sample_s {
+    unsigned long time;     /* us */
+    int dx, dy, button;
+    double seen;            /* emulated us when it became visible */
+} trace_sample_t;
+
+static trace_sample_t trace[MAX_SAMPLES];
+static int trace_size;
+
+CLOCK maincpu_clk = 0;
+alarm_context_t *maincpu_alarm_context;
+clk_guard_t *maincpu_clk_guard;
+
+static clk_guard_callback_t clk_overflow_callback;
+static int button_state;
+
+void clk_guard_add_callback(clk_guard_t *guard, clk_guard_callback_t function, void *data)
+{
+    clk_overflow_callback = function;
+}
+
+long machine_get_cycles_per_second(void)
+{
+    return CYCLES_PER_SEC;
+}
+
+long machine_get_cycles_per_frame(void)
+{
+    return CYCLES_PER_FRAME;
+}
+
+/* The host runs in step with the emulation.  */
+static CLOCK clk_base = 0;
+static double host_base = 0;
+
+unsigned long vsyncarch_frequency(void)
+{
+    return 1000000;
+}
+
+unsigned long vsyncarch_gettime(void)
+{
+    return (unsigned long)(host_base + (double)(maincpu_clk - clk_base) * 1e6 / CYCLES_PER_SEC);
+}
+
+void ui_check_mouse_cursor(void)
+{
+}
+
+static void button_left(int pressed)
+{
+    button_state = pressed;
+}
+
+static void button_other(int pressed)
+{
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void make_trace(void)
+{
+    unsigned long t = 1000;
+
+    srand(1);
+    for (trace_size = 0; trace_size < 300; trace_size++) {
+        trace[trace_size].time = t;
+        trace[trace_size].dx = 8;
+        trace[trace_size].dy = -4;
+        trace[trace_size].button = (trace_size / 40) & 1;
+        t += 16667 - 1000 + (unsigned long)(rand() % 2001);
+    }
+}
+
+static int read_trace(const char *name)
+{
+    FILE *f = fopen(name, "r");
+
+    if (f == NULL) {
+        return -1;
+    }
+    for (trace_size = 0; trace_size < MAX_SAMPLES; trace_size++) {
+        trace_sample_t *s = &trace[trace_size];
+
+        if (fscanf(f, "%lu %d %d %d", &s->time, &s->dx, &s->dy, &s->button) != 4) {
+            break;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static double now_us(void)
+{
+    return host_base + (double)(maincpu_clk - clk_base) * 1e6 / CYCLES_PER_SEC;
+}
+
+static void run_until(CLOCK end, int *next_seen)
+{
+    while (maincpu_clk < end) {
+        maincpu_clk += STEP_CYCLES;
+        while (maincpu_clk >= alarm_context_next_pending_clk(maincpu_alarm_context)) {
+            alarm_context_dispatch(maincpu_alarm_context, maincpu_clk);
+        }
+        /* a sample is visible once the position and the button have moved on */
+        while (*next_seen < trace_size) {
+            trace_sample_t *s = &trace[*next_seen];
+            static int x, y;
+
+            if (mousedrv_get_x() != x + s->dx || mousedrv_get_y() != y - s->dy
+                || button_state != s->button) {
+                break;
+            }
+            x += s->dx;
+            y -= s->dy;
+            s->seen = now_us();
+            (*next_seen)++;
+        }
+    }
+}
+
+static void report(const char *name, const double *latency, int n)
+{
+    double sum = 0, sq = 0, max = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        sum += latency[i];
+        sq += latency[i] * latency[i];
+        if (latency[i] > max) {
+            max = latency[i];
+        }
+    }
+    printf("%-8s latency %.2f ms, max %.2f ms, jitter %.2f ms\n", name,
+           sum / n / 1000, max / 1000, sqrt(sq / n - (sum / n) * (sum / n)) / 1000);
+}
+
+int main(int argc, char **argv)
+{
+    static double latency[MAX_SAMPLES], batched[MAX_SAMPLES];
+    static mouse_func_t funcs = { button_left, button_other, button_other, button_other, button_other };
+    double frame_us = (double)CYCLES_PER_FRAME * 1e6 / CYCLES_PER_SEC;
+    double sum = 0, sq = 0;
+    int fed = 0, seen = 0, button = 0;
+    int i;
+
+    if (argc > 1) {
+        if (read_trace(argv[1]) < 0 || trace_size == 0) {
+            fprintf(stderr, "cannot read trace %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        make_trace();
+    }
+
+    maincpu_alarm_context = alarm_context_new("maincpu");
+    mousedrv_resources_init(&funcs);
+    mousedrv_init();
+    host_base = (double)trace[0].time;
+
+    /* frame by frame, the emulated clock is warped back halfway through */
+    while (seen < trace_size && maincpu_clk < 1000000000) {
+        double end_us = now_us();
+        int newest = fed;
+
+        while (newest < trace_size && trace[newest].time <= end_us) {
+            newest++;
+        }
+        for (i = fed; i < newest; i++) {
+            unsigned long age = (unsigned long)end_us - trace[i].time;
+            unsigned long timestamp = vsyncarch_gettime() - age;
+
+            mouse_move_timestamp((float)trace[i].dx, (float)trace[i].dy, timestamp);
+            if (trace[i].button != button) {
+                button = trace[i].button;
+                mouse_button_timestamp(0, button, timestamp);
+            }
+            batched[i] = end_us - (double)trace[i].time;
+        }
+        fed = newest;
+
+        if (fed > trace_size / 2 && clk_base == 0) {
+            CLOCK sub = maincpu_clk - 1000;
+
+            host_base = now_us();
+            clk_base = 1000;
+            maincpu_clk -= sub;
+            alarm_context_time_warp(maincpu_alarm_context, sub, -1);
+            clk_overflow_callback(sub, NULL);
+        }
+
+        run_until(maincpu_clk + CYCLES_PER_FRAME, &seen);
+    }
+
+    TEST_CHECK(seen == trace_size);
+    for (i = 0; i < seen; i++) {
+        latency[i] = trace[i].seen - (double)trace[i].time;
+        sum += latency[i];
+        sq += latency[i] * latency[i];
+    }
+    if (seen > 0) {
+        report("replayed", latency, seen);
+        report("batched", batched, seen);
+        TEST_CHECK(sqrt(sq / seen - (sum / seen) * (sum / seen)) < 500);
+        TEST_CHECK(sum / seen < 2 * frame_us);
+    }
+
+    alarm_context_destroy(maincpu_alarm_context);
+
+    return test_result("mousedrv-test");
+}
@@ -0,0 +1,214 @@
+/*
+ * ramimage-test.c - RAM expansion contents backed by an image file.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Images with and without a load address are read, modified and flushed,
+   and must then hold what a plain copy of the RAM holds.  A flush must
+   sync the journal before it touches the image and the image before the
+   journal goes away.  A complete journal left behind must be replayed on
+   the next open, a torn one dropped.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "archdep.h"
+#include "ioutil.h"
+#include "ramimage.h"
+#include "test.h"
+#include "types.h"
+#include "util.h"
+
+#define RAM_SIZE        (512 * 1024)
+#define IMAGE_NAME      "ramimage.reu"
+#define JOURNAL_NAME    "ramimage.reu.journal"
+
+static uint8_t model[RAM_SIZE];
+static int syncs, syncs_with_journal;
+
+int ioutil_remove(const char *name)
+{
+    return remove(name);
+}
+
+int archdep_file_sync(FILE *fd)
+{
+    syncs++;
+    if (util_file_exists(JOURNAL_NAME)) {
+        syncs_with_journal++;
+    }
+    if (fflush(fd) != 0 || fsync(fileno(fd)) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Writes the model to the image, after the load address if not NULL.  */
+static void write_image(const uint8_t *load_address)
+{
+    FILE *f = fopen(IMAGE_NAME, "wb");
+
+    if (load_address != NULL) {
+        fwrite(load_address, 2, 1, f);
+    }
+    fwrite(model, RAM_SIZE, 1, f);
+    fclose(f);
+}
+
+/* Compares the image with the model, after `offset' bytes.  */
+static int image_matches(unsigned int offset)
+{
+    static uint8_t buf[RAM_SIZE + 2];
+    FILE *f = fopen(IMAGE_NAME, "rb");
+    size_t n;
+
+    if (f == NULL) {
+        return 0;
+    }
+    n = fread(buf, 1, sizeof buf, f);
+    fclose(f);
+    return n == RAM_SIZE + offset && memcmp(buf + offset, model, RAM_SIZE) == 0;
+}
+
+static int ram_matches(ramimage_t *image)
+{
+    unsigned int i;
+
+    for (i = 0; i < RAM_SIZE; i++) {
+        if (ramimage_read(image, i) != model[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Stores a byte into every third page.  */
+static void modify(ramimage_t *image, uint8_t value)
+{
+    unsigned int i;
+
+    for (i = 100; i < RAM_SIZE; i += 3 * RAMIMAGE_PAGE_SIZE) {
+        ramimage_store(image, i, value);
+        model[i] = value;
+    }
+}
+
+static void write_journal(unsigned int offset, unsigned int page, uint8_t value, int complete)
+{
+    static uint8_t data[RAMIMAGE_PAGE_SIZE];
+    FILE *f = fopen(JOURNAL_NAME, "wb");
+    uint8_t buf[4];
+
+    fwrite("VICERAMJ", 8, 1, f);
+    util_dword_to_le_buf(buf, RAM_SIZE);
+    fwrite(buf, 4, 1, f);
+    util_dword_to_le_buf(buf, offset);
+    fwrite(buf, 4, 1, f);
+    util_dword_to_le_buf(buf, page);
+    fwrite(buf, 4, 1, f);
+    memset(data, value, sizeof data);
+    if (complete) {
+        fwrite(data, sizeof data, 1, f);
+        util_dword_to_le_buf(buf, 0xffffffff);
+        fwrite(buf, 4, 1, f);
+        memset(model + page * RAMIMAGE_PAGE_SIZE, value, RAMIMAGE_PAGE_SIZE);
+    } else {
+        fwrite(data, 100, 1, f);
+    }
+    fclose(f);
+}
+
+static void test_image(const uint8_t *load_address)
+{
+    unsigned int offset = load_address != NULL ? 2 : 0;
+    ramimage_t image;
+    uint8_t buf[2];
+    FILE *f;
+
+    write_image(load_address);
+    TEST_CHECK(ramimage_open(&image, RAM_SIZE, IMAGE_NAME) == 0);
+    TEST_CHECK(image.offset == offset);
+    TEST_CHECK(ram_matches(&image));
+
+    /* only the flush writes, it syncs the journal and then the image */
+    modify(&image, (uint8_t)(0x5a + offset));
+    TEST_CHECK(image_matches(offset) == 0);
+    syncs = syncs_with_journal = 0;
+    TEST_CHECK(ramimage_flush(&image) == 0);
+    TEST_CHECK(syncs == 2 && syncs_with_journal == 2);
+    TEST_CHECK(!util_file_exists(JOURNAL_NAME));
+    TEST_CHECK(image_matches(offset));
+    ramimage_close(&image);
+
+    /* the load address is kept */
+    if (load_address != NULL) {
+        f = fopen(IMAGE_NAME, "rb");
+        TEST_CHECK(f != NULL && fread(buf, 2, 1, f) == 1 && memcmp(buf, load_address, 2) == 0);
+        if (f != NULL) {
+            fclose(f);
+        }
+    }
+
+    /* a torn journal is dropped, a complete one replayed */
+    write_journal(offset, 5, 0x11, 0);
+    TEST_CHECK(ramimage_open(&image, RAM_SIZE, IMAGE_NAME) == 0);
+    TEST_CHECK(!util_file_exists(JOURNAL_NAME));
+    TEST_CHECK(ram_matches(&image));
+    ramimage_close(&image);
+
+    write_journal(offset, 7, 0x22, 1);
+    TEST_CHECK(ramimage_open(&image, RAM_SIZE, IMAGE_NAME) == 0);
+    TEST_CHECK(!util_file_exists(JOURNAL_NAME));
+    TEST_CHECK(ram_matches(&image));
+    ramimage_close(&image);
+    TEST_CHECK(image_matches(offset));
+
+    ioutil_remove(IMAGE_NAME);
+}
+
+int main(void)
+{
+    static const uint8_t load_address[2] = { 0x00, 0x40 };
+    ramimage_t image;
+    unsigned int i;
+
+    for (i = 0; i < RAM_SIZE; i++) {
+        model[i] = (uint8_t)(i * 7 + (i >> 12));
+    }
+    test_image(NULL);
+    test_image(load_address);
+
+    /* a missing image is created with the size of the RAM */
+    ioutil_remove(IMAGE_NAME);
+    memset(model, 0, sizeof model);
+    TEST_CHECK(ramimage_open(&image, RAM_SIZE, IMAGE_NAME) == 0);
+    TEST_CHECK(image.offset == 0);
+    TEST_CHECK(ram_matches(&image));
+    ramimage_close(&image);
+    TEST_CHECK(image_matches(0));
+    ioutil_remove(IMAGE_NAME);
+
+    return test_result("ramimage-test");
+}
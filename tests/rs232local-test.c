@@ -0,0 +1,223 @@
+/*
+ * rs232local-test.c - Local RS232 peers.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Every peer is read the way the ACIA reads it, one byte per call: the
+   echo peer must return what was sent and count what overflows the ring,
+   the file peer must return the file and the BBS stream must arrive
+   complete and in order.  Then the host time per received byte is
+   printed.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ioutil.h"
+#include "machine.h"
+#include "maincpu.h"
+#include "rs232.h"
+#include "rs232local.h"
+#include "test.h"
+#include "types.h"
+
+#define STREAM_BYTES    100000
+#define FILE_BYTES      50000
+#define BENCH_BYTES     4000000
+
+/* The size of the receive ring minus one.  */
+#define RING_BYTES      0x3fff
+
+char *rs232_devfile[RS232_NUM_DEVICES];
+CLOCK maincpu_clk = 0;
+
+int ioutil_remove(const char *name)
+{
+    return remove(name);
+}
+
+long machine_get_cycles_per_second(void)
+{
+    return 985248;
+}
+
+static int open_peer(const char *name)
+{
+    rs232_devfile[0] = (char *)name;
+    return rs232local_open(0);
+}
+
+/* Receive bytes until none is waiting.  */
+static unsigned int drain(int fd, uint8_t *buf, unsigned int size)
+{
+    unsigned int n = 0;
+    uint8_t b;
+
+    while (rs232local_getc(fd, &b) == 1) {
+        if (n < size) {
+            buf[n] = b;
+        }
+        n++;
+    }
+    return n;
+}
+
+static void test_echo(void)
+{
+    static uint8_t buf[RING_BYTES + 0x1000];
+    unsigned int i, n;
+    int fd = open_peer("local:echo");
+    int same = 1;
+    uint8_t b;
+
+    TEST_CHECK(fd >= 0);
+
+    /* byte by byte */
+    for (i = 0; i < 100000; i++) {
+        rs232local_putc(fd, (uint8_t)(i * 7));
+        if (rs232local_getc(fd, &b) != 1 || b != (uint8_t)(i * 7)) {
+            same = 0;
+        }
+    }
+    TEST_CHECK(same);
+    TEST_CHECK(rs232local_getc(fd, &b) == 0);
+
+    /* what does not fit into the ring is lost */
+    for (i = 0; i < sizeof buf; i++) {
+        rs232local_putc(fd, (uint8_t)i);
+    }
+    n = drain(fd, buf, sizeof buf);
+    TEST_CHECK(n == RING_BYTES);
+    for (i = 0; i < n && i < RING_BYTES; i++) {
+        if (buf[i] != (uint8_t)i) {
+            same = 0;
+        }
+    }
+    TEST_CHECK(same);
+
+    rs232local_close(fd);
+}
+
+static void test_file(void)
+{
+    static uint8_t data[FILE_BYTES], buf[FILE_BYTES + 1];
+    unsigned int i;
+    FILE *f;
+    int fd;
+
+    for (i = 0; i < FILE_BYTES; i++) {
+        data[i] = (uint8_t)(i ^ (i >> 8));
+    }
+    f = fopen("rs232local.bin", "wb");
+    TEST_CHECK(f != NULL);
+    if (f == NULL) {
+        return;
+    }
+    fwrite(data, 1, FILE_BYTES, f);
+    fclose(f);
+
+    fd = open_peer("local:file:rs232local.bin");
+    TEST_CHECK(fd >= 0);
+    TEST_CHECK(drain(fd, buf, sizeof buf) == FILE_BYTES);
+    TEST_CHECK(memcmp(buf, data, FILE_BYTES) == 0);
+    rs232local_close(fd);
+
+    TEST_CHECK(open_peer("local:file:rs232local-missing.bin") < 0);
+    TEST_CHECK(open_peer("local:modem") < 0);
+}
+
+static void send_line(int fd, const char *line)
+{
+    while (*line) {
+        rs232local_putc(fd, (uint8_t)*line++);
+    }
+}
+
+static void test_bbs(void)
+{
+    static uint8_t buf[STREAM_BYTES + 0x100];
+    unsigned int i, n;
+    int fd = open_peer("local:bbs");
+    int same = 1;
+
+    TEST_CHECK(fd >= 0);
+
+    n = drain(fd, buf, sizeof buf);
+    TEST_CHECK(n > 2 && memcmp(buf + n - 2, "> ", 2) == 0);
+
+    /* the command is echoed, then the stream follows */
+    send_line(fd, "stream 100000\r");
+    n = drain(fd, buf, sizeof buf);
+    TEST_CHECK(n == strlen("stream 100000\r\n") + STREAM_BYTES + strlen("\r\n> "));
+    TEST_CHECK(memcmp(buf, "stream 100000\r\n", 15) == 0);
+    for (i = 0; i < STREAM_BYTES; i++) {
+        uint8_t expect = (i % 64 == 63) ? 0x0d : (uint8_t)(0x20 + (i / 64 + i % 64) % 0x3f);
+
+        if (buf[15 + i] != expect) {
+            same = 0;
+        }
+    }
+    TEST_CHECK(same);
+    TEST_CHECK(memcmp(buf + 15 + STREAM_BYTES, "\r\n> ", 4) == 0);
+
+    /* carrier goes away with BYE */
+    TEST_CHECK(rs232local_get_status(fd) & RS232_HSI_CTS);
+    send_line(fd, "bye\r");
+    n = drain(fd, buf, sizeof buf);
+    TEST_CHECK(n >= 12 && memcmp(buf + n - 12, "NO CARRIER\r\n", 12) == 0);
+    TEST_CHECK(!(rs232local_get_status(fd) & RS232_HSI_CTS));
+
+    rs232local_close(fd);
+}
+
+static void bench(void)
+{
+    char cmd[32];
+    clock_t start;
+    unsigned int n;
+    int fd = open_peer("local:bbs");
+
+    drain(fd, NULL, 0);
+    sprintf(cmd, "STREAM %d\r", BENCH_BYTES);
+    send_line(fd, cmd);
+
+    start = clock();
+    n = drain(fd, NULL, 0);
+    printf("%u bytes, %.1f ns per received byte\n", n,
+           (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / n);
+
+    rs232local_close(fd);
+}
+
+int main(void)
+{
+    rs232local_init();
+
+    test_echo();
+    test_file();
+    test_bbs();
+    bench();
+
+    return test_result("rs232local-test");
+}
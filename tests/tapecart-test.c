@@ -0,0 +1,677 @@
+/*
+ * tapecart-test.c - Accelerated tapecart fastload against the bit transfer.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* The default loader of the tapecart runs on a small 6510 core with the
+   C64 memory map as far as the loader sees it: RAM, the I/O area at
+   $d000-$dfff and the CPU port lines of the tape port.  Every TCRT is
+   loaded once with TapecartAccelerate off and once with it on.  The RAM,
+   the I/O registers and the CPU state at the end of the loader must be
+   the same, and the accelerated load must take fewer cycles unless the
+   CPU port setup keeps the trap from storing the data itself.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alarm.h"
+#include "cmdline.h"
+#include "crc32.h"
+#include "interrupt.h"
+#include "machine.h"
+#include "maincpu.h"
+#include "mem.h"
+#include "mos6510.h"
+#include "resources.h"
+#include "snapshot.h"
+#include "tapecart.h"
+#include "tapeport.h"
+#include "test.h"
+#include "types.h"
+
+#define LOADER_START            0x0351
+#define LOADER_LOAD_COMPLETE    0x039b
+#define TIMEOUT_CYCLES          200000000
+
+static const uint8_t default_loader[TAPECART_LOADER_SIZE] = {
+#  include "tapecart-loader.h"
+};
+
+static const struct {
+    const char *name;
+    unsigned int loadaddr;
+    unsigned int length;
+    uint8_t ddr;
+    int accelerated;
+} loads[] = {
+    { "tapecart-basic.tcrt", 0x0801, 40000, 0x2f, 1 },
+    { "tapecart-a000.tcrt", 0x9000, 8194, 0x2f, 1 },
+    { "tapecart-top.tcrt", 0x10000 - 5000, 5000, 0x2f, 1 },
+    { "tapecart-io.tcrt", 0xc800, 8192, 0x2f, 1 },
+    /* LORAM, HIRAM and CHAREN float high until getbyte sets $00 */
+    { "tapecart-ddr.tcrt", 0xc800, 8192, 0x28, 0 },
+    { NULL, 0, 0, 0, 0 }
+};
+
+/* ------------------------------------------------------------------------- */
+
+/* Machine state at the end of a load.  */
+typedef struct c64_state_s {
+    uint8_t ram[0x10000];
+    uint8_t io[0x1000];
+    uint8_t a, x, y, sp;
+    int n, z, c;
+    CLOCK cycles;
+} c64_state_t;
+
+static c64_state_t c64;
+static uint8_t port_dir, port_data;
+static unsigned int pc;
+static int tape_sense, tape_write_in;
+static int old_motor, old_write;
+
+static tapeport_device_t *tapecart_device;
+static const resource_int_t *tapecart_resources;
+static void (*trap_func)(uint16_t, void *);
+
+CLOCK maincpu_clk = 0;
+alarm_context_t *maincpu_alarm_context;
+mos6510_regs_t maincpu_regs;
+
+/* The LORAM, HIRAM and CHAREN lines, the inputs are pulled up.  */
+static int io_visible(void)
+{
+    int lines = (port_data | ~port_dir) & 0x07;
+
+    return (lines & 0x04) && (lines & 0x03);
+}
+
+static void port_changed(void)
+{
+    int motor = port_dir & port_data & 0x20;
+    int write = (~port_dir | port_data) & 0x08;
+
+    if (motor != old_motor) {
+        old_motor = motor;
+        tapecart_device->set_motor(!motor);
+    }
+    if (write != old_write) {
+        old_write = write;
+        tapecart_device->toggle_write_bit(write);
+    }
+}
+
+static uint8_t read_byte(uint16_t addr)
+{
+    uint8_t value;
+
+    switch (addr) {
+        case 0x0000:
+            return port_dir;
+        case 0x0001:
+            value = (port_data | ~port_dir) & (port_data | 0x17);
+            if (!(port_dir & 0x20)) {
+                value &= 0xdf;
+            }
+            if (tape_sense && !(port_dir & 0x10)) {
+                value &= 0xef;
+            }
+            if (tape_write_in && !(port_dir & 0x08)) {
+                value &= 0xf7;
+            }
+            return value;
+        default:
+            break;
+    }
+    if (addr >= 0xd000 && addr < 0xe000 && io_visible()) {
+        return c64.io[addr & 0x0fff];
+    }
+    return c64.ram[addr];
+}
+
+static void store_byte(uint16_t addr, uint8_t value)
+{
+    if (addr >= 0xd000 && addr < 0xe000 && io_visible()) {
+        c64.io[addr & 0x0fff] = value;
+        return;
+    }
+    c64.ram[addr] = value;
+    if (addr == 0x0000) {
+        port_dir = value;
+        port_changed();
+    } else if (addr == 0x0001) {
+        port_data = value;
+        port_changed();
+    }
+}
+
+#define SET_NZ(value)                       \
+    do {                                    \
+        c64.n = ((value) & 0x80) != 0;      \
+        c64.z = ((value) & 0xff) == 0;      \
+    } while (0)
+
+#define BRANCH(cond)                                    \
+    do {                                                \
+        pc += 2;                                        \
+        if (cond) {                                     \
+            pc = (pc + (unsigned int)(int8_t)op1) & 0xffff; \
+            cycles = 3;                                 \
+        }                                               \
+    } while (0)
+
+/* Runs the instructions the loader uses.  Memory is accessed in the last
+   cycle of the instruction, which is when the loader's port writes and
+   reads happen on the real CPU.  */
+static int step(void)
+{
+    uint8_t op = read_byte((uint16_t)pc);
+    uint8_t op1 = read_byte((uint16_t)(pc + 1));
+    uint8_t op2 = read_byte((uint16_t)(pc + 2));
+    uint16_t abs = (uint16_t)(op1 | (op2 << 8));
+    CLOCK start = maincpu_clk;
+    int cycles = 2;
+    uint8_t value;
+    int carry;
+
+#define AT(n) (maincpu_clk = start + (n) - 1)
+
+    switch (op) {
+        case 0x6e:  /* ROR abs */
+            AT(6);
+            value = read_byte(abs);
+            carry = value & 1;
+            value = (uint8_t)((value >> 1) | (c64.c << 7));
+            c64.c = carry;
+            store_byte(abs, value);
+            SET_NZ(value);
+            pc += 3;
+            cycles = 6;
+            break;
+        case 0x2e:  /* ROL abs */
+            AT(6);
+            value = read_byte(abs);
+            carry = value >> 7;
+            value = (uint8_t)((value << 1) | c64.c);
+            c64.c = carry;
+            store_byte(abs, value);
+            SET_NZ(value);
+            pc += 3;
+            cycles = 6;
+            break;
+        case 0x78:  /* SEI */
+        case 0x58:  /* CLI */
+        case 0xea:  /* NOP */
+            pc++;
+            break;
+        case 0x18:  /* CLC */
+            c64.c = 0;
+            pc++;
+            break;
+        case 0x38:  /* SEC */
+            c64.c = 1;
+            pc++;
+            break;
+        case 0xa0:  /* LDY # */
+            c64.y = op1;
+            SET_NZ(c64.y);
+            pc += 2;
+            break;
+        case 0xa2:  /* LDX # */
+            c64.x = op1;
+            SET_NZ(c64.x);
+            pc += 2;
+            break;
+        case 0xa9:  /* LDA # */
+            c64.a = op1;
+            SET_NZ(c64.a);
+            pc += 2;
+            break;
+        case 0x84:  /* STY zp */
+            AT(3);
+            store_byte(op1, c64.y);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0x85:  /* STA zp */
+            AT(3);
+            store_byte(op1, c64.a);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0x86:  /* STX zp */
+            AT(3);
+            store_byte(op1, c64.x);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0xa5:  /* LDA zp */
+            AT(3);
+            c64.a = read_byte(op1);
+            SET_NZ(c64.a);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0xa6:  /* LDX zp */
+            AT(3);
+            c64.x = read_byte(op1);
+            SET_NZ(c64.x);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0x09:  /* ORA # */
+            c64.a |= op1;
+            SET_NZ(c64.a);
+            pc += 2;
+            break;
+        case 0x29:  /* AND # */
+            c64.a &= op1;
+            SET_NZ(c64.a);
+            pc += 2;
+            break;
+        case 0x45:  /* EOR zp */
+            AT(3);
+            c64.a ^= read_byte(op1);
+            SET_NZ(c64.a);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0x24:  /* BIT zp */
+            AT(3);
+            value = read_byte(op1);
+            c64.z = (c64.a & value) == 0;
+            c64.n = value >> 7;
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0xc5:  /* CMP zp */
+            AT(3);
+            value = read_byte(op1);
+            c64.c = c64.a >= value;
+            SET_NZ(c64.a - value);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0xe4:  /* CPX zp */
+            AT(3);
+            value = read_byte(op1);
+            c64.c = c64.x >= value;
+            SET_NZ(c64.x - value);
+            pc += 2;
+            cycles = 3;
+            break;
+        case 0xe6:  /* INC zp */
+            AT(5);
+            value = (uint8_t)(read_byte(op1) + 1);
+            store_byte(op1, value);
+            SET_NZ(value);
+            pc += 2;
+            cycles = 5;
+            break;
+        case 0xca:  /* DEX */
+            c64.x--;
+            SET_NZ(c64.x);
+            pc++;
+            break;
+        case 0xe8:  /* INX */
+            c64.x++;
+            SET_NZ(c64.x);
+            pc++;
+            break;
+        case 0x88:  /* DEY */
+            c64.y--;
+            SET_NZ(c64.y);
+            pc++;
+            break;
+        case 0xc8:  /* INY */
+            c64.y++;
+            SET_NZ(c64.y);
+            pc++;
+            break;
+        case 0xaa:  /* TAX */
+            c64.x = c64.a;
+            SET_NZ(c64.x);
+            pc++;
+            break;
+        case 0x4a:  /* LSR */
+            c64.c = c64.a & 1;
+            c64.a >>= 1;
+            SET_NZ(c64.a);
+            pc++;
+            break;
+        case 0x90:  /* BCC */
+            BRANCH(!c64.c);
+            break;
+        case 0xd0:  /* BNE */
+            BRANCH(!c64.z);
+            break;
+        case 0x99:  /* STA abs,Y */
+            AT(5);
+            store_byte((uint16_t)(abs + c64.y), c64.a);
+            pc += 3;
+            cycles = 5;
+            break;
+        case 0x1d:  /* ORA abs,X */
+            AT(4);
+            c64.a |= read_byte((uint16_t)(abs + c64.x));
+            SET_NZ(c64.a);
+            pc += 3;
+            cycles = 4;
+            break;
+        case 0x91:  /* STA (zp),Y */
+            AT(6);
+            store_byte((uint16_t)((read_byte(op1) | (read_byte((uint8_t)(op1 + 1)) << 8)) + c64.y),
+                       c64.a);
+            pc += 2;
+            cycles = 6;
+            break;
+        case 0x20:  /* JSR */
+            AT(6);
+            store_byte((uint16_t)(0x100 + c64.sp--), (uint8_t)((pc + 2) >> 8));
+            store_byte((uint16_t)(0x100 + c64.sp--), (uint8_t)(pc + 2));
+            pc = abs;
+            cycles = 6;
+            break;
+        case 0x60:  /* RTS */
+            pc = (read_byte((uint16_t)(0x100 + (uint8_t)(c64.sp + 1)))
+                  | (read_byte((uint16_t)(0x100 + (uint8_t)(c64.sp + 2))) << 8)) + 1;
+            c64.sp += 2;
+            cycles = 6;
+            break;
+        default:
+            fprintf(stderr, "unknown opcode $%02x at $%04x\n", op, pc);
+            return -1;
+    }
+#undef AT
+
+    maincpu_clk = start + (CLOCK)cycles;
+
+    if (trap_func != NULL) {
+        void (*func)(uint16_t, void *) = trap_func;
+
+        trap_func = NULL;
+        maincpu_regs.sp = c64.sp;
+        func((uint16_t)pc, NULL);
+        c64.sp = maincpu_regs.sp;
+    }
+    while (maincpu_clk >= alarm_context_next_pending_clk(maincpu_alarm_context)) {
+        alarm_context_dispatch(maincpu_alarm_context, maincpu_clk);
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void set_resource(const char *name, int value)
+{
+    const resource_int_t *r;
+
+    for (r = tapecart_resources; r->name != NULL; r++) {
+        if (strcmp(r->name, name) == 0) {
+            r->set_func(value, r->param);
+        }
+    }
+}
+
+static int write_tcrt(const char *name, unsigned int loadaddr, unsigned int length)
+{
+    uint8_t header[216];
+    FILE *fd;
+    unsigned int i;
+    int ok;
+
+    memset(header, 0, sizeof header);
+    memcpy(header, "tapecartImage\r\n\x1a", 16);
+    header[16] = 1;                             /* version */
+    header[20] = (uint8_t)(length + 2);         /* data length */
+    header[21] = (uint8_t)((length + 2) >> 8);
+    header[22] = 0x0d;                          /* call address */
+    header[23] = 0x08;
+    memcpy(header + 24, "TEST", 4);             /* file name */
+    header[212] = (uint8_t)(length + 2);        /* flash length */
+    header[213] = (uint8_t)((length + 2) >> 8);
+
+    fd = fopen(name, "wb");
+    if (fd == NULL) {
+        return -1;
+    }
+    ok = fwrite(header, sizeof header, 1, fd) == 1;
+    fputc((int)(loadaddr & 0xff), fd);
+    fputc((int)(loadaddr >> 8), fd);
+    for (i = 0; i < length; i++) {
+        fputc((int)((i * 7 + (i >> 8)) & 0xff), fd);
+    }
+    return fclose(fd) == 0 && ok ? 0 : -1;
+}
+
+/* Loads `name' from the start of the loader to its "load complete" code.  */
+static int run_loader(const char *name, uint8_t ddr, int accelerate, c64_state_t *state)
+{
+    CLOCK start;
+    unsigned int i;
+
+    set_resource("TapecartEnabled", 0);
+    set_resource("TapecartAccelerate", accelerate);
+    set_resource("TapecartEnabled", 1);
+    if (tapecart_attach_tcrt(name, NULL) < 0) {
+        return -1;
+    }
+
+    srand(1);
+    for (i = 0; i < sizeof c64.ram; i++) {
+        c64.ram[i] = (uint8_t)rand();
+    }
+    memset(c64.io, 0, sizeof c64.io);
+    memcpy(c64.ram + LOADER_START, default_loader, TAPECART_LOADER_SIZE);
+    c64.ram[0] = port_dir = ddr;
+    c64.ram[1] = port_data = 0x37;
+    old_motor = port_dir & port_data & 0x20;
+    old_write = (~port_dir | port_data) & 0x08;
+    c64.a = c64.x = c64.y = 0;
+    c64.n = c64.z = c64.c = 0;
+    c64.sp = 0xf6;
+    pc = LOADER_START;
+
+    start = maincpu_clk;
+    while (pc != LOADER_LOAD_COMPLETE) {
+        if (step() < 0 || maincpu_clk - start > TIMEOUT_CYCLES) {
+            return -1;
+        }
+    }
+    c64.cycles = maincpu_clk - start;
+    *state = c64;
+
+    return 0;
+}
+
+static void check_load(int n)
+{
+    static c64_state_t exact, accel;
+    int same;
+
+    TEST_CHECK(write_tcrt(loads[n].name, loads[n].loadaddr, loads[n].length) == 0);
+    TEST_CHECK(run_loader(loads[n].name, loads[n].ddr, 0, &exact) == 0);
+    TEST_CHECK(run_loader(loads[n].name, loads[n].ddr, 1, &accel) == 0);
+
+    same = memcmp(exact.ram, accel.ram, sizeof exact.ram) == 0
+           && memcmp(exact.io, accel.io, sizeof exact.io) == 0
+           && exact.a == accel.a && exact.x == accel.x && exact.y == accel.y
+           && exact.sp == accel.sp
+           && exact.n == accel.n && exact.z == accel.z && exact.c == accel.c;
+    TEST_CHECK(same);
+
+    /* the data went where the loader puts it */
+    TEST_CHECK(exact.ram[loads[n].loadaddr] == 0);
+    TEST_CHECK(exact.ram[(loads[n].loadaddr + loads[n].length - 1) & 0xffff]
+               == (uint8_t)((loads[n].length - 1) * 7 + ((loads[n].length - 1) >> 8)));
+
+    if (loads[n].accelerated) {
+        TEST_CHECK(accel.cycles < exact.cycles / 2);
+    } else {
+        TEST_CHECK(accel.cycles == exact.cycles);
+    }
+
+    printf("%s: %u bytes to $%04x, %lu cycles exact, %lu accelerated\n",
+           loads[n].name, loads[n].length, loads[n].loadaddr,
+           (unsigned long)exact.cycles, (unsigned long)accel.cycles);
+}
+
+int main(void)
+{
+    int n;
+
+    maincpu_alarm_context = alarm_context_new("maincpu");
+    tapecart_resources_init();
+    set_resource("TapecartUpdateTCRT", 0);
+
+    for (n = 0; loads[n].name != NULL; n++) {
+        check_load(n);
+    }
+
+    set_resource("TapecartEnabled", 0);
+    alarm_context_destroy(maincpu_alarm_context);
+
+    return test_result("tapecart-test");
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The rest of the emulator as far as the tapecart needs it.  */
+
+void interrupt_maincpu_trigger_trap(void (*trap_func_new)(uint16_t, void *), void *data)
+{
+    trap_func = trap_func_new;
+}
+
+uint8_t mem_read(uint16_t addr)
+{
+    return read_byte(addr);
+}
+
+void mem_store(uint16_t addr, uint8_t value)
+{
+    store_byte(addr, value);
+}
+
+void maincpu_set_pc(int value)
+{
+    pc = (unsigned int)value;
+}
+
+void maincpu_set_a(int value)
+{
+    c64.a = (uint8_t)value;
+}
+
+void maincpu_set_x(int value)
+{
+    c64.x = (uint8_t)value;
+}
+
+void maincpu_set_y(int value)
+{
+    c64.y = (uint8_t)value;
+}
+
+void maincpu_set_sign(int value)
+{
+    c64.n = !!value;
+}
+
+void maincpu_set_zero(int value)
+{
+    c64.z = !!value;
+}
+
+void maincpu_set_carry(int value)
+{
+    c64.c = !!value;
+}
+
+unsigned int maincpu_get_y(void)
+{
+    return c64.y;
+}
+
+unsigned int maincpu_get_sp(void)
+{
+    return maincpu_regs.sp;
+}
+
+long machine_get_cycles_per_second(void)
+{
+    return 985248;
+}
+
+tapeport_device_list_t *tapeport_device_register(tapeport_device_t *device)
+{
+    static tapeport_device_list_t item;
+
+    tapecart_device = device;
+    item.device = device;
+    return &item;
+}
+
+void tapeport_device_unregister(tapeport_device_list_t *device)
+{
+}
+
+void tapeport_snapshot_register(tapeport_snapshot_t *snapshot)
+{
+}
+
+void tapeport_set_tape_sense(int sense, int id)
+{
+    tape_sense = sense;
+}
+
+void tapeport_set_write_in(int val, int id)
+{
+    tape_write_in = val;
+}
+
+void tapeport_trigger_flux_change(unsigned int on, int id)
+{
+}
+
+int resources_register_int(const resource_int_t *r)
+{
+    tapecart_resources = r;
+    return 0;
+}
+
+int resources_register_string(const resource_string_t *r)
+{
+    return 0;
+}
+
+int cmdline_register_options(const cmdline_option_t *c)
+{
+    return 0;
+}
+
+uint32_t crc32_buf(const char *buffer, unsigned int len)
+{
+    return 0;
+}
@@ -0,0 +1,412 @@
+/*
+ * tapwav-test.c - Round trip of known pulses through audio recordings.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* A known sequence of pulses is written as a noisy, DC shifted tape
+   signal in every sample format tapwav understands, converted and the
+   pulses in the TAP image are compared with the ones that went in.  */
+
+#include "vice.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tap.h"
+#include "tapwav.h"
+#include "test.h"
+#include "types.h"
+
+#define CLOCK_PAL       985248
+
+#define PULSES          2000
+
+/* A half second pause follows this pulse, the noise in it must not make
+   pulses.  */
+#define PAUSE_AFTER     1000
+#define PAUSE_CYCLES    (CLOCK_PAL / 2)
+
+/* A sample at 44.1kHz is 2.8 TAP units and an edge where the pulse length
+   changes may be off by up to a sample.  The tightest turbo loaders tell
+   $1a from $28 pulses, that still leaves some margin.  */
+#define TOLERANCE       5
+
+/* Where the signal rises from a pause the edge is only known within the
+   noise of the pause.  */
+#define TOLERANCE_PAUSE 16
+
+#define WAV_PCM         1
+#define WAV_FLOAT       3
+#define WAV_ALAW        6
+#define WAV_ULAW        7
+
+static unsigned int pulses[PULSES];
+
+/* The generated signal, -1.0 to 1.0.  */
+static double *signal_buf;
+static unsigned int signal_len;
+
+long machine_get_cycles_per_second(void)
+{
+    return CLOCK_PAL;
+}
+
+int ioutil_remove(const char *name)
+{
+    return remove(name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned int test_rand(void)
+{
+    static unsigned int seed = 12345;
+
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7fff;
+}
+
+static void make_pulses(void)
+{
+    /* short, medium and long CBM pulses, a few turbo and sync ones */
+    static const unsigned int lengths[] = { 0x30, 0x42, 0x56, 0x1a, 0x28, 0x80, 0xf0 };
+    unsigned int i;
+
+    for (i = 0; i < PULSES; i++) {
+        pulses[i] = lengths[test_rand() % (i < 100 ? 3 : 7)];
+    }
+}
+
+/* Length of pulse `k' in cycles, up to the next rising edge.  */
+static unsigned int pulse_cycles(unsigned int k)
+{
+    return pulses[k] * 8 + (k == PAUSE_AFTER ? PAUSE_CYCLES : 0);
+}
+
+/* One sine period per pulse with a DC offset, noise and leading and
+   trailing silence.  */
+static void make_signal(unsigned int rate)
+{
+    double t = 0.0, start = 0.0, cycles_per_sample = (double)CLOCK_PAL / rate;
+    unsigned int i = 0, k = 0, lead = rate / 20;
+
+    signal_len = lead * 2;
+    for (k = 0; k < PULSES; k++) {
+        signal_len += (unsigned int)(pulse_cycles(k) / cycles_per_sample) + 1;
+    }
+    signal_buf = realloc(signal_buf, signal_len * sizeof(double));
+
+    for (i = 0; i < lead; i++) {
+        signal_buf[i] = 0.05;
+    }
+    k = 0;
+    for (; i < signal_len; i++) {
+        double v = 0.05;
+
+        t = (i - lead) * cycles_per_sample;
+        while (k < PULSES && t >= start + pulse_cycles(k)) {
+            start += pulse_cycles(k++);
+        }
+        if (k < PULSES && t < start + pulses[k] * 8) {
+            v += 0.6 * sin(2 * M_PI * (t - start) / (pulses[k] * 8));
+        }
+        signal_buf[i] = v + ((int)(test_rand() % 7) - 3) / 128.0;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void put_word(FILE *f, unsigned int v)
+{
+    fputc(v & 0xff, f);
+    fputc((v >> 8) & 0xff, f);
+}
+
+static void put_dword(FILE *f, uint32_t v)
+{
+    put_word(f, v & 0xffff);
+    put_word(f, v >> 16);
+}
+
+/* G.711 encoders, the inverse of the expanders in tapwav.c.  */
+static uint8_t alaw_encode(int v)
+{
+    int mask = 0xd5, seg = 0, t;
+
+    if (v < 0) {
+        mask = 0x55;
+        v = -v - 1;
+    }
+    t = v >> 4;
+    while (seg < 8 && t > (0x1f << seg)) {
+        seg++;
+    }
+    if (seg >= 8) {
+        return (uint8_t)(0x7f ^ mask);
+    }
+    t = (seg < 2) ? (v >> 4) : (v >> (seg + 3));
+    return (uint8_t)(((seg << 4) | (t & 0x0f)) ^ mask);
+}
+
+static uint8_t ulaw_encode(int v)
+{
+    int mask = 0xff, seg = 0;
+
+    if (v < 0) {
+        mask = 0x7f;
+        v = -v;
+    }
+    v += 0x84;
+    if (v > 0x7fff) {
+        v = 0x7fff;
+    }
+    while (seg < 7 && (v >> (seg + 8))) {
+        seg++;
+    }
+    return (uint8_t)(((seg << 4) | ((v >> (seg + 3)) & 0x0f)) ^ mask);
+}
+
+static void put_sample(FILE *f, int format, unsigned int bits, double v)
+{
+    int32_t x;
+    unsigned int b;
+
+    switch (format) {
+        case WAV_FLOAT:
+            if (bits == 32) {
+                float s = (float)v;
+                fwrite(&s, sizeof(s), 1, f);
+            } else {
+                fwrite(&v, sizeof(v), 1, f);
+            }
+            break;
+        case WAV_ALAW:
+            fputc(alaw_encode((int)(v * 32767)), f);
+            break;
+        case WAV_ULAW:
+            fputc(ulaw_encode((int)(v * 32767)), f);
+            break;
+        default:
+            if (bits == 8) {
+                fputc((int)(v * 127) + 128, f);
+            } else {
+                x = (int32_t)(v * 2147483647.0) >> (32 - bits);
+                for (b = 0; b < bits / 8; b++) {
+                    fputc((x >> (8 * b)) & 0xff, f);
+                }
+            }
+            break;
+    }
+}
+
+/* The signal goes into the first channel, the others carry noise.  */
+static void write_wav(const char *name, int format, unsigned int channels,
+                      unsigned int bits, unsigned int rate)
+{
+    FILE *f = fopen(name, "wb");
+    unsigned int frame = channels * bits / 8;
+    unsigned int i, c;
+
+    make_signal(rate);
+
+    fwrite("RIFF", 1, 4, f);
+    put_dword(f, 4 + 12 + 24 + 8 + signal_len * frame);
+    fwrite("WAVE", 1, 4, f);
+    /* a chunk tapwav has to skip */
+    fwrite("LIST", 1, 4, f);
+    put_dword(f, 3);
+    fwrite("abc\0", 1, 4, f);
+    fwrite("fmt ", 1, 4, f);
+    put_dword(f, 16);
+    put_word(f, format);
+    put_word(f, channels);
+    put_dword(f, rate);
+    put_dword(f, rate * frame);
+    put_word(f, frame);
+    put_word(f, bits);
+    fwrite("data", 1, 4, f);
+    put_dword(f, signal_len * frame);
+    for (i = 0; i < signal_len; i++) {
+        for (c = 0; c < channels; c++) {
+            put_sample(f, format, bits, c ? (test_rand() % 100) / 100.0 - 0.5 : signal_buf[i]);
+        }
+    }
+    fclose(f);
+}
+
+static void put_voc_header(FILE *f, unsigned int type, unsigned int size)
+{
+    fputc(type, f);
+    fputc(size & 0xff, f);
+    fputc((size >> 8) & 0xff, f);
+    fputc((size >> 16) & 0xff, f);
+}
+
+/* 16-bit samples in a new format block and a continuation block, or
+   8-bit samples in an old format block.  */
+static void write_voc(const char *name, unsigned int bits)
+{
+    FILE *f = fopen(name, "wb");
+    unsigned int rate = (bits == 8) ? 1000000 / (256 - 233) : 44100;
+    unsigned int half, i;
+
+    make_signal(rate);
+    half = signal_len / 2;
+
+    fwrite("Creative Voice File\x1a", 1, 20, f);
+    put_word(f, 26);
+    put_word(f, 0x010a);
+    put_word(f, 0x1129);
+
+    if (bits == 8) {
+        put_voc_header(f, 1, 2 + signal_len);
+        fputc(233, f);
+        fputc(0, f);
+        for (i = 0; i < signal_len; i++) {
+            put_sample(f, WAV_PCM, 8, signal_buf[i]);
+        }
+    } else {
+        put_voc_header(f, 9, 12 + half * 2);
+        put_dword(f, rate);
+        fputc(16, f);
+        fputc(1, f);
+        put_word(f, 4);
+        put_dword(f, 0);
+        for (i = 0; i < half; i++) {
+            put_sample(f, WAV_PCM, 16, signal_buf[i]);
+        }
+        put_voc_header(f, 2, (signal_len - half) * 2);
+        for (i = half; i < signal_len; i++) {
+            put_sample(f, WAV_PCM, 16, signal_buf[i]);
+        }
+    }
+    fputc(0, f);
+    fclose(f);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Convert `name' and compare the pulses.  The last pulse runs into the
+   trailing silence, so only its presence is checked.  */
+static void check_conversion(const char *name, const char *what)
+{
+    char tap_name[256];
+    uint8_t *tap;
+    long len, pos;
+    unsigned int count = 0, bad = 0, cycles;
+    FILE *f;
+
+    snprintf(tap_name, sizeof(tap_name), "%s.tap", name);
+    TEST_CHECK(tapwav_convert(name, tap_name) == 0);
+
+    f = fopen(tap_name, "rb");
+    TEST_CHECK(f != NULL);
+    if (f == NULL) {
+        return;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    rewind(f);
+    tap = malloc(len);
+    TEST_CHECK(fread(tap, 1, len, f) == (size_t)len);
+    fclose(f);
+
+    TEST_CHECK(len > TAP_HDR_SIZE);
+    TEST_CHECK(memcmp(tap + TAP_HDR_MAGIC_OFFSET, "C64-TAPE-RAW", 12) == 0);
+    TEST_CHECK(tap[TAP_HDR_VERSION] == 1);
+    TEST_CHECK((long)(tap[TAP_HDR_LEN] | (tap[TAP_HDR_LEN + 1] << 8)
+                      | (tap[TAP_HDR_LEN + 2] << 16) | ((uint32_t)tap[TAP_HDR_LEN + 3] << 24))
+               == len - TAP_HDR_SIZE);
+
+    for (pos = TAP_HDR_SIZE; pos < len; count++) {
+        if (tap[pos] != 0) {
+            cycles = tap[pos++] * 8;
+        } else {
+            cycles = tap[pos + 1] | (tap[pos + 2] << 8) | (tap[pos + 3] << 16);
+            pos += 4;
+        }
+        if (count + 1 < PULSES
+            && abs((int)cycles - (int)pulse_cycles(count))
+               > ((count == PAUSE_AFTER || count == PAUSE_AFTER + 1) ? TOLERANCE_PAUSE : TOLERANCE) * 8) {
+            if (bad++ < 5) {
+                fprintf(stderr, "%s: pulse %u is %u cycles, expected %u\n",
+                        what, count, cycles, pulse_cycles(count));
+            }
+        }
+    }
+
+    printf("%s: %u pulses, %u off\n", what, count, bad);
+    TEST_CHECK(count == PULSES);
+    TEST_CHECK(bad == 0);
+
+    free(tap);
+    remove(tap_name);
+    remove(name);
+}
+
+int main(void)
+{
+    make_pulses();
+
+    write_wav("tapwav-pcm8.wav", WAV_PCM, 1, 8, 44100);
+    check_conversion("tapwav-pcm8.wav", "8-bit PCM");
+
+    write_wav("tapwav-pcm16.wav", WAV_PCM, 2, 16, 44100);
+    check_conversion("tapwav-pcm16.wav", "16-bit PCM stereo");
+
+    write_wav("tapwav-pcm24.wav", WAV_PCM, 1, 24, 48000);
+    check_conversion("tapwav-pcm24.wav", "24-bit PCM at 48kHz");
+
+    write_wav("tapwav-float.wav", WAV_FLOAT, 1, 32, 44100);
+    check_conversion("tapwav-float.wav", "32-bit float");
+
+    write_wav("tapwav-double.wav", WAV_FLOAT, 2, 64, 96000);
+    check_conversion("tapwav-double.wav", "64-bit float stereo at 96kHz");
+
+    write_wav("tapwav-alaw.wav", WAV_ALAW, 1, 8, 44100);
+    check_conversion("tapwav-alaw.wav", "A-law");
+
+    write_wav("tapwav-ulaw.wav", WAV_ULAW, 1, 8, 44100);
+    check_conversion("tapwav-ulaw.wav", "u-law");
+
+    write_voc("tapwav-16.voc", 16);
+    check_conversion("tapwav-16.voc", "16-bit VOC");
+
+    write_voc("tapwav-8.voc", 8);
+    check_conversion("tapwav-8.voc", "8-bit VOC");
+
+    /* Not a recording.  */
+    write_voc("tapwav-bad.wav", 16);
+    {
+        FILE *f = fopen("tapwav-bad.wav", "r+b");
+        fputc('X', f);
+        fclose(f);
+    }
+    TEST_CHECK(tapwav_convert("tapwav-bad.wav", "tapwav-bad.tap") < 0);
+    remove("tapwav-bad.wav");
+    remove("tapwav-bad.tap");
+
+    free(signal_buf);
+
+    return test_result("tapwav-test");
+}
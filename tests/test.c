@@ -0,0 +1,112 @@
+/*
+ * test.c - Helpers for the host tests.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Besides the helpers this has the logging and exit functions every core
+   module needs; the tests print the log to stderr.  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "archdep.h"
+#include "log.h"
+#include "test.h"
+
+int test_failures = 0;
+
+int test_result(const char *name)
+{
+    if (test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, test_failures);
+        return EXIT_FAILURE;
+    }
+    printf("%s: all checks passed\n", name);
+    return EXIT_SUCCESS;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int test_log(const char *type, const char *format, va_list ap)
+{
+    fputs(type, stderr);
+    vfprintf(stderr, format, ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int log_message(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    test_log("", format, ap);
+    va_end(ap);
+    return 0;
+}
+
+int log_warning(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    test_log("Warning - ", format, ap);
+    va_end(ap);
+    return 0;
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    test_log("Error - ", format, ap);
+    va_end(ap);
+    return 0;
+}
+
+int log_debug(const char *format, ...)
+{
+    return 0;
+}
+
+int log_verbose(const char *format, ...)
+{
+    return 0;
+}
+
+log_t log_open(const char *id)
+{
+    return LOG_DEFAULT;
+}
+
+int log_close(log_t log)
+{
+    return 0;
+}
+
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}